@@ -1,11 +1,13 @@
 #include "AutomateAnalysis.h"
 #include "AutomateIO.h" // Needed for logMessage
+#include "AutomateTransform.h" // For subsetAddClosure
+#include <string.h>
 
 bool isDeterministic(const Automaton *A, FILE *logFile) {
-    if (A->num_initials != 1) return false;
+    if (A->num_initials != 1 || hasEpsilon(A)) return false;
     for (int i = 0; i < A->num_states; i++) {
         for (int j = 0; j < A->num_symbols; j++) {
-            if (A->transitions[i * A->num_symbols + j].count > 1) return false;
+            if (cellCount(A, i * A->num_symbols + j) > 1) return false;
         }
     }
     return true;
@@ -14,7 +16,7 @@ bool isDeterministic(const Automaton *A, FILE *logFile) {
 bool isComplete(const Automaton *A, FILE *logFile) {
     for (int i = 0; i < A->num_states; i++) {
         for (int j = 0; j < A->num_symbols; j++) {
-            if (A->transitions[i * A->num_symbols + j].count == 0) return false;
+            if (cellCount(A, i * A->num_symbols + j) == 0) return false;
         }
     }
     return true;
@@ -25,39 +27,412 @@ bool isStandard(const Automaton *A, FILE *logFile) {
     int init = A->initials[0];
     for (int i = 0; i < A->num_states; i++) {
         for (int j = 0; j < A->num_symbols; j++) {
-            TransitionList *list = &A->transitions[i * A->num_symbols + j];
-            for (int k = 0; k < list->count; k++) {
-                if (list->destinations[k] == init) return false;
+            int count;
+            const int *dests = cellTransitions(A, i * A->num_symbols + j, &count);
+            for (int k = 0; k < count; k++) {
+                if (dests[k] == init) return false;
             }
         }
+        int count;
+        const int *dests = epsilonTransitions(A, i, &count);
+        for (int k = 0; k < count; k++) {
+            if (dests[k] == init) return false;
+        }
     }
     return true;
 }
 
 bool recognizeWord(const Automaton *A, const char *word, FILE *logFile) {
     if (A->num_initials == 0) return false;
-    
-    // Safety check for non-determinism
-    if (A->num_initials > 1) {
-        logMessage(logFile, "Erreur logique: Impossible de simuler un automate non-deterministe.\n");
+
+    const int *starts = A->initials;
+    int num_starts = A->num_initials;
+    int i = 0;
+
+    // Deterministic walk until the first ambiguous cell (if any); epsilon
+    // transitions go straight to the simulation
+    if (num_starts == 1 && !hasEpsilon(A)) {
+        int current = A->initials[0];
+        for (; word[i] != '\0'; i++) {
+            int sym = symbolOf(A, (unsigned char)word[i]);
+            if (sym < 0) return false;
+
+            int count;
+            const int *dests = cellTransitions(A, current * A->num_symbols + sym, &count);
+            if (count == 0) return false;
+            if (count > 1) {
+                starts = dests;
+                num_starts = count;
+                i++;
+                break;
+            }
+            current = dests[0];
+        }
+        if (num_starts == 1) return arrayContains(A->finals, A->num_finals, current);
+    }
+
+    NFASimulator sim;
+    if (!nfaSimInit(&sim, A)) {
+        logAt(LOG_ERROR, logFile, "Erreur : Memoire insuffisante pour la simulation de l'automate.\n");
+        return false;
+    }
+    bool accepted = nfaSimAcceptsFrom(&sim, starts, num_starts, word + i);
+    nfaSimFree(&sim);
+    return accepted;
+}
+
+// --- NFA Simulation ---
+
+bool nfaSimInit(NFASimulator *S, const Automaton *A) {
+    memset(S, 0, sizeof(NFASimulator));
+    S->A = A;
+    if (!sparseSetInit(&S->current, A->num_states) || !sparseSetInit(&S->next, A->num_states) ||
+        !bitsetInit(&S->finals, A->num_states)) {
+        nfaSimFree(S);
+        return false;
+    }
+    for (int i = 0; i < A->num_finals; i++) bitsetAdd(&S->finals, A->finals[i]);
+    return true;
+}
+
+void nfaSimFree(NFASimulator *S) {
+    if (!S) return;
+    sparseSetFree(&S->current);
+    sparseSetFree(&S->next);
+    bitsetFree(&S->finals);
+}
+
+bool nfaSimAccepts(NFASimulator *S, const char *word) {
+    return nfaSimAcceptsFrom(S, S->A->initials, S->A->num_initials, word);
+}
+
+bool nfaSimAcceptsFrom(NFASimulator *S, const int *starts, int num_starts, const char *word) {
+    const Automaton *A = S->A;
+    SparseSet *current = &S->current, *next = &S->next;
+    sparseSetClear(current);
+    for (int i = 0; i < num_starts; i++) subsetAddClosure(A, starts[i], current);
+
+    for (const unsigned char *p = (const unsigned char *)word; *p; p++) {
+        int sym = symbolOf(A, *p);
+        if (sym < 0) return false;
+
+        sparseSetClear(next);
+        for (int i = 0; i < current->count; i++) {
+            int count;
+            const int *dests = cellTransitions(A, current->dense[i] * A->num_symbols + sym, &count);
+            for (int t = 0; t < count; t++) subsetAddClosure(A, dests[t], next);
+        }
+        if (next->count == 0) return false;
+
+        SparseSet *swap = current;
+        current = next;
+        next = swap;
+    }
+    for (int i = 0; i < current->count; i++) {
+        if (bitsetContains(&S->finals, current->dense[i])) return true;
+    }
+    return false;
+}
+
+// --- Useful States ---
+
+// Appends the successors of `state` (symbol and epsilon transitions) to
+// queue[*tail] when not yet marked, and marks them
+static void pushSuccessors(const Automaton *A, int state, bool *mark, int *queue, int *tail) {
+    for (int sym = 0; sym < A->num_symbols; sym++) {
+        int count;
+        const int *dests = cellTransitions(A, state * A->num_symbols + sym, &count);
+        for (int t = 0; t < count; t++) {
+            if (!mark[dests[t]]) { mark[dests[t]] = true; queue[(*tail)++] = dests[t]; }
+        }
+    }
+    int count;
+    const int *dests = epsilonTransitions(A, state, &count);
+    for (int t = 0; t < count; t++) {
+        if (!mark[dests[t]]) { mark[dests[t]] = true; queue[(*tail)++] = dests[t]; }
+    }
+}
+
+bool markUsefulStates(const Automaton *A, bool *reachable, bool *coreachable) {
+    int n = A->num_states;
+    int *queue = malloc(n * sizeof(int));
+    if (!queue) return false;
+
+    int head = 0, tail = 0;
+    memset(reachable, 0, n * sizeof(bool));
+    for (int i = 0; i < A->num_initials; i++) {
+        int s = A->initials[i];
+        if (!reachable[s]) { reachable[s] = true; queue[tail++] = s; }
+    }
+    while (head < tail) pushSuccessors(A, queue[head++], reachable, queue, &tail);
+    if (!coreachable) {
+        free(queue);
+        return true;
+    }
+
+    // Reverse adjacency index (CSR by destination), built with a counting sort
+    int m = 0;
+    for (int s = 0; s < n; s++) {
+        for (int sym = 0; sym < A->num_symbols; sym++) m += cellCount(A, s * A->num_symbols + sym);
+        int count;
+        epsilonTransitions(A, s, &count);
+        m += count;
+    }
+    int *rev_offsets = calloc(n + 1, sizeof(int));
+    int *rev_sources = malloc((m > 0 ? m : 1) * sizeof(int));
+    if (!rev_offsets || !rev_sources) {
+        free(rev_offsets);
+        free(rev_sources);
+        free(queue);
+        return false;
+    }
+    for (int s = 0; s < n; s++) {
+        for (int sym = 0; sym < A->num_symbols; sym++) {
+            int count;
+            const int *dests = cellTransitions(A, s * A->num_symbols + sym, &count);
+            for (int t = 0; t < count; t++) rev_offsets[dests[t] + 1]++;
+        }
+        int count;
+        const int *dests = epsilonTransitions(A, s, &count);
+        for (int t = 0; t < count; t++) rev_offsets[dests[t] + 1]++;
+    }
+    for (int s = 0; s < n; s++) rev_offsets[s + 1] += rev_offsets[s];
+    // queue doubles as the fill cursor: every source is placed before the BFS
+    memcpy(queue, rev_offsets, n * sizeof(int));
+    for (int s = 0; s < n; s++) {
+        for (int sym = 0; sym < A->num_symbols; sym++) {
+            int count;
+            const int *dests = cellTransitions(A, s * A->num_symbols + sym, &count);
+            for (int t = 0; t < count; t++) rev_sources[queue[dests[t]]++] = s;
+        }
+        int count;
+        const int *dests = epsilonTransitions(A, s, &count);
+        for (int t = 0; t < count; t++) rev_sources[queue[dests[t]]++] = s;
+    }
+
+    head = tail = 0;
+    memset(coreachable, 0, n * sizeof(bool));
+    for (int i = 0; i < A->num_finals; i++) {
+        int s = A->finals[i];
+        if (!coreachable[s]) { coreachable[s] = true; queue[tail++] = s; }
+    }
+    while (head < tail) {
+        int s = queue[head++];
+        for (int j = rev_offsets[s]; j < rev_offsets[s + 1]; j++) {
+            int p = rev_sources[j];
+            if (!coreachable[p]) { coreachable[p] = true; queue[tail++] = p; }
+        }
+    }
+    free(rev_offsets);
+    free(rev_sources);
+    free(queue);
+    return true;
+}
+
+// The empty-language form produced by trim(): one state, no final, no transition
+static bool isEmptyTrim(const Automaton *A) {
+    if (A->num_states != 1 || A->num_finals != 0 || hasEpsilon(A)) return false;
+    for (int sym = 0; sym < A->num_symbols; sym++) {
+        if (cellCount(A, sym) > 0) return false;
+    }
+    return true;
+}
+
+bool isTrim(const Automaton *A, FILE *logFile) {
+    (void)logFile;
+    if (isEmptyTrim(A)) return true;
+    bool *reachable = malloc(A->num_states * sizeof(bool));
+    bool *coreachable = malloc(A->num_states * sizeof(bool));
+    bool trimmed = reachable && coreachable && markUsefulStates(A, reachable, coreachable);
+    for (int s = 0; trimmed && s < A->num_states; s++) trimmed = reachable[s] && coreachable[s];
+    free(reachable);
+    free(coreachable);
+    return trimmed;
+}
+
+// --- Language Summary ---
+
+// Finiteness over the useful states. Epsilon cycles are contracted first:
+// states sharing a closure lie on a common epsilon cycle, so closure groups
+// (closure_of) stand for them, and the epsilon edges left between groups
+// are acyclic. The language is then infinite exactly when the contracted
+// useful graph has a cycle, found by peeling nodes of in-degree 0 (Kahn).
+// Node of a state: its closure group with epsilon transitions, itself otherwise
+static inline int groupOf(const Automaton *A, int state) {
+    return hasEpsilon(A) ? A->closure_of[state] : state;
+}
+
+static bool usefulGraphAcyclic(const Automaton *A, const bool *useful, bool *acyclic) {
+    int n = A->num_states, k = A->num_symbols;
+    int *indegree = calloc(n, sizeof(int));
+    int *queue = malloc(n * sizeof(int));
+    if (!indegree || !queue) {
+        free(indegree);
+        free(queue);
         return false;
     }
+    *acyclic = true;
+    for (int s = 0; s < n && *acyclic; s++) {
+        if (!useful[s]) continue;
+        for (int sym = 0; sym < k; sym++) {
+            int count;
+            const int *dests = cellTransitions(A, s * k + sym, &count);
+            for (int t = 0; t < count; t++) {
+                if (!useful[dests[t]]) continue;
+                if (groupOf(A, dests[t]) == groupOf(A, s)) *acyclic = false;   // A letter read on a cycle
+                indegree[groupOf(A, dests[t])]++;
+            }
+        }
+        int count;
+        const int *dests = epsilonTransitions(A, s, &count);
+        for (int t = 0; t < count; t++) {
+            if (useful[dests[t]] && groupOf(A, dests[t]) != groupOf(A, s)) indegree[groupOf(A, dests[t])]++;
+        }
+    }
+    if (!*acyclic) {
+        free(indegree);
+        free(queue);
+        return true;
+    }
 
-    int current = A->initials[0]; 
+    // Peel the useful states; a node is released once all its members' incoming edges are gone
+    int head = 0, tail = 0, useful_count = 0, peeled = 0;
+    for (int s = 0; s < n; s++) {
+        if (!useful[s]) continue;
+        useful_count++;
+        if (indegree[groupOf(A, s)] == 0) queue[tail++] = s;
+    }
+    while (head < tail) {
+        int s = queue[head++];
+        peeled++;
+        for (int sym = 0; sym <= k; sym++) {
+            int count;
+            const int *dests = sym < k ? cellTransitions(A, s * k + sym, &count) : epsilonTransitions(A, s, &count);
+            for (int t = 0; t < count; t++) {
+                int d = dests[t];
+                if (!useful[d] || groupOf(A, d) == groupOf(A, s)) continue;
+                if (--indegree[groupOf(A, d)] > 0) continue;
+                // The whole group becomes free at once
+                if (hasEpsilon(A)) {
+                    int size;
+                    const int *members = epsilonClosure(A, d, &size);
+                    for (int i = 0; i < size; i++) {
+                        if (useful[members[i]] && groupOf(A, members[i]) == groupOf(A, d)) queue[tail++] = members[i];
+                    }
+                } else {
+                    queue[tail++] = d;
+                }
+            }
+        }
+    }
+    *acyclic = peeled == useful_count;
+    free(indegree);
+    free(queue);
+    return true;
+}
 
-    for (int i = 0; word[i] != '\0'; i++) {
-        int sym = word[i] - 'a';
-        if (sym < 0 || sym >= A->num_symbols) return false;
-        
-        int idx = current * A->num_symbols + sym;
-        
-        if (A->transitions[idx].count > 1) {
-            logMessage(logFile, "Attention: Ambiguite detectee (non-determinisme) a l'etat %d.\n", current);
-            return false;
+// Shortest accepted word, breadth-first from the initial states. The
+// epsilon closure of a state is discovered with it, at the same distance,
+// so states are discovered by increasing distance and the first final
+// discovered is a closest one.
+
+typedef struct {
+    const Automaton *A;
+    int *parent;
+    int *symbol;        // Symbol read from the parent, -1 for epsilon
+    int *queue;
+    int tail;
+    bool *seen;
+    bool *isFinal;
+    int found;          // First final discovered, -1 while none
+} WordSearch;
+
+static void discover(WordSearch *W, int state, int from, int symbol) {
+    if (W->seen[state]) return;
+    W->seen[state] = true;
+    W->parent[state] = from;
+    W->symbol[state] = symbol;
+    W->queue[W->tail++] = state;
+    if (W->isFinal[state] && W->found < 0) W->found = state;
+    // A closure holds the closures of its members: they need no expansion
+    if (hasEpsilon(W->A)) {
+        int count;
+        const int *closure = epsilonClosure(W->A, state, &count);
+        for (int i = 0; i < count; i++) {
+            int c = closure[i];
+            if (W->seen[c]) continue;
+            W->seen[c] = true;
+            W->parent[c] = state;
+            W->symbol[c] = -1;
+            W->queue[W->tail++] = c;
+            if (W->isFinal[c] && W->found < 0) W->found = c;
         }
-        
-        if (A->transitions[idx].count == 0) return false;
-        current = A->transitions[idx].destinations[0]; 
     }
-    return arrayContains(A->finals, A->num_finals, current);
-}
\ No newline at end of file
+}
+
+static bool shortestWord(const Automaton *A, LanguageSummary *S) {
+    int n = A->num_states, k = A->num_symbols;
+    WordSearch W = { A, malloc(n * sizeof(int)), malloc(n * sizeof(int)), malloc(n * sizeof(int)), 0,
+                     calloc(n, sizeof(bool)), calloc(n, sizeof(bool)), -1 };
+    bool ok = W.parent && W.symbol && W.queue && W.seen && W.isFinal;
+    if (ok) {
+        for (int i = 0; i < A->num_finals; i++) W.isFinal[A->finals[i]] = true;
+        for (int i = 0; i < A->num_initials; i++) discover(&W, A->initials[i], -1, -1);
+        for (int head = 0; W.found < 0 && head < W.tail; head++) {
+            int s = W.queue[head];
+            for (int sym = 0; sym < k && W.found < 0; sym++) {
+                int count;
+                const int *dests = cellTransitions(A, s * k + sym, &count);
+                for (int t = 0; t < count; t++) discover(&W, dests[t], s, sym);
+            }
+        }
+    }
+    if (ok && W.found >= 0) {
+        int length = 0;
+        for (int s = W.found; W.parent[s] >= 0; s = W.parent[s]) length += W.symbol[s] >= 0;
+        S->shortest_word = malloc(length + 1);
+        ok = S->shortest_word != NULL;
+        if (ok) {
+            S->shortest_length = length;
+            S->shortest_word[length] = '\0';
+            for (int s = W.found; W.parent[s] >= 0; s = W.parent[s]) {
+                if (W.symbol[s] >= 0) S->shortest_word[--length] = A->alphabet.letters[W.symbol[s]];
+            }
+        }
+    }
+    free(W.parent);
+    free(W.symbol);
+    free(W.queue);
+    free(W.seen);
+    free(W.isFinal);
+    return ok;
+}
+
+bool summarizeLanguage(const Automaton *A, LanguageSummary *S, FILE *logFile) {
+    (void)logFile;
+    memset(S, 0, sizeof(LanguageSummary));
+    S->shortest_length = -1;
+    int n = A->num_states;
+    bool *reachable = malloc(n * sizeof(bool));
+    bool *coreachable = malloc(n * sizeof(bool));
+    bool ok = reachable && coreachable && markUsefulStates(A, reachable, coreachable);
+    if (ok) {
+        for (int s = 0; s < n; s++) {
+            reachable[s] = reachable[s] && coreachable[s];
+            S->num_useful += reachable[s];
+        }
+        S->empty = S->num_useful == 0;
+        S->finite = true;
+        if (!S->empty) ok = usefulGraphAcyclic(A, reachable, &S->finite) && shortestWord(A, S);
+    }
+    free(reachable);
+    free(coreachable);
+    if (!ok) freeLanguageSummary(S);
+    return ok;
+}
+
+void freeLanguageSummary(LanguageSummary *S) {
+    if (!S) return;
+    free(S->shortest_word);
+    S->shortest_word = NULL;
+}
@@ -2,11 +2,61 @@
 #define AUTOMATE_ANALYSIS_H
 
 #include "AutomateCore.h"
+#include "AutomateSet.h"
 #include <stdio.h>
 
 bool isDeterministic(const Automaton *A, FILE *logFile);
 bool isStandard(const Automaton *A, FILE *logFile);
 bool isComplete(const Automaton *A, FILE *logFile);
+// Accepts NFAs too: walks deterministically while it can, then switches to
+// the NFA simulation below at the first ambiguous transition.
 bool recognizeWord(const Automaton *A, const char *word, FILE *logFile);
 
+// --- NFA Simulation ---
+// Tracks the set of active states character by character, so membership
+// works on non-deterministic automata (several initial states, ambiguous
+// cells, epsilon transitions through their precomputed closures) without
+// building the DFA. Memory is linear in the number of states; a simulator
+// can be reused across words.
+
+typedef struct {
+    const Automaton *A;
+    SparseSet current;
+    SparseSet next;
+    Bitset finals;
+} NFASimulator;
+
+bool nfaSimInit(NFASimulator *S, const Automaton *A);
+void nfaSimFree(NFASimulator *S);
+bool nfaSimAccepts(NFASimulator *S, const char *word);
+// Runs from an explicit set of start states instead of the initial ones
+bool nfaSimAcceptsFrom(NFASimulator *S, const int *starts, int num_starts, const char *word);
+
+// --- Useful States and Language Summary ---
+// A state is useful when it is reachable from an initial state and can
+// reach a final one. Both are found in linear time: a breadth-first search
+// from the initials, and one from the finals over a reverse adjacency index
+// (predecessors in CSR form, built with a counting sort). Epsilon
+// transitions count as edges.
+
+// Fills reachable[] and, unless it is NULL, coreachable[] (num_states each)
+bool markUsefulStates(const Automaton *A, bool *reachable, bool *coreachable);
+// Every state useful, or the one-state empty form that trim() produces for
+// an empty language
+bool isTrim(const Automaton *A, FILE *logFile);
+
+// Emptiness, finiteness and a shortest accepted word, from one linear pass;
+// each answer is then a field read. Finiteness looks for a cycle through a
+// letter among the useful states (epsilon cycles read nothing).
+typedef struct {
+    bool empty;
+    bool finite;
+    int num_useful;
+    int shortest_length;            // -1 when empty
+    unsigned char *shortest_word;   // NUL-terminated (the alphabet may contain NUL)
+} LanguageSummary;
+
+bool summarizeLanguage(const Automaton *A, LanguageSummary *S, FILE *logFile);
+void freeLanguageSummary(LanguageSummary *S);
+
 #endif // AUTOMATE_ANALYSIS_H
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "AutomateArena.h"
+#include "AutomateStats.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN 16
+#define ARENA_MIN_BLOCK ((size_t)4096)
+#define ARENA_MAX_BLOCK ((size_t)16 << 20)
+
+struct ArenaBlock {
+    ArenaBlock *next;
+    size_t size;
+    size_t used;
+};
+
+// Payload starts after the header, rounded up to the alignment
+#define BLOCK_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define BLOCK_DATA(b) ((unsigned char *)(b) + BLOCK_HEADER)
+
+static bool arenaGrow(Arena *R, size_t size) {
+    size_t block = R->block_size > size ? R->block_size : size;
+    ArenaBlock *b = malloc(BLOCK_HEADER + block);
+    if (!b) return false;
+    b->next = R->head;
+    b->size = block;
+    b->used = 0;
+    R->head = b;
+    R->total += block;
+    STATS_ARENA(block, 0);
+    STATS_COUNT(COUNT_ARENA_BLOCKS, 1);
+    // Geometric growth keeps the number of blocks (and of frees) logarithmic
+    if (R->block_size < ARENA_MAX_BLOCK) R->block_size *= 2;
+    return true;
+}
+
+bool arenaInit(Arena *R, size_t initial_size) {
+    R->head = NULL;
+    R->total = 0;
+    R->block_size = initial_size > ARENA_MIN_BLOCK ? initial_size : ARENA_MIN_BLOCK;
+    return arenaGrow(R, 0);
+}
+
+void *arenaAlloc(Arena *R, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (size == 0) size = ARENA_ALIGN;
+    if (!R->head || R->head->size - R->head->used < size) {
+        if (!arenaGrow(R, size)) return NULL;
+    }
+    void *p = BLOCK_DATA(R->head) + R->head->used;
+    R->head->used += size;
+    return p;
+}
+
+void *arenaCalloc(Arena *R, size_t count, size_t size) {
+    void *p = arenaAlloc(R, count * size);
+    if (p) memset(p, 0, count * size);
+    return p;
+}
+
+void arenaRelease(Arena *R) {
+    ArenaBlock *b = R->head;
+    while (b) {
+        ArenaBlock *next = b->next;
+        free(b);
+        b = next;
+    }
+    STATS_ARENA(0, R->total);
+    R->head = NULL;
+    R->total = 0;
+}
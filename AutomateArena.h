@@ -0,0 +1,26 @@
+#ifndef AUTOMATE_ARENA_H
+#define AUTOMATE_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// --- Arena (region) allocator ---
+// Bump allocation out of large blocks; everything is released at once by
+// arenaRelease(). Individual allocations are never freed or reallocated.
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    ArenaBlock *head;       // Current block (most recent first), NULL = unused arena
+    size_t block_size;      // Size of the next block to allocate
+    size_t total;           // Bytes reserved from the system
+} Arena;
+
+bool arenaInit(Arena *R, size_t initial_size);
+void *arenaAlloc(Arena *R, size_t size);            // 16-byte aligned, NULL on failure
+void *arenaCalloc(Arena *R, size_t count, size_t size);
+void arenaRelease(Arena *R);
+
+static inline bool arenaInUse(const Arena *R) { return R->head != NULL; }
+
+#endif // AUTOMATE_ARENA_H
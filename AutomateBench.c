@@ -0,0 +1,1755 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "AutomateCore.h"
+#include "AutomateTransform.h"
+#include "AutomateAnalysis.h"
+#include "AutomateDFA.h"
+#include "AutomateIO.h"
+#include "AutomateMatch.h"
+#include "AutomateLazy.h"
+#include "AutomateThreads.h"
+#include "AutomateGen.h"
+#include "AutomateProduct.h"
+#include "AutomateEquiv.h"
+#include "AutomateIncremental.h"
+#include "AutomateRegex.h"
+
+// --- Benchmark harness ---
+// Standalone executable (target AutomateBench): times the library on
+// generated automata. Not part of the interactive program.
+//
+// Each case runs its body until --benchmark_min_time seconds have elapsed
+// (at least once) and reports the mean wall and CPU time per iteration,
+// with optional throughput (items or bytes per second), counters and a
+// label ("same" / "MISMATCH" when the case cross-checks two
+// implementations). The options and the json/csv layouts follow Google
+// Benchmark, so its comparison tools can spot regressions between runs:
+//   --benchmark_filter=<text>       only cases whose name contains <text>
+//   --benchmark_min_time=<seconds>  default 0.1
+//   --benchmark_format=console|json|csv
+//   --benchmark_out=<file> [--benchmark_out_format=console|json|csv (json)]
+// The exit code is non-zero when a case fails or a cross-check disagrees.
+
+#define MAX_COUNTERS 6
+
+typedef struct {
+    const char *name;
+    double value;
+} Counter;
+
+typedef struct {
+    char name[96];
+    long long iterations;
+    double real_time;       // Seconds per iteration
+    double cpu_time;
+    double items;           // Per iteration, 0 when not relevant
+    double bytes;
+    int num_counters;
+    Counter counters[MAX_COUNTERS];
+    const char *label;
+} BenchRecord;
+
+typedef enum { FORMAT_CONSOLE, FORMAT_JSON, FORMAT_CSV } BenchFormat;
+
+static struct {
+    BenchRecord *records;
+    int count;
+    int capacity;
+    const char *filter;
+    double min_time;
+    BenchFormat format;
+    const char *out_path;
+    BenchFormat out_format;
+    bool failed;
+} bench = { .min_time = 0.1, .format = FORMAT_CONSOLE, .out_format = FORMAT_JSON };
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Fills the name; false when the filter excludes the case (skip it)
+static bool beginCase(BenchRecord *R, const char *format, ...) {
+    memset(R, 0, sizeof(BenchRecord));
+    va_list args;
+    va_start(args, format);
+    vsnprintf(R->name, sizeof(R->name), format, args);
+    va_end(args);
+    return !bench.filter || strstr(R->name, bench.filter) != NULL;
+}
+
+static void addCounter(BenchRecord *R, const char *name, double value) {
+    if (R->num_counters == MAX_COUNTERS) return;
+    R->counters[R->num_counters].name = name;
+    R->counters[R->num_counters++].value = value;
+}
+
+static void checkCase(BenchRecord *R, bool same) {
+    R->label = same ? "same" : "MISMATCH";
+    if (!same) bench.failed = true;
+}
+
+typedef bool (*BenchBody)(void *ctx);
+
+// Runs body until min_time has elapsed, at least once
+static bool timeBody(BenchRecord *R, BenchBody body, void *ctx) {
+    long long iterations = 0;
+    clock_t cpu_start = clock();
+    double start = nowSeconds(), elapsed;
+    do {
+        if (!body(ctx)) return false;
+        iterations++;
+        elapsed = nowSeconds() - start;
+    } while (elapsed < bench.min_time);
+    R->iterations = iterations;
+    R->real_time = elapsed / iterations;
+    R->cpu_time = (double)(clock() - cpu_start) / CLOCKS_PER_SEC / iterations;
+    return true;
+}
+
+static void formatTime(char *buffer, size_t size, double seconds) {
+    if (seconds < 1e-6) snprintf(buffer, size, "%.1f ns", seconds * 1e9);
+    else if (seconds < 1e-3) snprintf(buffer, size, "%.2f us", seconds * 1e6);
+    else if (seconds < 1) snprintf(buffer, size, "%.2f ms", seconds * 1e3);
+    else snprintf(buffer, size, "%.3f s", seconds);
+}
+
+static void formatRate(char *buffer, size_t size, double rate, const char *unit) {
+    const char *prefixes[] = { "", "k", "M", "G", "T" };
+    int p = 0;
+    while (rate >= 1000 && p < 4) {
+        rate /= 1000;
+        p++;
+    }
+    snprintf(buffer, size, "%.2f%s%s/s", rate, prefixes[p], unit);
+}
+
+static void writeConsoleHeader(FILE *out) {
+    fprintf(out, "%-52s %12s %12s %12s  %s\n", "Benchmark", "Time", "CPU", "Iterations", "UserCounters...");
+    for (int i = 0; i < 120; i++) fputc('-', out);
+    fputc('\n', out);
+}
+
+static void writeConsoleRow(FILE *out, const BenchRecord *R) {
+    char real[32], cpu[32], rate[32];
+    formatTime(real, sizeof(real), R->real_time);
+    formatTime(cpu, sizeof(cpu), R->cpu_time);
+    fprintf(out, "%-52s %12s %12s %12lld", R->name, real, cpu, R->iterations);
+    if (R->bytes > 0) {
+        formatRate(rate, sizeof(rate), R->bytes / R->real_time, "B");
+        fprintf(out, "  bytes_per_second=%s", rate);
+    }
+    if (R->items > 0) {
+        formatRate(rate, sizeof(rate), R->items / R->real_time, "");
+        fprintf(out, "  items_per_second=%s", rate);
+    }
+    for (int c = 0; c < R->num_counters; c++) fprintf(out, "  %s=%g", R->counters[c].name, R->counters[c].value);
+    if (R->label) fprintf(out, "  %s", R->label);
+    fputc('\n', out);
+}
+
+static void endCase(BenchRecord *R) {
+    if (bench.count == bench.capacity) {
+        int capacity = bench.capacity ? bench.capacity * 2 : 64;
+        BenchRecord *records = realloc(bench.records, capacity * sizeof(BenchRecord));
+        if (!records) {
+            bench.failed = true;
+            return;
+        }
+        bench.records = records;
+        bench.capacity = capacity;
+    }
+    bench.records[bench.count++] = *R;
+    if (bench.format == FORMAT_CONSOLE) {
+        writeConsoleRow(stdout, R);
+        fflush(stdout);
+    }
+}
+
+static void failCase(BenchRecord *R) {
+    R->label = "FAILED";
+    bench.failed = true;
+    endCase(R);
+}
+
+// --- Reports ---
+
+static void writeJSON(FILE *out, const char *executable) {
+    char date[64];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    fprintf(out, "{\n  \"context\": {\n");
+    fprintf(out, "    \"date\": \"%s\",\n", date);
+    fprintf(out, "    \"executable\": \"%s\",\n", executable);
+    fprintf(out, "    \"num_cpus\": %d,\n", hardwareThreads());
+#ifdef NDEBUG
+    fprintf(out, "    \"library_build_type\": \"release\"\n");
+#else
+    fprintf(out, "    \"library_build_type\": \"debug\"\n");
+#endif
+    fprintf(out, "  },\n  \"benchmarks\": [\n");
+    for (int i = 0; i < bench.count; i++) {
+        const BenchRecord *R = &bench.records[i];
+        fprintf(out, "    {\n      \"name\": \"%s\",\n      \"run_name\": \"%s\",\n      \"run_type\": \"iteration\",\n",
+                R->name, R->name);
+        fprintf(out, "      \"iterations\": %lld,\n      \"real_time\": %.6e,\n      \"cpu_time\": %.6e,\n"
+                     "      \"time_unit\": \"ns\"",
+                R->iterations, R->real_time * 1e9, R->cpu_time * 1e9);
+        if (R->bytes > 0) fprintf(out, ",\n      \"bytes_per_second\": %.6e", R->bytes / R->real_time);
+        if (R->items > 0) fprintf(out, ",\n      \"items_per_second\": %.6e", R->items / R->real_time);
+        for (int c = 0; c < R->num_counters; c++)
+            fprintf(out, ",\n      \"%s\": %.6e", R->counters[c].name, R->counters[c].value);
+        if (R->label) fprintf(out, ",\n      \"label\": \"%s\"", R->label);
+        fprintf(out, "\n    }%s\n", i + 1 < bench.count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+// Counter columns are the union over all cases, in order of appearance
+static void writeCSV(FILE *out) {
+    const char *columns[64];
+    int num_columns = 0;
+    for (int i = 0; i < bench.count; i++) {
+        for (int c = 0; c < bench.records[i].num_counters; c++) {
+            const char *name = bench.records[i].counters[c].name;
+            int k = 0;
+            while (k < num_columns && strcmp(columns[k], name) != 0) k++;
+            if (k == num_columns && num_columns < 64) columns[num_columns++] = name;
+        }
+    }
+    fprintf(out, "name,iterations,real_time,cpu_time,time_unit,bytes_per_second,items_per_second,label");
+    for (int k = 0; k < num_columns; k++) fprintf(out, ",%s", columns[k]);
+    fputc('\n', out);
+    for (int i = 0; i < bench.count; i++) {
+        const BenchRecord *R = &bench.records[i];
+        fprintf(out, "\"%s\",%lld,%.6e,%.6e,ns,", R->name, R->iterations, R->real_time * 1e9, R->cpu_time * 1e9);
+        if (R->bytes > 0) fprintf(out, "%.6e", R->bytes / R->real_time);
+        fputc(',', out);
+        if (R->items > 0) fprintf(out, "%.6e", R->items / R->real_time);
+        fprintf(out, ",\"%s\"", R->label ? R->label : "");
+        for (int k = 0; k < num_columns; k++) {
+            fputc(',', out);
+            for (int c = 0; c < R->num_counters; c++) {
+                if (strcmp(R->counters[c].name, columns[k]) == 0) fprintf(out, "%.6e", R->counters[c].value);
+            }
+        }
+        fputc('\n', out);
+    }
+}
+
+static void writeReport(FILE *out, BenchFormat format, const char *executable) {
+    if (format == FORMAT_JSON) writeJSON(out, executable);
+    else if (format == FORMAT_CSV) writeCSV(out);
+    else {
+        writeConsoleHeader(out);
+        for (int i = 0; i < bench.count; i++) writeConsoleRow(out, &bench.records[i]);
+    }
+}
+
+static bool parseFormat(const char *name, BenchFormat *format) {
+    if (strcmp(name, "console") == 0) *format = FORMAT_CONSOLE;
+    else if (strcmp(name, "json") == 0) *format = FORMAT_JSON;
+    else if (strcmp(name, "csv") == 0) *format = FORMAT_CSV;
+    else return false;
+    return true;
+}
+
+// --- Transformations ---
+
+typedef struct {
+    const Automaton *A;
+    bool (*transform)(const Automaton *, Automaton *, FILE *);
+    int result_states;
+} TransformCtx;
+
+static bool transformBody(void *ctx) {
+    TransformCtx *C = ctx;
+    Automaton out;
+    if (!C->transform(C->A, &out, NULL)) return false;
+    C->result_states = out.num_states;
+    freeAutomaton(&out);
+    return true;
+}
+
+static void benchTransform(const char *op, const char *family, const Automaton *A,
+                           bool (*transform)(const Automaton *, Automaton *, FILE *)) {
+    BenchRecord R;
+    if (!beginCase(&R, "%s/%s", op, family)) return;
+    TransformCtx C = { A, transform, 0 };
+    if (!timeBody(&R, transformBody, &C)) {
+        failCase(&R);
+        return;
+    }
+    addCounter(&R, "states", A->num_states);
+    addCounter(&R, "result_states", C.result_states);
+    endCase(&R);
+}
+
+// minimize(); below `reference_limit` states also the table-filling
+// reference, which must produce the same automaton.
+static void benchMinimize(const char *family, const Automaton *A, int reference_limit) {
+    benchTransform("minimize", family, A, minimize);
+    if (A->num_states > reference_limit) return;
+
+    BenchRecord R;
+    if (!beginCase(&R, "minimizeTableFilling/%s", family)) return;
+    TransformCtx C = { A, minimizeTableFilling, 0 };
+    Automaton min, ref;
+    if (!timeBody(&R, transformBody, &C) || !minimize(A, &min, NULL)) {
+        failCase(&R);
+        return;
+    }
+    if (!minimizeTableFilling(A, &ref, NULL)) {
+        freeAutomaton(&min);
+        failCase(&R);
+        return;
+    }
+    addCounter(&R, "states", A->num_states);
+    addCounter(&R, "result_states", C.result_states);
+    checkCase(&R, sameAutomaton(&min, &ref));
+    freeAutomaton(&ref);
+    freeAutomaton(&min);
+    endCase(&R);
+}
+
+typedef struct {
+    const Automaton *A;
+    int result;
+} AnalysisCtx;
+
+static bool analysisBody(void *ctx) {
+    AnalysisCtx *C = ctx;
+    C->result = isDeterministic(C->A, NULL) + isStandard(C->A, NULL) + isComplete(C->A, NULL);
+    return true;
+}
+
+// The three properties checked before each menu transformation
+static void benchAnalysis(const char *family, const Automaton *A) {
+    BenchRecord R;
+    if (!beginCase(&R, "analyze/%s", family)) return;
+    AnalysisCtx C = { A, 0 };
+    if (!timeBody(&R, analysisBody, &C)) {
+        failCase(&R);
+        return;
+    }
+    addCounter(&R, "states", A->num_states);
+    endCase(&R);
+}
+
+static bool languageBody(void *ctx) {
+    AnalysisCtx *C = ctx;
+    LanguageSummary S;
+    if (!summarizeLanguage(C->A, &S, NULL)) return false;
+    C->result = S.num_useful;
+    freeLanguageSummary(&S);
+    return true;
+}
+
+// Emptiness, finiteness and a shortest word in one pass
+static void benchLanguage(const char *family, const Automaton *A) {
+    BenchRecord R;
+    if (!beginCase(&R, "language/%s", family)) return;
+    AnalysisCtx C = { A, 0 };
+    if (!timeBody(&R, languageBody, &C)) {
+        failCase(&R);
+        return;
+    }
+    addCounter(&R, "states", A->num_states);
+    addCounter(&R, "useful_states", C.result);
+    endCase(&R);
+}
+
+// Every transformation that applies to a DFA
+static void benchDFATransforms(const char *family, const Automaton *A, int reference_limit) {
+    benchAnalysis(family, A);
+    benchLanguage(family, A);
+    benchMinimize(family, A, reference_limit);
+    benchTransform("trim", family, A, trim);
+    benchTransform("complete", family, A, complete);
+    benchTransform("standardize", family, A, standardize);
+}
+
+// --- Word Matching ---
+
+typedef struct {
+    const char *words;
+    int num_words;
+    int length;
+    const Automaton *A;
+    const DenseDFA *D;
+    NFASimulator *sim;
+    LazyDFA *lazy;
+    int accepted;
+} WordsCtx;
+
+#define WORD(C, w) ((C)->words + (size_t)(w) * ((C)->length + 1))
+
+static bool recognizeBody(void *ctx) {
+    WordsCtx *C = ctx;
+    C->accepted = 0;
+    for (int w = 0; w < C->num_words; w++) C->accepted += recognizeWord(C->A, WORD(C, w), NULL);
+    return true;
+}
+
+static bool recognizeDFABody(void *ctx) {
+    WordsCtx *C = ctx;
+    C->accepted = 0;
+    for (int w = 0; w < C->num_words; w++) C->accepted += recognizeWordDFA(C->D, WORD(C, w));
+    return true;
+}
+
+static bool simulateBody(void *ctx) {
+    WordsCtx *C = ctx;
+    C->accepted = 0;
+    for (int w = 0; w < C->num_words; w++) C->accepted += nfaSimAccepts(C->sim, WORD(C, w));
+    return true;
+}
+
+static bool lazyBody(void *ctx) {
+    WordsCtx *C = ctx;
+    C->accepted = 0;
+    for (int w = 0; w < C->num_words; w++) C->accepted += lazyDFAAccepts(C->lazy, WORD(C, w));
+    return true;
+}
+
+// Times body over the words; the accepted count is returned in *accepted
+static bool benchWords(const char *name, BenchBody body, WordsCtx *C, int *accepted, const char *label) {
+    BenchRecord R;
+    if (!beginCase(&R, "%s", name)) return true;
+    if (!timeBody(&R, body, C)) {
+        failCase(&R);
+        return false;
+    }
+    R.items = C->num_words;
+    R.bytes = (double)C->num_words * (C->length + 1);
+    addCounter(&R, "accepted", C->accepted);
+    if (accepted) *accepted = C->accepted;
+    if (label) checkCase(&R, strcmp(label, "same") == 0);
+    endCase(&R);
+    return true;
+}
+
+typedef struct {
+    const BatchMatcher *M;
+    const char *buffer;
+    size_t size;
+    int threads;
+    bool bitmap;
+    BatchResult result;
+} BufferCtx;
+
+static bool bufferBody(void *ctx) {
+    BufferCtx *C = ctx;
+    freeBatchResult(&C->result);
+    initBatchResult(&C->result, C->bitmap);
+    return matchBufferParallel(C->M, C->buffer, C->size, C->threads, &C->result);
+}
+
+// The same random words through recognizeWord() (automaton layout),
+// recognizeWordDFA() (frozen table) and the batch matcher (one
+// newline-delimited buffer); the accepted counts must agree.
+static void benchRecognize(const char *family, const Automaton *A, int num_words, int length) {
+    DenseDFA D;
+    char *words = generateWords(num_words, length, A->num_symbols, 1234);
+    if (!words || !freezeDFA(A, &D, NULL)) {
+        free(words);
+        bench.failed = true;
+        return;
+    }
+    char name[96];
+    WordsCtx C = { words, num_words, length, A, &D, NULL, NULL, 0 };
+    int accepted_list = -1, accepted_dense = -1;
+    snprintf(name, sizeof(name), "recognizeWord/%s", family);
+    benchWords(name, recognizeBody, &C, &accepted_list, NULL);
+    snprintf(name, sizeof(name), "recognizeWordDFA%s/%s", D.narrow ? "16" : "32", family);
+    benchWords(name, recognizeDFABody, &C, &accepted_dense, NULL);
+
+    size_t size = (size_t)num_words * (length + 1);
+    for (int w = 0; w < num_words; w++) words[(size_t)w * (length + 1) + length] = '\n';
+    BatchMatcher M;
+    BenchRecord R;
+    if (buildBatchMatcher(&D, &M)) {
+        if (beginCase(&R, "matchBuffer/%s", family)) {
+            BufferCtx B = { &M, words, size, 1, false, { 0 } };
+            initBatchResult(&B.result, false);
+            if (timeBody(&R, bufferBody, &B)) {
+                R.items = num_words;
+                R.bytes = (double)size;
+                addCounter(&R, "accepted", (double)B.result.num_accepted);
+                // Counts not measured (filtered out) are not compared
+                checkCase(&R, (accepted_list < 0 || accepted_list == B.result.num_accepted) &&
+                              (accepted_dense < 0 || accepted_dense == B.result.num_accepted));
+                endCase(&R);
+            } else {
+                failCase(&R);
+            }
+            freeBatchResult(&B.result);
+        }
+        freeBatchMatcher(&M);
+    } else {
+        bench.failed = true;
+    }
+    free(words);
+    freeDenseDFA(&D);
+}
+
+// One large newline-delimited buffer (words of 1 to 32 letters) matched with
+// 1, 2, 4... threads up to the core count (at least 4, to exercise the
+// chunking even on small machines); counts and bitmaps must match 1 thread.
+static void benchParallel(const char *family, const Automaton *A, size_t size) {
+    BenchRecord R;
+    if (!beginCase(&R, "matchParallel/%s", family)) return;
+    DenseDFA D;
+    BatchMatcher M;
+    if (!freezeDFA(A, &D, NULL)) {
+        failCase(&R);
+        return;
+    }
+    bool built = buildBatchMatcher(&D, &M);
+    freeDenseDFA(&D);
+    char *buffer = malloc(size);
+    if (!built || !buffer) {
+        if (built) freeBatchMatcher(&M);
+        free(buffer);
+        failCase(&R);
+        return;
+    }
+    GenRandom random;
+    genSeed(&random, 777);
+    for (size_t i = 0; i < size;) {
+        int length = 1 + (int)genBelow(&random, 32);
+        for (int c = 0; c < length && i < size; c++) buffer[i++] = (char)('a' + genBelow(&random, A->num_symbols));
+        if (i < size) buffer[i++] = '\n';
+    }
+
+    BatchResult reference;
+    initBatchResult(&reference, true);
+    double base_time = 0;
+    int max_threads = hardwareThreads() > 4 ? hardwareThreads() : 4;
+    // 1, 2, 4, ... then max_threads itself (e.g. 24 cores: ..., 8, 16, 24)
+    for (int threads = 1;; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+        beginCase(&R, "matchParallel/%s/threads:%d", family, threads);
+        BufferCtx B = { &M, buffer, size, threads, true, { 0 } };
+        initBatchResult(&B.result, true);
+        if (!timeBody(&R, bufferBody, &B)) {
+            failCase(&R);
+            freeBatchResult(&B.result);
+            break;
+        }
+        bool same = true;
+        if (threads == 1) {
+            freeBatchResult(&reference);
+            reference = B.result;
+            base_time = R.real_time;
+        } else {
+            same = B.result.num_words == reference.num_words && B.result.num_accepted == reference.num_accepted &&
+                   memcmp(B.result.bitmap, reference.bitmap,
+                          (size_t)((reference.num_words + 63) >> 6) * sizeof(uint64_t)) == 0;
+            freeBatchResult(&B.result);
+        }
+        R.bytes = (double)size;
+        R.items = (double)reference.num_words;
+        addCounter(&R, "threads", threads);
+        addCounter(&R, "speedup", base_time / R.real_time);
+        checkCase(&R, same);
+        endCase(&R);
+        if (threads == max_threads) break;
+    }
+    freeBatchResult(&reference);
+    freeBatchMatcher(&M);
+    free(buffer);
+}
+
+// Matches words directly on the NFA (active state set per character). When
+// `reference` is given (the DFA of the same language), its frozen table is
+// timed on the same words and the verdicts must agree.
+static void benchSimulate(const char *family, const Automaton *A, const Automaton *reference, int num_words, int length) {
+    NFASimulator sim;
+    char *words = generateWords(num_words, length, A->num_symbols, 4321);
+    if (!words || !nfaSimInit(&sim, A)) {
+        free(words);
+        bench.failed = true;
+        return;
+    }
+    char name[96];
+    WordsCtx C = { words, num_words, length, A, NULL, &sim, NULL, 0 };
+    int accepted = -1;
+    snprintf(name, sizeof(name), "nfaSimulate/%s", family);
+    benchWords(name, simulateBody, &C, &accepted, NULL);
+
+    DenseDFA D;
+    if (reference && accepted >= 0 && freezeDFA(reference, &D, NULL)) {
+        C.D = &D;
+        int expected = 0;
+        for (int w = 0; w < num_words; w++) expected += recognizeWordDFA(&D, WORD(&C, w));
+        snprintf(name, sizeof(name), "nfaSimulate/%s/dfa", family);
+        benchWords(name, recognizeDFABody, &C, NULL, expected == accepted ? "same" : "MISMATCH");
+        freeDenseDFA(&D);
+    }
+    nfaSimFree(&sim);
+    free(words);
+}
+
+// Matches words through a lazy DFA with the given cache cap; the verdicts
+// must match plain NFA simulation. With vocabulary > 0 the words are drawn
+// from that many distinct ones, as in a log with recurring entries.
+static void benchLazy(const char *family, const Automaton *A, size_t memory_limit, int num_words, int length, int vocabulary) {
+    BenchRecord R;
+    if (!beginCase(&R, "lazyDFA/%s/cache:%zuKB", family, memory_limit >> 10)) return;
+    LazyDFA L;
+    NFASimulator sim;
+    char *words = generateWords(num_words, length, A->num_symbols, 4321);
+    if (!words || !lazyDFAInit(&L, A, memory_limit)) {
+        free(words);
+        failCase(&R);
+        return;
+    }
+    if (!nfaSimInit(&sim, A)) {
+        lazyDFAFree(&L);
+        free(words);
+        failCase(&R);
+        return;
+    }
+    GenRandom random;
+    genSeed(&random, 99);
+    for (int w = vocabulary; vocabulary > 0 && w < num_words; w++) {
+        memcpy(words + (size_t)w * (length + 1), words + (size_t)genBelow(&random, vocabulary) * (length + 1), length + 1);
+    }
+
+    WordsCtx C = { words, num_words, length, A, NULL, &sim, &L, 0 };
+    simulateBody(&C);
+    int expected = C.accepted;
+    if (timeBody(&R, lazyBody, &C)) {
+        R.items = num_words;
+        R.bytes = (double)num_words * (length + 1);
+        addCounter(&R, "states", lazyDFACachedStates(&L));
+        addCounter(&R, "hits", (double)L.stats.hits / R.iterations);
+        addCounter(&R, "misses", (double)L.stats.misses / R.iterations);
+        addCounter(&R, "flushes", (double)L.stats.flushes / R.iterations);
+        addCounter(&R, "nfa_words", (double)L.stats.nfa_words / R.iterations);
+        checkCase(&R, C.accepted == expected);
+        endCase(&R);
+    } else {
+        failCase(&R);
+    }
+    nfaSimFree(&sim);
+    lazyDFAFree(&L);
+    free(words);
+}
+
+// --- Binary DFA ---
+
+typedef struct {
+    const Automaton *A;
+    const char *path;
+    bool verify;
+    int states;
+} DFAImageCtx;
+
+// Text automaton -> determinized, minimized, frozen DFA
+static bool pipelineBody(void *ctx) {
+    DFAImageCtx *C = ctx;
+    Automaton det, min;
+    DenseDFA D;
+    if (!determinize(C->A, &det, NULL)) return false;
+    bool ok = minimize(&det, &min, NULL);
+    freeAutomaton(&det);
+    if (!ok) return false;
+    ok = freezeDFA(&min, &D, NULL);
+    freeAutomaton(&min);
+    if (ok) {
+        C->states = D.num_states;
+        freeDenseDFA(&D);
+    }
+    return ok;
+}
+
+static bool mapBody(void *ctx) {
+    DFAImageCtx *C = ctx;
+    DenseDFA D;
+    if (!loadDenseDFA(C->path, &D, C->verify, NULL)) return false;
+    C->states = D.num_states;
+    freeDenseDFA(&D);
+    return true;
+}
+
+// Time to a ready DFA: the full pipeline (determinize, minimize, freeze)
+// against mapping the saved binary image, with and without verification.
+// The mapped DFA must give the same verdicts.
+static void benchBinary(const char *family, const Automaton *A) {
+    const char *path = "AutomateBench_dfa.bin";
+    DFAImageCtx C = { A, path, false, 0 };
+    BenchRecord R;
+    if (beginCase(&R, "dfaPipeline/%s", family)) {
+        if (timeBody(&R, pipelineBody, &C)) {
+            addCounter(&R, "states", C.states);
+            endCase(&R);
+        } else {
+            failCase(&R);
+        }
+    }
+
+    Automaton det, min;
+    DenseDFA built, mapped;
+    if (!determinize(A, &det, NULL)) {
+        bench.failed = true;
+        return;
+    }
+    bool ok = minimize(&det, &min, NULL);
+    freeAutomaton(&det);
+    ok = ok && freezeDFA(&min, &built, NULL);
+    if (ok) freeAutomaton(&min);
+    if (!ok || !saveDenseDFA(&built, path, NULL)) {
+        if (ok) freeDenseDFA(&built);
+        bench.failed = true;
+        return;
+    }
+
+    for (int verify = 0; verify <= 1; verify++) {
+        if (!beginCase(&R, "loadDenseDFA/%s/%s", family, verify ? "verify" : "map")) continue;
+        C.verify = verify;
+        if (!timeBody(&R, mapBody, &C)) {
+            failCase(&R);
+            continue;
+        }
+        addCounter(&R, "states", C.states);
+        if (verify) {
+            endCase(&R);
+            continue;
+        }
+        int num_words = 100000, length = 32;
+        char *words = generateWords(num_words, length, A->num_symbols, 99);
+        bool same = words != NULL && loadDenseDFA(path, &mapped, false, NULL);
+        if (same) {
+            for (int w = 0; same && w < num_words; w++) {
+                const char *word = words + (size_t)w * (length + 1);
+                same = recognizeWordDFA(&built, word) == recognizeWordDFA(&mapped, word);
+            }
+            freeDenseDFA(&mapped);
+        }
+        free(words);
+        checkCase(&R, same);
+        endCase(&R);
+    }
+    remove(path);
+    freeDenseDFA(&built);
+}
+
+// --- Logging ---
+
+typedef struct {
+    const Automaton *A;
+    int mode;
+    long size;
+} LoggingCtx;
+
+static const char *loggingModes[] = { "flush", "buffer", "async", "summary" };
+
+static bool loggingBody(void *ctx) {
+    LoggingCtx *C = ctx;
+    FILE *file = fopen("AutomateBench_log.txt", "w");
+    if (!file) return false;
+    LogOptions O;
+    logDefaultOptions(&O);
+    O.console = false;
+    O.level = C->mode < 3 ? LOG_DEBUG : LOG_INFO;
+    O.async = C->mode == 2;
+    logOpen(C->mode == 0 ? NULL : file, &O);
+    printAutomaton(C->A, file);
+    logClose();
+    C->size = ftell(file);
+    fclose(file);
+    return true;
+}
+
+// Full dump of a large automaton to a log file (console echo off): one flush
+// per message (unbound file), buffered, buffered with the background writer,
+// then the summary printed at the default level. The three dumps must match.
+static void benchLogging(const char *family, const Automaton *A) {
+    long full_size = -1;
+    for (int m = 0; m < 4; m++) {
+        BenchRecord R;
+        if (!beginCase(&R, "printAutomaton/%s/%s", family, loggingModes[m])) continue;
+        LoggingCtx C = { A, m, 0 };
+        bool ok = timeBody(&R, loggingBody, &C);
+        remove("AutomateBench_log.txt");
+        if (!ok) {
+            failCase(&R);
+            continue;
+        }
+        R.bytes = (double)C.size;
+        if (m < 3) {
+            if (full_size < 0) full_size = C.size;
+            checkCase(&R, C.size == full_size);
+        }
+        endCase(&R);
+    }
+    LogOptions O;
+    logDefaultOptions(&O);
+    logOpen(NULL, &O);
+}
+
+// --- Loading ---
+
+// Writes a random NFA in the text format; returns the file size (0 on failure).
+static long writeRandomAutomaton(const char *path, int num_states, int num_symbols, int num_trans) {
+    FILE *file = fopen(path, "w");
+    if (!file) return 0;
+    GenRandom random;
+    genSeed(&random, 99);
+    fprintf(file, "%d\n%d\n1 0\n1 %d\n%d\n", num_symbols, num_states, num_states - 1, num_trans);
+    for (int i = 0; i < num_trans; i++) {
+        int from = (int)genBelow(&random, num_states);
+        int symbol = (int)genBelow(&random, num_symbols);
+        fprintf(file, "%d %c %d\n", from, 'a' + symbol, (int)genBelow(&random, num_states));
+    }
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+// The former fscanf-based loader, kept as the parsing baseline.
+static bool loadWithFscanf(const char *path, Automaton *A) {
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+    int n_sym, n_states, n_init, n_final, n_trans, state;
+    bool ok = fscanf(file, "%d %d %d", &n_sym, &n_states, &n_init) == 3 && createAutomaton(A, n_states, n_sym);
+    for (int i = 0; ok && i < n_init; i++) ok = fscanf(file, "%d", &state) == 1;
+    ok = ok && fscanf(file, "%d", &n_final) == 1;
+    for (int i = 0; ok && i < n_final; i++) ok = fscanf(file, "%d", &state) == 1;
+    ok = ok && fscanf(file, "%d", &n_trans) == 1;
+
+    AutomatonBuilder builder;
+    if (ok && builderInit(&builder, n_states, n_sym, n_trans)) {
+        for (int i = 0; i < n_trans; i++) {
+            int u, v;
+            char c;
+            if (fscanf(file, "%d %c %d", &u, &c, &v) == 3) builderAdd(&builder, u, c - 'a', v);
+        }
+        ok = builderFreeze(&builder, A);
+        if (!ok) builderFree(&builder);
+    }
+    fclose(file);
+    return ok;
+}
+
+typedef struct {
+    const char *path;
+    bool (*load)(const char *path, Automaton *A);
+    Automaton *source;      // insertBody: transitions to copy
+    size_t footprint;
+} LoadCtx;
+
+static bool loadText(const char *path, Automaton *A) {
+    return loadAutomaton(path, A, NULL);
+}
+
+static bool loadBody(void *ctx) {
+    LoadCtx *C = ctx;
+    Automaton A;
+    if (!C->load(C->path, &A)) return false;
+    C->footprint = automatonFootprint(&A);
+    freeAutomaton(&A);
+    return true;
+}
+
+// Same transitions inserted one by one with addTransition() (per-cell lists)
+static bool insertBody(void *ctx) {
+    LoadCtx *C = ctx;
+    const Automaton *S = C->source;
+    Automaton lists;
+    if (!createAutomaton(&lists, S->num_states, S->num_symbols)) return false;
+    bool ok = true;
+    for (int c = 0; ok && c < S->num_states * S->num_symbols; c++) {
+        int count;
+        const int *dests = cellTransitions(S, c, &count);
+        for (int t = 0; ok && t < count; t++) ok = addTransition(&lists, c / S->num_symbols, c % S->num_symbols, dests[t]);
+    }
+    C->footprint = automatonFootprint(&lists);
+    freeAutomaton(&lists);
+    return ok;
+}
+
+static void timeLoad(BenchRecord *R, BenchBody body, LoadCtx *C, long size) {
+    if (!timeBody(R, body, C)) {
+        failCase(R);
+        return;
+    }
+    if (size > 0) R->bytes = (double)size;
+    addCounter(R, "footprint_MB", C->footprint / 1048576.0);
+    endCase(R);
+}
+
+// loadAutomaton() (mapped tokenizer, builder -> CSR) against the fscanf
+// baseline, which must produce the same transitions, and against inserting
+// the transitions one by one into per-cell lists.
+static void benchLoad(const char *family, int num_states, int num_symbols, int num_trans, bool baselines) {
+    const char *path = "AutomateBench_load.txt";
+    long size = writeRandomAutomaton(path, num_states, num_symbols, num_trans);
+    if (size <= 0) {
+        bench.failed = true;
+        return;
+    }
+    BenchRecord R;
+    LoadCtx C = { path, loadText, NULL, 0 };
+    if (beginCase(&R, "loadAutomaton/%s", family)) timeLoad(&R, loadBody, &C, size);
+    if (!baselines) {
+        remove(path);
+        return;
+    }
+
+    Automaton loaded, baseline;
+    if (!loadAutomaton(path, &loaded, NULL)) {
+        remove(path);
+        bench.failed = true;
+        return;
+    }
+    if (beginCase(&R, "loadFscanf/%s", family)) {
+        C.load = loadWithFscanf;
+        if (timeBody(&R, loadBody, &C) && loadWithFscanf(path, &baseline)) {
+            bool same = loaded.num_states == baseline.num_states;
+            for (int c = 0; same && c < loaded.num_states * loaded.num_symbols; c++) {
+                int count_x, count_y;
+                const int *x = cellTransitions(&loaded, c, &count_x), *y = cellTransitions(&baseline, c, &count_y);
+                same = count_x == count_y && memcmp(x, y, count_x * sizeof(int)) == 0;
+            }
+            freeAutomaton(&baseline);
+            R.bytes = (double)size;
+            checkCase(&R, same);
+            endCase(&R);
+        } else {
+            failCase(&R);
+        }
+    }
+    if (beginCase(&R, "insertLists/%s", family)) {
+        C.source = &loaded;
+        timeLoad(&R, insertBody, &C, 0);
+    }
+    freeAutomaton(&loaded);
+    remove(path);
+}
+
+// --- Product Constructions ---
+
+typedef struct {
+    const Automaton *const *inputs;
+    int count;
+    ProductOp op;
+    bool fold;
+    int result_states;
+} ProductCtx;
+
+// Pairwise fold, minimizing each intermediate product
+static bool productFold(const Automaton *const *inputs, int count, ProductOp op, Automaton *out) {
+    Automaton acc, step;
+    if (!productAutomata(inputs, 1, op, &step, NULL)) return false;
+    bool ok = minimize(&step, &acc, NULL);
+    freeAutomaton(&step);
+    for (int i = 1; ok && i < count; i++) {
+        ok = productAutomaton(&acc, inputs[i], op, &step, NULL);
+        freeAutomaton(&acc);
+        if (!ok) break;
+        ok = minimize(&step, &acc, NULL);
+        freeAutomaton(&step);
+    }
+    if (ok) *out = acc;
+    return ok;
+}
+
+static bool productBody(void *ctx) {
+    ProductCtx *C = ctx;
+    Automaton out;
+    bool ok = C->fold ? productFold(C->inputs, C->count, C->op, &out)
+                      : productAutomata(C->inputs, C->count, C->op, &out, NULL);
+    if (!ok) return false;
+    C->result_states = out.num_states;
+    freeAutomaton(&out);
+    return true;
+}
+
+static bool productVerdict(const Automaton *const *inputs, int count, ProductOp op, const char *word) {
+    bool first = recognizeWord(inputs[0], word, NULL);
+    int accepted = first;
+    for (int i = 1; i < count; i++) accepted += recognizeWord(inputs[i], word, NULL);
+    switch (op) {
+        case PRODUCT_INTERSECTION: return accepted == count;
+        case PRODUCT_UNION: return accepted > 0;
+        case PRODUCT_DIFFERENCE: return first && accepted == 1;
+        case PRODUCT_SYMMETRIC_DIFFERENCE: return accepted & 1;
+    }
+    return false;
+}
+
+// The n-ary product in one pass, then (with more than two inputs) the
+// pairwise fold it replaces. Both minimized results must have the same
+// size, and the product's verdicts on random words must match the inputs'.
+static void benchProduct(const char *family, const Automaton *const *inputs, int count, ProductOp op) {
+    BenchRecord R;
+    if (!beginCase(&R, "product/%s/%s", productOpName(op), family)) return;
+    ProductCtx C = { inputs, count, op, false, 0 };
+    Automaton product, min, folded;
+    if (!timeBody(&R, productBody, &C) || !productAutomata(inputs, count, op, &product, NULL)) {
+        failCase(&R);
+        return;
+    }
+    bool ok = minimize(&product, &min, NULL);
+    if (ok && !productFold(inputs, count, op, &folded)) {
+        freeAutomaton(&min);
+        ok = false;
+    }
+    const int num_words = 2000, length = 8;
+    char *words = ok ? generateWords(num_words, length, inputs[0]->num_symbols, 99) : NULL;
+    if (!words) {
+        if (ok) {
+            freeAutomaton(&min);
+            freeAutomaton(&folded);
+        }
+        freeAutomaton(&product);
+        failCase(&R);
+        return;
+    }
+    bool same = min.num_states == folded.num_states;
+    for (int w = 0; same && w < num_words; w++) {
+        const char *word = words + (size_t)w * (length + 1);
+        same = recognizeWord(&product, word, NULL) == productVerdict(inputs, count, op, word);
+    }
+    addCounter(&R, "inputs", count);
+    addCounter(&R, "result_states", C.result_states);
+    addCounter(&R, "minimal_states", min.num_states);
+    checkCase(&R, same);
+    endCase(&R);
+
+    if (count > 2 && beginCase(&R, "productFold/%s/%s", productOpName(op), family)) {
+        C.fold = true;
+        if (timeBody(&R, productBody, &C)) {
+            addCounter(&R, "inputs", count);
+            addCounter(&R, "result_states", C.result_states);
+            endCase(&R);
+        } else {
+            failCase(&R);
+        }
+    }
+    free(words);
+    freeAutomaton(&folded);
+    freeAutomaton(&min);
+    freeAutomaton(&product);
+}
+
+// --- Language Checks ---
+
+typedef struct {
+    const Automaton *A;
+    const Automaton *B;
+    bool inclusion;
+    LanguageCheck result;
+} CheckCtx;
+
+static bool checkBody(void *ctx) {
+    CheckCtx *C = ctx;
+    freeLanguageCheck(&C->result);
+    return C->inclusion ? checkInclusion(C->A, C->B, &C->result, NULL)
+                        : checkEquivalence(C->A, C->B, &C->result, NULL);
+}
+
+// checkEquivalence() or checkInclusion() must answer `expected`, and a
+// counterexample must be accepted by exactly the automaton it names.
+static void benchCheck(const char *family, const Automaton *A, const Automaton *B, bool inclusion, bool expected) {
+    BenchRecord R;
+    if (!beginCase(&R, "%s/%s", inclusion ? "inclusion" : "equivalence", family)) return;
+    CheckCtx C = { A, B, inclusion, { 0 } };
+    if (!timeBody(&R, checkBody, &C)) {
+        failCase(&R);
+        return;
+    }
+    bool same = C.result.holds == expected;
+    if (same && !C.result.holds) {
+        bool in_A = recognizeWord(A, (const char *)C.result.word, NULL);
+        bool in_B = recognizeWord(B, (const char *)C.result.word, NULL);
+        same = C.result.in_first ? in_A && !in_B : in_B && !in_A;
+        addCounter(&R, "counterexample_length", C.result.length);
+    }
+    addCounter(&R, "states", A->num_states + B->num_states);
+    addCounter(&R, "pairs", (double)C.result.pairs);
+    checkCase(&R, same);
+    endCase(&R);
+    freeLanguageCheck(&C.result);
+}
+
+// --- Minimization Modes ---
+
+// Minimal trim DFA the classic way: determinize (NFAs), trim, minimize
+static bool minimalTrim(const Automaton *A, Automaton *out) {
+    Automaton det, trimmed;
+    bool nfa = !isDeterministic(A, NULL);
+    if (nfa && !determinize(A, &det, NULL)) return false;
+    bool ok = trim(nfa ? &det : A, &trimmed, NULL);
+    if (nfa) freeAutomaton(&det);
+    if (!ok) return false;
+    ok = minimize(&trimmed, out, NULL);
+    freeAutomaton(&trimmed);
+    return ok;
+}
+
+static bool minimalTrimBody(void *ctx) {
+    TransformCtx *C = ctx;
+    Automaton out;
+    if (!minimalTrim(C->A, &out)) return false;
+    C->result_states = out.num_states;
+    freeAutomaton(&out);
+    return true;
+}
+
+// minimizeBrzozowski() against determinize, trim, minimize: both give the
+// minimal trim DFA, so the sizes must match
+static void benchBrzozowski(const char *family, const Automaton *A) {
+    BenchRecord R;
+    if (beginCase(&R, "determinizeMinimize/%s", family)) {
+        TransformCtx C = { A, NULL, 0 };
+        if (timeBody(&R, minimalTrimBody, &C)) {
+            addCounter(&R, "states", A->num_states);
+            addCounter(&R, "result_states", C.result_states);
+            endCase(&R);
+        } else {
+            failCase(&R);
+        }
+    }
+    if (!beginCase(&R, "minimizeBrzozowski/%s", family)) return;
+    TransformCtx C = { A, minimizeBrzozowski, 0 };
+    Automaton ref;
+    if (!timeBody(&R, transformBody, &C) || !minimalTrim(A, &ref)) {
+        failCase(&R);
+        return;
+    }
+    addCounter(&R, "states", A->num_states);
+    addCounter(&R, "result_states", C.result_states);
+    checkCase(&R, C.result_states == ref.num_states);
+    freeAutomaton(&ref);
+    endCase(&R);
+}
+
+// A dictionary built word by word as a trie, with its minimal DFA read back
+// after every batch of words: kept up to date by the incremental minimizer,
+// or minimized from scratch on each batch.
+typedef struct {
+    const char *words;
+    int num_words;
+    int length;
+    int num_symbols;
+    int batch;
+    int result_states;
+    IncrementalStats stats;
+} DictionaryCtx;
+
+static bool dictionaryIncrementalBody(void *ctx) {
+    DictionaryCtx *C = ctx;
+    Alphabet L;
+    alphabetDefault(&L, C->num_symbols);
+    IncrementalDFA D;
+    if (!incrementalInit(&D, &L, C->num_symbols)) return false;
+    bool ok = true;
+    for (int w = 0; ok && w < C->num_words; w++) {
+        const unsigned char *word = (const unsigned char *)C->words + (size_t)w * (C->length + 1);
+        int s = D.initial;
+        for (int i = 0; ok && i < C->length; i++) {
+            int to = D.trans[(size_t)s * C->num_symbols + L.symbols[word[i]]];
+            if (to < 0) {
+                to = incrementalAddState(&D, false);
+                ok = to >= 0 && incrementalSetTransition(&D, s, word[i], to, NULL);
+            }
+            s = to;
+        }
+        ok = ok && incrementalSetFinal(&D, s, true);
+        if (ok && ((w + 1) % C->batch == 0 || w + 1 == C->num_words)) {
+            Automaton min;
+            ok = incrementalMinimal(&D, &min);
+            if (ok) {
+                C->result_states = min.num_states;
+                freeAutomaton(&min);
+            }
+        }
+    }
+    C->stats = D.stats;
+    incrementalFree(&D);
+    return ok;
+}
+
+static bool dictionaryRebuildBody(void *ctx) {
+    DictionaryCtx *C = ctx;
+    int k = C->num_symbols, n = 1, capacity = 1024;
+    int *trans = malloc((size_t)capacity * k * sizeof(int));
+    bool *final = calloc(capacity, sizeof(bool));
+    bool ok = trans && final;
+    if (ok) {
+        for (int sym = 0; sym < k; sym++) trans[sym] = -1;
+    }
+    for (int w = 0; ok && w < C->num_words; w++) {
+        const char *word = C->words + (size_t)w * (C->length + 1);
+        int s = 0;
+        for (int i = 0; ok && i < C->length; i++) {
+            int cell = s * k + (word[i] - 'a');
+            if (trans[cell] < 0) {
+                if (n == capacity) {
+                    capacity *= 2;
+                    int *temp_trans = realloc(trans, (size_t)capacity * k * sizeof(int));
+                    if (temp_trans) trans = temp_trans;
+                    bool *temp_final = temp_trans ? realloc(final, capacity * sizeof(bool)) : NULL;
+                    if (temp_final) final = temp_final;
+                    ok = temp_trans && temp_final;
+                    if (!ok) break;
+                }
+                for (int sym = 0; sym < k; sym++) trans[(size_t)n * k + sym] = -1;
+                final[n] = false;
+                trans[cell] = n++;
+            }
+            s = trans[cell];
+        }
+        if (ok) final[s] = true;
+        if (ok && ((w + 1) % C->batch == 0 || w + 1 == C->num_words)) {
+            Automaton trie, min;
+            ok = createDeterministic(&trie, n, k, trans, 1);
+            if (!ok) break;
+            trie.initials[0] = 0;
+            for (int q = 0; q < n; q++) {
+                if (final[q]) trie.finals[trie.num_finals++] = q;
+            }
+            ok = minimize(&trie, &min, NULL);
+            freeAutomaton(&trie);
+            if (ok) {
+                C->result_states = min.num_states;
+                freeAutomaton(&min);
+            }
+        }
+    }
+    free(trans);
+    free(final);
+    return ok;
+}
+
+static void benchDictionary(int num_words, int length, int num_symbols, int batch) {
+    char *words = generateWords(num_words, length, num_symbols, 77);
+    if (!words) {
+        bench.failed = true;
+        return;
+    }
+    BenchRecord R;
+    DictionaryCtx rebuild = { words, num_words, length, num_symbols, batch, -1, { 0 } };
+    if (beginCase(&R, "dictionaryRebuild/%dx%d/batch:%d", num_words, length, batch)) {
+        if (timeBody(&R, dictionaryRebuildBody, &rebuild)) {
+            addCounter(&R, "result_states", rebuild.result_states);
+            endCase(&R);
+        } else {
+            failCase(&R);
+        }
+    }
+    if (beginCase(&R, "dictionaryIncremental/%dx%d/batch:%d", num_words, length, batch)) {
+        DictionaryCtx C = rebuild;
+        if (timeBody(&R, dictionaryIncrementalBody, &C)) {
+            if (rebuild.result_states < 0) dictionaryRebuildBody(&rebuild);
+            addCounter(&R, "result_states", C.result_states);
+            addCounter(&R, "updates", (double)C.stats.updates);
+            addCounter(&R, "affected", (double)C.stats.affected);
+            checkCase(&R, C.result_states == rebuild.result_states);
+            endCase(&R);
+        } else {
+            failCase(&R);
+        }
+    }
+    free(words);
+}
+
+// Random edits (transitions set or removed, final flags flipped, states
+// added) on small random DFAs, cyclic ones included: after each edit, the
+// incremental minimal DFA must have the size of the one minimalTrim()
+// builds from scratch, and the same language.
+static void benchIncrementalDifferential(int count) {
+    BenchRecord R;
+    if (!beginCase(&R, "incrementalDifferential/%d", count)) return;
+    int mismatches = 0;
+    long long refinements = 0;
+    double start = nowSeconds();
+    for (int seed = 0; seed < count && mismatches == 0; seed++) {
+        GenParams P;
+        genDefaultParams(&P, 2 + seed % 12, 1 + seed % 3, (uint64_t)seed);
+        P.density = 40 + seed % 61;
+        P.final_percent = 33;
+        Automaton A;
+        IncrementalDFA D;
+        if (!generateRandom(&A, &P)) {
+            failCase(&R);
+            return;
+        }
+        bool ok = incrementalInitFrom(&D, &A, NULL);
+        freeAutomaton(&A);
+        if (!ok) {
+            failCase(&R);
+            return;
+        }
+        GenRandom G;
+        genSeed(&G, (uint64_t)seed * 7919u + 1u);
+        for (int edit = 0; edit < 24 && ok && mismatches == 0; edit++) {
+            int choice = (int)genBelow(&G, 10);
+            int from = (int)genBelow(&G, (uint32_t)D.num_states);
+            if (choice == 0) {
+                ok = incrementalAddState(&D, genBelow(&G, 2)) >= 0;
+            } else if (choice < 3) {
+                ok = incrementalSetFinal(&D, from, !D.final[from]);
+            } else {
+                int to = (int)genBelow(&G, (uint32_t)D.num_states + 1) - 1;
+                unsigned char letter = D.alphabet.letters[genBelow(&G, (uint32_t)D.num_symbols)];
+                ok = incrementalSetTransition(&D, from, letter, to, NULL);
+            }
+
+            // The edited DFA itself, rebuilt from D's table
+            Automaton edited, inc, ref;
+            LanguageCheck check = { 0 };
+            if (!ok || !createDeterministic(&edited, D.num_states, D.num_symbols, D.trans, 1)) {
+                ok = false;
+                break;
+            }
+            edited.initials[0] = D.initial;
+            edited.alphabet = D.alphabet;
+            for (int s = 0; s < D.num_states; s++) {
+                if (D.final[s]) edited.finals[edited.num_finals++] = s;
+            }
+            ok = incrementalMinimal(&D, &inc);
+            if (ok && !minimalTrim(&edited, &ref)) {
+                freeAutomaton(&inc);
+                ok = false;
+            }
+            if (ok) {
+                if (inc.num_states != ref.num_states || !checkEquivalence(&inc, &edited, &check, NULL) || !check.holds)
+                    mismatches++;
+                freeLanguageCheck(&check);
+                freeAutomaton(&ref);
+                freeAutomaton(&inc);
+            }
+            freeAutomaton(&edited);
+        }
+        refinements += D.stats.refinements;
+        incrementalFree(&D);
+        if (!ok) {
+            failCase(&R);
+            return;
+        }
+    }
+    R.iterations = 1;
+    R.real_time = R.cpu_time = nowSeconds() - start;
+    R.items = count;
+    addCounter(&R, "mismatches", mismatches);
+    addCounter(&R, "refinements", (double)refinements);
+    checkCase(&R, mismatches == 0);
+    endCase(&R);
+}
+
+// --- Regular Expressions ---
+
+typedef struct {
+    const char *pattern;
+    const Automaton *hand;
+    Automaton result;
+    bool compiled;
+    int result_states;
+} RegexCtx;
+
+static bool regexBody(void *ctx) {
+    RegexCtx *C = ctx;
+    if (C->compiled) freeAutomaton(&C->result);
+    C->compiled = compileRegex(C->pattern, &C->hand->alphabet, C->hand->num_symbols, &C->result, NULL);
+    return C->compiled;
+}
+
+static bool regexMinimalBody(void *ctx) {
+    RegexCtx *C = ctx;
+    Automaton A, min;
+    if (!compileRegex(C->pattern, &C->hand->alphabet, C->hand->num_symbols, &A, NULL)) return false;
+    bool ok = minimalTrim(&A, &min);
+    freeAutomaton(&A);
+    if (ok) {
+        C->result_states = min.num_states;
+        freeAutomaton(&min);
+    }
+    return ok;
+}
+
+// compileRegex() against a hand-written automaton of the same language (and
+// alphabet): the Glushkov NFA must be equivalent to it, and both minimal
+// trim DFAs the same size
+static void benchRegex(const char *family, const char *pattern, const Automaton *hand) {
+    BenchRecord R;
+    if (beginCase(&R, "regex/%s", family)) {
+        RegexCtx C = { pattern, hand, { 0 }, false, 0 };
+        LanguageCheck check = { 0 };
+        if (timeBody(&R, regexBody, &C) && checkEquivalence(&C.result, hand, &check, NULL)) {
+            int cells = C.result.num_states * C.result.num_symbols;
+            addCounter(&R, "pattern_length", (double)strlen(pattern));
+            addCounter(&R, "states", C.result.num_states);
+            addCounter(&R, "hand_states", hand->num_states);
+            addCounter(&R, "transitions", C.result.offsets ? C.result.offsets[cells] : cells);
+            checkCase(&R, check.holds);
+            endCase(&R);
+        } else {
+            failCase(&R);
+        }
+        freeLanguageCheck(&check);
+        if (C.compiled) freeAutomaton(&C.result);
+    }
+    if (!beginCase(&R, "regexMinimal/%s", family)) return;
+    RegexCtx C = { pattern, hand, { 0 }, false, 0 };
+    Automaton ref;
+    if (!timeBody(&R, regexMinimalBody, &C) || !minimalTrim(hand, &ref)) {
+        failCase(&R);
+        return;
+    }
+    addCounter(&R, "result_states", C.result_states);
+    addCounter(&R, "hand_states", ref.num_states);
+    checkCase(&R, C.result_states == ref.num_states);
+    freeAutomaton(&ref);
+    endCase(&R);
+}
+
+// AutomatePerso.txt, the sample automaton, and its language written by hand
+#define PERSO_PATTERN "(ab)*(aca*bc*|ac*(bac*)?)"
+
+static bool persoAutomaton(Automaton *A) {
+    static const int edges[][3] = {
+        { 0, 0, 1 }, { 0, 0, 2 }, { 1, 1, 0 }, { 1, 2, 3 }, { 2, 1, 4 },
+        { 2, 2, 2 }, { 3, 0, 3 }, { 3, 1, 5 }, { 4, 0, 5 }, { 5, 2, 5 }
+    };
+    int num_edges = (int)(sizeof(edges) / sizeof(edges[0]));
+    if (!createAutomatonInArena(A, 6, 3)) return false;
+    A->initials = automatonAlloc(A, sizeof(int));
+    A->finals = automatonAlloc(A, 2 * sizeof(int));
+    AutomatonBuilder B;
+    bool ok = A->initials && A->finals && builderInit(&B, 6, 3, num_edges);
+    if (!ok) {
+        freeAutomaton(A);
+        return false;
+    }
+    A->initials[A->num_initials++] = 0;
+    A->finals[A->num_finals++] = 2;
+    A->finals[A->num_finals++] = 5;
+    for (int e = 0; e < num_edges && ok; e++) ok = builderAdd(&B, edges[e][0], edges[e][1], edges[e][2]);
+    if (!ok || !builderFreeze(&B, A)) {
+        builderFree(&B);
+        freeAutomaton(A);
+        return false;
+    }
+    return true;
+}
+
+// [a-z_][a-z0-9_]*: two states over the 37 identifier letters
+static bool identifierAutomaton(Automaton *A) {
+    static const char letters[] = "_0123456789abcdefghijklmnopqrstuvwxyz";
+    int k = (int)strlen(letters);
+    int trans[2 * 37];
+    for (int sym = 0; sym < k; sym++) {
+        trans[sym] = letters[sym] >= '0' && letters[sym] <= '9' ? -1 : 1;
+        trans[k + sym] = 1;
+    }
+    if (!createDeterministic(A, 2, k, trans, 1)) return false;
+    alphabetSet(&A->alphabet, (const unsigned char *)letters, k);
+    A->initials[0] = 0;
+    A->finals[A->num_finals++] = 1;
+    return true;
+}
+
+// num_words random words as one alternation, against their trie
+static void benchRegexKeywords(int num_words, int length, int num_symbols) {
+    char family[64];
+    snprintf(family, sizeof(family), "keywords/%d", num_words);
+    char *words = generateWords(num_words, length, num_symbols, 17u);
+    char *pattern = malloc((size_t)num_words * (length + 1));
+    int *trans = malloc(((size_t)num_words * length + 1) * num_symbols * sizeof(int));
+    bool *final = calloc((size_t)num_words * length + 1, sizeof(bool));
+    Automaton trie;
+    bool ok = words && pattern && trans && final;
+    if (ok) {
+        int n = 1;
+        memset(trans, -1, (size_t)num_symbols * sizeof(int));
+        for (int w = 0; w < num_words; w++) {
+            const char *word = words + (size_t)w * (length + 1);
+            memcpy(pattern + (size_t)w * (length + 1), word, length);
+            pattern[(size_t)w * (length + 1) + length] = w + 1 < num_words ? '|' : '\0';
+            int s = 0;
+            for (int i = 0; i < length; i++) {
+                int cell = s * num_symbols + (word[i] - 'a');
+                if (trans[cell] == -1) {
+                    memset(trans + (size_t)n * num_symbols, -1, num_symbols * sizeof(int));
+                    trans[cell] = n++;
+                }
+                s = trans[cell];
+            }
+            final[s] = true;
+        }
+        ok = createDeterministic(&trie, n, num_symbols, trans, 1);
+        if (ok) {
+            trie.initials[0] = 0;
+            for (int q = 0; q < n; q++) {
+                if (final[q]) trie.finals[trie.num_finals++] = q;
+            }
+        }
+    }
+    if (ok) {
+        benchRegex(family, pattern, &trie);
+        freeAutomaton(&trie);
+    }
+    free(words);
+    free(pattern);
+    free(trans);
+    free(final);
+}
+
+static void benchRegexFamilies(void) {
+    Automaton hand;
+    if (persoAutomaton(&hand)) {
+        benchRegex("perso", PERSO_PATTERN, &hand);
+        freeAutomaton(&hand);
+    }
+    if (identifierAutomaton(&hand)) {
+        benchRegex("identifier", "[a-z_][a-z0-9_]*", &hand);
+        freeAutomaton(&hand);
+    }
+    char pattern[256];
+    for (int n = 4; n <= 12; n += 8) {
+        char family[32];
+        snprintf(family, sizeof(family), "blowup/%d", n);
+        snprintf(pattern, sizeof(pattern), "(a|b)*a");
+        for (int i = 0; i < n; i++) strcat(pattern, "(a|b)");
+        if (!generateBlowup(&hand, n)) continue;
+        benchRegex(family, pattern, &hand);
+        freeAutomaton(&hand);
+    }
+    benchRegexKeywords(2000, 8, 4);
+    benchRegexKeywords(20000, 8, 4);
+}
+
+// --- Differential Sweep ---
+
+// Many small partial DFAs: minimize() against the table-filling reference
+static void benchDifferential(int count) {
+    BenchRecord R;
+    if (!beginCase(&R, "minimizeDifferential/%d", count)) return;
+    int mismatches = 0;
+    double start = nowSeconds();
+    for (int seed = 0; seed < count; seed++) {
+        GenParams P;
+        genDefaultParams(&P, 5 + seed % 40, 1 + seed % 4, (uint64_t)seed);
+        P.density = 50 + seed % 51;
+        P.final_percent = 33;
+        Automaton A, min, ref;
+        if (!generateRandom(&A, &P)) {
+            failCase(&R);
+            return;
+        }
+        if (!minimize(&A, &min, NULL)) mismatches++;
+        else {
+            if (!minimizeTableFilling(&A, &ref, NULL) || !sameAutomaton(&min, &ref)) mismatches++;
+            else freeAutomaton(&ref);
+            freeAutomaton(&min);
+        }
+        freeAutomaton(&A);
+    }
+    R.iterations = 1;
+    R.real_time = R.cpu_time = nowSeconds() - start;
+    R.items = count;
+    addCounter(&R, "mismatches", mismatches);
+    checkCase(&R, mismatches == 0);
+    endCase(&R);
+}
+
+// --- Suite ---
+
+static bool randomAutomaton(Automaton *A, int num_states, int num_symbols, int density, int degree,
+                            int final_percent, uint64_t seed) {
+    GenParams P;
+    genDefaultParams(&P, num_states, num_symbols, seed);
+    P.density = density;
+    P.degree = degree;
+    P.final_percent = final_percent;
+    return generateRandom(A, &P);
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = strchr(arg, '=');
+        bool ok = value != NULL;
+        if (ok) value++;
+        if (ok && strncmp(arg, "--benchmark_filter=", 19) == 0) bench.filter = value;
+        else if (ok && strncmp(arg, "--benchmark_min_time=", 21) == 0) bench.min_time = atof(value);
+        else if (ok && strncmp(arg, "--benchmark_format=", 19) == 0) ok = parseFormat(value, &bench.format);
+        else if (ok && strncmp(arg, "--benchmark_out=", 16) == 0) bench.out_path = value;
+        else if (ok && strncmp(arg, "--benchmark_out_format=", 23) == 0) ok = parseFormat(value, &bench.out_format);
+        else ok = false;
+        if (!ok) {
+            fprintf(stderr, "Usage : %s [--benchmark_filter=texte] [--benchmark_min_time=secondes]\n"
+                            "        [--benchmark_format=console|json|csv] [--benchmark_out=fichier]\n"
+                            "        [--benchmark_out_format=console|json|csv]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (bench.format == FORMAT_CONSOLE) writeConsoleHeader(stdout);
+
+    char family[64];
+    Automaton A, det, comp;
+
+    // (a|b)*a(a|b)^n: the subset construction's exponential worst case
+    for (int n = 8; n <= 16; n += 2) {
+        if (!generateBlowup(&A, n)) return EXIT_FAILURE;
+        snprintf(family, sizeof(family), "blowup/%d", n);
+        benchTransform("determinize", family, &A, determinize);
+        if (n == 16) benchBinary(family, &A);
+
+        if (n == 12 && determinize(&A, &det, NULL)) {
+            benchDFATransforms(family, &det, 0);
+            if (complete(&det, &comp, NULL)) {
+                benchRecognize(family, &comp, 200000, 32);
+                benchParallel(family, &comp, (size_t)128 << 20);
+                freeAutomaton(&comp);
+            }
+            benchSimulate(family, &A, &det, 200000, 32);
+            benchLazy(family, &A, LAZY_DEFAULT_MEMORY, 200000, 32, 0);
+            freeAutomaton(&det);
+        }
+        freeAutomaton(&A);
+    }
+
+    // Far beyond determinization (2^41 DFA states): only simulation is possible
+    if (!generateBlowup(&A, 40)) return EXIT_FAILURE;
+    benchSimulate("blowup/40", &A, NULL, 200000, 64);
+    benchLazy("blowup/40", &A, LAZY_DEFAULT_MEMORY, 200000, 64, 0);
+    freeAutomaton(&A);
+
+    // 2^21 DFA states; a recurring vocabulary of words only reaches a few of them
+    if (!generateBlowup(&A, 20)) return EXIT_FAILURE;
+    benchLazy("blowup/20/vocabulary:1000", &A, LAZY_DEFAULT_MEMORY, 200000, 64, 1000);
+    benchLazy("blowup/20/vocabulary:1000", &A, (size_t)2 << 20, 200000, 64, 1000);
+    freeAutomaton(&A);
+
+    // Random NFAs: every cell has `degree` destinations
+    const int nfa_sizes[] = { 40, 80, 160 };
+    for (int i = 0; i < 3; i++) {
+        if (!randomAutomaton(&A, nfa_sizes[i], 2, 100, 2, 25, 42u + i)) return EXIT_FAILURE;
+        snprintf(family, sizeof(family), "randomNFA/%d/k:2/degree:2", nfa_sizes[i]);
+        benchTransform("determinize", family, &A, determinize);
+        if (determinize(&A, &det, NULL)) {
+            benchMinimize(family, &det, 2000);
+            freeAutomaton(&det);
+        }
+        freeAutomaton(&A);
+    }
+
+    // Random NFAs with epsilon transitions: closures are folded into the
+    // successor sets, and simulation must agree with the determinized DFA
+    const int eps_sizes[] = { 40, 160 };
+    for (int i = 0; i < 2; i++) {
+        GenParams P;
+        genDefaultParams(&P, eps_sizes[i], 2, 11u + i);
+        P.degree = 2;
+        P.epsilon_percent = 50;
+        if (!generateRandom(&A, &P)) return EXIT_FAILURE;
+        snprintf(family, sizeof(family), "randomNFA/%d/k:2/epsilon:50", eps_sizes[i]);
+        benchTransform("determinize", family, &A, determinize);
+        if (determinize(&A, &det, NULL)) {
+            // Most states stay active: fewer words for the simulation
+            benchSimulate(family, &A, &det, 20000, 32);
+            benchLazy(family, &A, LAZY_DEFAULT_MEMORY, 200000, 32, 0);
+            freeAutomaton(&det);
+        }
+        freeAutomaton(&A);
+    }
+
+    // Random partial DFAs: few distinct finals and a small alphabet leave
+    // many equivalent states
+    const int dfa_sizes[] = { 100, 500, 2000, 50000 };
+    for (int i = 0; i < 4; i++) {
+        for (int density = 70; density <= 100; density += 30) {
+            if (!randomAutomaton(&A, dfa_sizes[i], 2, density, 1, 33, 7u + i)) return EXIT_FAILURE;
+            snprintf(family, sizeof(family), "randomDFA/%d/density:%d", dfa_sizes[i], density);
+            benchDFATransforms(family, &A, 2000);
+            freeAutomaton(&A);
+        }
+    }
+
+    // Product constructions: two large random DFAs, then several small ones
+    // combined in one n-ary pass against the pairwise fold
+    Automaton inputs[4];
+    const Automaton *views[4];
+    for (int i = 0; i < 2; i++) {
+        if (!randomAutomaton(&inputs[i], 300, 2, 100, 1, 33, 21u + i)) return EXIT_FAILURE;
+        views[i] = &inputs[i];
+    }
+    for (int op = PRODUCT_INTERSECTION; op <= PRODUCT_SYMMETRIC_DIFFERENCE; op++) {
+        benchProduct("randomDFA/300x2", views, 2, (ProductOp)op);
+    }
+    for (int i = 0; i < 2; i++) freeAutomaton(&inputs[i]);
+    for (int i = 0; i < 4; i++) {
+        if (!randomAutomaton(&inputs[i], 12, 2, 90, 1, 33, 31u + i)) return EXIT_FAILURE;
+        views[i] = &inputs[i];
+    }
+    for (int op = PRODUCT_INTERSECTION; op <= PRODUCT_SYMMETRIC_DIFFERENCE; op++) {
+        benchProduct("randomDFA/12x4", views, 4, (ProductOp)op);
+    }
+    for (int i = 0; i < 4; i++) freeAutomaton(&inputs[i]);
+
+    // Language checks: Hopcroft-Karp on DFAs against their minimal form,
+    // antichains on NFAs against their DFA (no determinization of the NFA side)
+    if (!randomAutomaton(&A, 50000, 2, 100, 1, 33, 3u)) return EXIT_FAILURE;
+    if (minimize(&A, &det, NULL)) {
+        benchCheck("randomDFA/50000/minimal", &A, &det, false, true);
+        det.num_finals = 0;
+        benchCheck("randomDFA/50000/empty", &A, &det, false, false);
+        freeAutomaton(&det);
+    }
+    freeAutomaton(&A);
+    if (!generateBlowup(&A, 12) || !generateBlowup(&comp, 13)) return EXIT_FAILURE;
+    if (determinize(&A, &det, NULL)) {
+        benchCheck("blowup/12/dfa", &A, &det, false, true);
+        benchCheck("blowup/12/dfa", &A, &det, true, true);
+        freeAutomaton(&det);
+    }
+    benchCheck("blowup/12/blowup/13", &A, &comp, false, false);
+    freeAutomaton(&comp);
+    freeAutomaton(&A);
+
+    // Minimization modes: Brzozowski where the reverse determinizes small
+    // (blowup) and on random NFAs, then the incremental minimizer
+    if (!generateBlowup(&A, 16)) return EXIT_FAILURE;
+    benchBrzozowski("blowup/16", &A);
+    freeAutomaton(&A);
+    if (!randomAutomaton(&A, 60, 2, 60, 2, 33, 5u)) return EXIT_FAILURE;
+    benchBrzozowski("randomNFA/60/degree:2", &A);
+    freeAutomaton(&A);
+    benchDictionary(20000, 12, 4, 500);
+    benchIncrementalDifferential(300);
+
+    // Regular expressions against hand-written automata of the same language
+    benchRegexFamilies();
+
+    if (!randomAutomaton(&A, 50000, 2, 100, 1, 33, 3u)) return EXIT_FAILURE;
+    benchLogging("randomDFA/50000", &A);
+    freeAutomaton(&A);
+
+    benchLoad("1M_transitions", 200000, 4, 1000000, true);
+    benchLoad("5M_transitions", 1000000, 4, 5000000, false);
+    benchDifferential(500);
+
+    if (bench.format != FORMAT_CONSOLE) writeReport(stdout, bench.format, argv[0]);
+    if (bench.out_path) {
+        FILE *out = fopen(bench.out_path, "w");
+        if (out) {
+            writeReport(out, bench.out_format, argv[0]);
+            fclose(out);
+        } else {
+            fprintf(stderr, "Erreur : Impossible d'ecrire %s\n", bench.out_path);
+            bench.failed = true;
+        }
+    }
+    free(bench.records);
+    return bench.failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
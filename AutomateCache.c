@@ -0,0 +1,217 @@
+#include "AutomateCache.h"
+#include "AutomateIO.h"
+#include "AutomateSet.h"
+#include <string.h>
+#include <dirent.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define makeDirectory(path) _mkdir(path)
+#define processId() _getpid()
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#define makeDirectory(path) mkdir(path, 0755)
+#define processId() getpid()
+#endif
+
+#ifdef AUTOMATE_HAVE_THREADS
+#include <stdatomic.h>
+static atomic_uint temp_counter;
+#else
+static unsigned temp_counter;
+#endif
+
+// Bump when a transformation changes its output (state numbering included):
+// older entries then simply stop matching.
+#define CACHE_KEY_VERSION 4   // 2: alphabet in the key, 3: epsilon transitions, 4: minimize drops unreachable states
+#define CACHE_SECOND_SALT 0x5bd1e995u
+
+void cacheInit(TransformCache *C, CacheMode mode) {
+    memset(C, 0, sizeof(TransformCache));
+    C->mode = mode;
+}
+
+void cacheAddStats(TransformCache *C, const TransformCache *other) {
+    C->hits += other->hits;
+    C->misses += other->misses;
+    C->stores += other->stores;
+    C->stale += other->stale;
+}
+
+// --- Keys ---
+
+// Appends the sorted, de-duplicated states to out; returns the new end.
+static uint32_t *appendStateSet(uint32_t *out, const int *states, int count, int *scratch) {
+    memcpy(scratch, states, count * sizeof(int));
+    sortStates(scratch, count);
+    uint32_t *size = out++;
+    *size = 0;
+    for (int i = 0; i < count; i++) {
+        if (i > 0 && scratch[i] == scratch[i - 1]) continue;
+        *out++ = (uint32_t)scratch[i];
+        (*size)++;
+    }
+    return out;
+}
+
+bool cacheKeyOf(const Automaton *A, const char *pipeline, CacheKey *key) {
+    size_t cells = (size_t)A->num_states * A->num_symbols;
+    size_t m = 0;
+    int widest = A->num_initials > A->num_finals ? A->num_initials : A->num_finals;
+    for (size_t c = 0; c < cells; c++) {
+        int count = cellCount(A, (int)c);
+        m += count;
+        if (count > widest) widest = count;
+    }
+    size_t eps_m = 0;
+    for (int s = 0; hasEpsilon(A) && s < A->num_states; s++) {
+        int count;
+        epsilonTransitions(A, s, &count);
+        eps_m += count;
+        if (count > widest) widest = count;
+    }
+
+    // [salt, version, pipeline hash, sizes, alphabet, initials, finals, cells,
+    //  epsilon count, epsilon sets]
+    size_t letter_words = ((size_t)A->num_symbols + 3) / 4;
+    size_t eps_words = 1 + (eps_m > 0 ? (size_t)A->num_states + eps_m : 0);
+    size_t words = 8 + letter_words + (size_t)A->num_initials + A->num_finals + cells + m + eps_words;
+    uint32_t *buffer = malloc(words * sizeof(uint32_t));
+    int *scratch = malloc((widest > 0 ? widest : 1) * sizeof(int));
+    if (!buffer || !scratch) {
+        free(buffer);
+        free(scratch);
+        return false;
+    }
+
+    uint64_t pipeline_hash = hashBytes(pipeline, strlen(pipeline));
+    uint32_t *p = buffer + 1;
+    *p++ = CACHE_KEY_VERSION;
+    *p++ = (uint32_t)pipeline_hash;
+    *p++ = (uint32_t)(pipeline_hash >> 32);
+    *p++ = (uint32_t)A->num_symbols;
+    *p++ = (uint32_t)A->num_states;
+    memset(p, 0, letter_words * sizeof(uint32_t));
+    memcpy(p, A->alphabet.letters, A->num_symbols);
+    p += letter_words;
+    p = appendStateSet(p, A->initials, A->num_initials, scratch);
+    p = appendStateSet(p, A->finals, A->num_finals, scratch);
+    for (size_t c = 0; c < cells; c++) {
+        int count;
+        const int *dests = cellTransitions(A, (int)c, &count);
+        p = appendStateSet(p, dests, count, scratch);
+    }
+    *p++ = (uint32_t)eps_m;
+    for (int s = 0; eps_m > 0 && s < A->num_states; s++) {
+        int count;
+        const int *dests = epsilonTransitions(A, s, &count);
+        p = appendStateSet(p, dests, count, scratch);
+    }
+
+    size_t size = (size_t)(p - buffer) * sizeof(uint32_t);
+    buffer[0] = 0;
+    key->hi = hashBytes(buffer, size);
+    buffer[0] = CACHE_SECOND_SALT;
+    key->lo = hashBytes(buffer, size);
+    free(scratch);
+    free(buffer);
+    return true;
+}
+
+// --- Entries ---
+
+bool cacheFolder(const char *automata_folder, char *buffer, size_t size) {
+    int length = strcmp(automata_folder, ".") == 0 ? snprintf(buffer, size, "Automates-cache")
+                                                   : snprintf(buffer, size, "%s-cache", automata_folder);
+    return length >= 0 && (size_t)length < size;
+}
+
+// Cache folder of the folder holding input_path
+static bool cacheFolderFor(const char *input_path, char *buffer, size_t size) {
+    const char *slash = strrchr(input_path, '/');
+    const char *backslash = strrchr(input_path, '\\');
+    if (backslash && (!slash || backslash > slash)) slash = backslash;
+    char folder[512];
+    if (slash && (size_t)(slash - input_path) >= sizeof(folder)) return false;
+    if (slash) snprintf(folder, sizeof(folder), "%.*s", (int)(slash - input_path), input_path);
+    else snprintf(folder, sizeof(folder), ".");
+    return cacheFolder(folder, buffer, size);
+}
+
+// False when a path does not fit: the entry is then neither read nor written
+static bool entryPath(const char *input_path, const CacheKey *key, const char *extension, char *buffer, size_t size) {
+    char dir[512];
+    if (!cacheFolderFor(input_path, dir, sizeof(dir))) return false;
+    int length = snprintf(buffer, size, "%s/%016llx%016llx.%s", dir, (unsigned long long)key->hi,
+                          (unsigned long long)key->lo, extension);
+    return length >= 0 && (size_t)length < size;
+}
+
+bool cacheLookup(TransformCache *C, const char *input_path, const CacheKey *key, Automaton *out, FILE *logFile) {
+    if (C->mode == CACHE_BYPASS) return false;
+    char path[640];
+    if (!entryPath(input_path, key, "aut", path, sizeof(path))) return false;
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        C->misses++;
+        return false;
+    }
+    fclose(file);
+    if (!loadAutomatonBinary(path, out, logFile)) {
+        logMessage(logFile, "Cache : entree illisible supprimee (%s).\n", path);
+        remove(path);
+        C->misses++;
+        return false;
+    }
+    C->hits++;
+    return true;
+}
+
+bool cacheStore(TransformCache *C, const char *input_path, const CacheKey *key, const Automaton *A, FILE *logFile) {
+    if (C->mode == CACHE_BYPASS) return false;
+    char dir[512], path[640], temp[640];
+    if (!cacheFolderFor(input_path, dir, sizeof(dir))) return false;
+    makeDirectory(dir); // Fails harmlessly when it already exists
+    if (!entryPath(input_path, key, "aut", path, sizeof(path))) return false;
+    // Unique per writer: parallel workers (or processes) may store the same
+    // content at once, each through its own temporary file
+    char extension[64];
+    snprintf(extension, sizeof(extension), "%ld.%u.tmp", (long)processId(), (unsigned)temp_counter++);
+    if (!entryPath(input_path, key, extension, temp, sizeof(temp))) return false;
+
+    // Write then rename, so an interrupted run never leaves a partial entry
+    if (!saveAutomatonBinary(A, temp, logFile)) {
+        remove(temp);
+        return false;
+    }
+    remove(path);
+    if (rename(temp, path) != 0) {
+        remove(temp);
+        return false;
+    }
+    C->stores++;
+    return true;
+}
+
+int cacheEvictAll(const char *cache_dir, FILE *logFile) {
+    int removed = 0;
+    DIR *d = opendir(cache_dir);
+    if (!d) {
+        logMessage(logFile, "Cache : aucun dossier %s.\n", cache_dir);
+        return 0;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        const char *dot = strrchr(entry->d_name, '.');
+        if (!dot || (strcmp(dot, ".aut") != 0 && strcmp(dot, ".tmp") != 0)) continue;
+        char path[768];
+        snprintf(path, sizeof(path), "%s/%s", cache_dir, entry->d_name);
+        if (remove(path) == 0) removed++;
+    }
+    closedir(d);
+    logMessage(logFile, "Cache : %d entree(s) supprimee(s) dans %s.\n", removed, cache_dir);
+    return removed;
+}
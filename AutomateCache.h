@@ -0,0 +1,49 @@
+#ifndef AUTOMATE_CACHE_H
+#define AUTOMATE_CACHE_H
+
+#include "AutomateCore.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// --- Transformation Cache ---
+// Content-addressed store of transformation results. The key hashes the
+// normalized input automaton (sorted, de-duplicated initial/final states and
+// CSR transitions) together with a pipeline name, so renaming or touching a
+// file does not invalidate it but any change to its content does. Entries
+// are checksummed binary automata in "<automata folder>-cache/<key>.aut";
+// an unreadable entry counts as a miss and is removed.
+
+typedef enum {
+    CACHE_USE,      // Load stored results, store new ones
+    CACHE_CHECK,    // Recompute even on a hit and compare with the stored result
+    CACHE_BYPASS    // Neither read nor write the cache
+} CacheMode;
+
+typedef struct {
+    uint64_t hi;
+    uint64_t lo;
+} CacheKey;
+
+typedef struct {
+    CacheMode mode;
+    int hits;
+    int misses;
+    int stores;
+    int stale;      // Check mode: stored results that differed from the recomputed ones
+} TransformCache;
+
+void cacheInit(TransformCache *C, CacheMode mode);
+// Adds the counters of other (a worker's private copy) to C
+void cacheAddStats(TransformCache *C, const TransformCache *other);
+// False only when out of memory (the cache is then skipped)
+bool cacheKeyOf(const Automaton *A, const char *pipeline, CacheKey *key);
+// Cache folder of an automata folder: "./Automates" -> "./Automates-cache".
+// False when it does not fit in buffer (the cache is then skipped)
+bool cacheFolder(const char *automata_folder, char *buffer, size_t size);
+
+bool cacheLookup(TransformCache *C, const char *input_path, const CacheKey *key, Automaton *out, FILE *logFile);
+bool cacheStore(TransformCache *C, const char *input_path, const CacheKey *key, const Automaton *A, FILE *logFile);
+// Removes every entry of a cache folder, returns how many
+int cacheEvictAll(const char *cache_dir, FILE *logFile);
+
+#endif // AUTOMATE_CACHE_H
@@ -1,4 +1,6 @@
 #include "AutomateCore.h"
+#include "AutomateSet.h"
+#include "AutomateStats.h"
 #include <string.h>
 
 #define DEFAULT_CAPACITY 2
@@ -25,10 +27,54 @@ void addUnique(int **array, int *size, int value) {
     }
 }
 
+// --- Alphabet ---
+
+void alphabetDefault(Alphabet *L, int num_symbols) {
+    for (int b = 0; b < ALPHABET_MAX; b++) L->symbols[b] = -1;
+    for (int i = 0; i < num_symbols; i++) {
+        L->letters[i] = (unsigned char)('a' + i);
+        L->symbols[L->letters[i]] = (int16_t)i;
+    }
+}
+
+bool alphabetSet(Alphabet *L, const unsigned char *letters, int num_symbols) {
+    Alphabet result;
+    for (int b = 0; b < ALPHABET_MAX; b++) result.symbols[b] = -1;
+    for (int i = 0; i < num_symbols; i++) {
+        if (result.symbols[letters[i]] != -1) return false;
+        result.letters[i] = letters[i];
+        result.symbols[letters[i]] = (int16_t)i;
+    }
+    *L = result;
+    return true;
+}
+
+bool alphabetIsDefault(const Alphabet *L, int num_symbols) {
+    for (int i = 0; i < num_symbols; i++) {
+        if (L->letters[i] != (unsigned char)('a' + i)) return false;
+    }
+    return true;
+}
+
+int mergeAlphabets(const Automaton *const *inputs, int count, Alphabet *merged) {
+    int k = 0;
+    for (int b = 0; b < ALPHABET_MAX; b++) merged->symbols[b] = -1;
+    for (int i = 0; i < count; i++) {
+        for (int s = 0; s < inputs[i]->num_symbols; s++) {
+            unsigned char byte = inputs[i]->alphabet.letters[s];
+            if (merged->symbols[byte] < 0) {
+                merged->symbols[byte] = (int16_t)k;
+                merged->letters[k++] = byte;
+            }
+        }
+    }
+    return k;
+}
+
 // --- Memory Management ---
 
 bool createAutomaton(Automaton *A, int num_states, int num_symbols) {
-    if (!A || num_states <= 0 || num_symbols <= 0) return false;
+    if (!A || num_states <= 0 || num_symbols <= 0 || num_symbols > ALPHABET_MAX) return false;
 
     A->num_states = num_states;
     A->num_symbols = num_symbols;
@@ -37,28 +83,37 @@ bool createAutomaton(Automaton *A, int num_states, int num_symbols) {
     A->num_finals = 0;
     A->finals = NULL;
 
-    int total_cells = num_states * num_symbols;
-    A->transitions = malloc(total_cells * sizeof(TransitionList));
-    
-    if (!A->transitions) {
-        perror("Error: Memory allocation for automaton transitions failed");
-        return false;
-    }
+    // No per-cell storage until the first transition: builders freeze straight to CSR
+    A->transitions = NULL;
+    A->offsets = NULL;
+    A->targets = NULL;
+    A->eps_offsets = NULL;
+    A->eps_targets = NULL;
+    A->closure_of = NULL;
+    A->closure_offsets = NULL;
+    A->closure_states = NULL;
+    A->arena.head = NULL;
+    alphabetDefault(&A->alphabet, num_symbols);
+    return true;
+}
 
-    for (int i = 0; i < total_cells; i++) {
-        A->transitions[i].count = 0;
-        A->transitions[i].capacity = 0;
-        A->transitions[i].destinations = NULL;
+bool createAutomatonInArena(Automaton *A, int num_states, int num_symbols) {
+    if (!createAutomaton(A, num_states, num_symbols)) return false;
+    // Room for the CSR offsets plus a couple of transitions per cell
+    size_t cells = (size_t)num_states * num_symbols;
+    if (!arenaInit(&A->arena, (cells * 3 + num_states * 2) * sizeof(int))) {
+        perror("Error: Arena allocation for automaton failed");
+        return false;
     }
     return true;
 }
 
-void freeAutomaton(Automaton *A) {
-    if (!A) return;
+void *automatonAlloc(Automaton *A, size_t size) {
+    if (arenaInUse(&A->arena)) return arenaAlloc(&A->arena, size);
+    return malloc(size > 0 ? size : 1);
+}
 
-    if (A->initials) { free(A->initials); A->initials = NULL; }
-    if (A->finals) { free(A->finals); A->finals = NULL; }
-    
+static void freeTransitions(Automaton *A) {
     if (A->transitions) {
         int total_cells = A->num_states * A->num_symbols;
         for (int i = 0; i < total_cells; i++) {
@@ -69,12 +124,72 @@ void freeAutomaton(Automaton *A) {
         free(A->transitions);
         A->transitions = NULL;
     }
+    if (!arenaInUse(&A->arena)) {
+        if (A->offsets) free(A->offsets);
+        if (A->targets) free(A->targets);
+    }
+    A->offsets = NULL;
+    A->targets = NULL;
+}
+
+static void freeEpsilon(Automaton *A) {
+    if (!arenaInUse(&A->arena)) {
+        free(A->eps_offsets);
+        free(A->eps_targets);
+        free(A->closure_of);
+        free(A->closure_offsets);
+        free(A->closure_states);
+    }
+    A->eps_offsets = A->eps_targets = NULL;
+    A->closure_of = A->closure_offsets = A->closure_states = NULL;
+}
+
+void freeAutomaton(Automaton *A) {
+    if (!A) return;
+
+    freeTransitions(A);
+    freeEpsilon(A);
+    if (arenaInUse(&A->arena)) {
+        arenaRelease(&A->arena);
+        A->initials = NULL;
+        A->finals = NULL;
+    }
+    if (A->initials) { free(A->initials); A->initials = NULL; }
+    if (A->finals) { free(A->finals); A->finals = NULL; }
     A->num_states = 0;
     A->num_symbols = 0;
 }
 
+// Switches A to the editable TransitionList layout (copying CSR cells if frozen)
+static bool thawAutomaton(Automaton *A) {
+    int total_cells = A->num_states * A->num_symbols;
+    TransitionList *lists = calloc(total_cells, sizeof(TransitionList));
+    if (!lists) {
+        perror("Error: Memory allocation for automaton transitions failed");
+        return false;
+    }
+    if (A->offsets) {
+        for (int c = 0; c < total_cells; c++) {
+            int count = A->offsets[c + 1] - A->offsets[c];
+            if (count == 0) continue;
+            lists[c].destinations = malloc(count * sizeof(int));
+            if (!lists[c].destinations) {
+                for (int j = 0; j < c; j++) free(lists[j].destinations);
+                free(lists);
+                return false;
+            }
+            memcpy(lists[c].destinations, A->targets + A->offsets[c], count * sizeof(int));
+            lists[c].count = lists[c].capacity = count;
+        }
+        freeTransitions(A);
+    }
+    A->transitions = lists;
+    return true;
+}
+
 bool addTransition(Automaton *A, int from, int symbol_idx, int to) {
     if (!A || from < 0 || from >= A->num_states || symbol_idx < 0 || symbol_idx >= A->num_symbols) return false;
+    if (!A->transitions && !thawAutomaton(A)) return false;
 
     int index = from * A->num_symbols + symbol_idx;
     TransitionList *list = &A->transitions[index];
@@ -90,5 +205,351 @@ bool addTransition(Automaton *A, int from, int symbol_idx, int to) {
         list->capacity = new_cap;
     }
     list->destinations[list->count++] = to;
+    STATS_COUNT(COUNT_TRANSITIONS, 1);
+    return true;
+}
+
+size_t automatonFootprint(const Automaton *A) {
+    size_t cells = (size_t)A->num_states * A->num_symbols;
+    size_t bytes = sizeof(Automaton) + (A->num_initials + A->num_finals) * sizeof(int);
+    if (A->offsets) {
+        bytes += (cells + 1) * sizeof(int) + (size_t)A->offsets[cells] * sizeof(int);
+    } else if (A->transitions) {
+        bytes += cells * sizeof(TransitionList);
+        for (size_t c = 0; c < cells; c++) bytes += A->transitions[c].capacity * sizeof(int);
+    }
+    if (A->eps_offsets) {
+        int n = A->num_states, closures = 0;
+        for (int s = 0; s < n; s++) if (A->closure_of[s] >= closures) closures = A->closure_of[s] + 1;
+        bytes += (size_t)(n + 1 + A->eps_offsets[n]) * sizeof(int) +
+                 (size_t)(n + closures + 1 + A->closure_offsets[closures]) * sizeof(int);
+    }
+    return bytes;
+}
+
+bool sameAutomaton(const Automaton *X, const Automaton *Y) {
+    if (X->num_states != Y->num_states || X->num_symbols != Y->num_symbols) return false;
+    if (X->num_initials != Y->num_initials || X->num_finals != Y->num_finals) return false;
+    if (memcmp(X->alphabet.letters, Y->alphabet.letters, X->num_symbols) != 0) return false;
+    for (int i = 0; i < X->num_initials; i++) if (X->initials[i] != Y->initials[i]) return false;
+    for (int i = 0; i < X->num_finals; i++) if (X->finals[i] != Y->finals[i]) return false;
+    for (int c = 0; c < X->num_states * X->num_symbols; c++) {
+        int count_x, count_y;
+        const int *x = cellTransitions(X, c, &count_x), *y = cellTransitions(Y, c, &count_y);
+        if (count_x != count_y) return false;
+        for (int t = 0; t < count_x; t++) if (x[t] != y[t]) return false;
+    }
+    if (hasEpsilon(X) != hasEpsilon(Y)) return false;
+    for (int s = 0; hasEpsilon(X) && s < X->num_states; s++) {
+        int count_x, count_y;
+        const int *x = epsilonTransitions(X, s, &count_x), *y = epsilonTransitions(Y, s, &count_y);
+        if (count_x != count_y || memcmp(x, y, count_x * sizeof(int)) != 0) return false;
+    }
+    return true;
+}
+
+// --- Epsilon Closures ---
+// Tarjan's algorithm on the epsilon graph (iterative, so long chains cannot
+// overflow the stack) completes each strongly connected component after every
+// component it reaches. A component's closure is then its members plus the
+// closures of the components its edges lead to, all already built: one sorted
+// list per component, shared by its states.
+
+static bool reserveStates(int **states, int *capacity, int needed) {
+    if (needed <= *capacity) return true;
+    int new_cap = *capacity;
+    while (new_cap < needed) new_cap *= 2;
+    int *grown = realloc(*states, new_cap * sizeof(int));
+    if (!grown) return false;
+    *states = grown;
+    *capacity = new_cap;
+    return true;
+}
+
+static bool computeClosures(Automaton *A) {
+    int n = A->num_states;
+    const int *offsets = A->eps_offsets, *targets = A->eps_targets;
+    bool ok = false;
+    Arena scratch;
+    if (!arenaInit(&scratch, (size_t)n * 6 * sizeof(int))) return false;
+    int *index = arenaAlloc(&scratch, n * sizeof(int));
+    int *low = arenaAlloc(&scratch, n * sizeof(int));
+    int *stack = arenaAlloc(&scratch, n * sizeof(int));     // Tarjan's stack
+    int *frames = arenaAlloc(&scratch, n * sizeof(int));    // DFS path
+    int *edge = arenaAlloc(&scratch, n * sizeof(int));      // Next edge to visit per state
+    int *mark = arenaAlloc(&scratch, n * sizeof(int));      // Last closure a state was added to
+    int capacity = 2 * n, size = 0;
+    int *states = malloc(capacity * sizeof(int));
+    A->closure_of = automatonAlloc(A, n * sizeof(int));
+    A->closure_offsets = automatonAlloc(A, (n + 1) * sizeof(int));
+    if (!index || !low || !stack || !frames || !edge || !mark || !states || !A->closure_of || !A->closure_offsets)
+        goto cleanup;
+    for (int s = 0; s < n; s++) index[s] = mark[s] = -1;
+
+    int counter = 0, sp = 0, num_closures = 0;
+    A->closure_offsets[0] = 0;
+    for (int root = 0; root < n; root++) {
+        if (index[root] >= 0) continue;
+        int fp = 0;
+        index[root] = low[root] = counter++;
+        stack[sp++] = root;
+        edge[root] = offsets[root];
+        frames[fp++] = root;
+        while (fp > 0) {
+            int v = frames[fp - 1];
+            if (edge[v] < offsets[v + 1]) {
+                int w = targets[edge[v]++];
+                if (index[w] < 0) {
+                    index[w] = low[w] = counter++;
+                    stack[sp++] = w;
+                    edge[w] = offsets[w];
+                    frames[fp++] = w;
+                } else if (index[w] < n && low[v] > index[w]) {
+                    low[v] = index[w];      // w still on the stack
+                }
+                continue;
+            }
+            if (--fp > 0 && low[frames[fp - 1]] > low[v]) low[frames[fp - 1]] = low[v];
+            if (low[v] != index[v]) continue;
+
+            // v roots a component: pop it and build its closure
+            int c = num_closures++, top = sp, begin = size;
+            do {
+                int w = stack[--sp];
+                A->closure_of[w] = c;
+                index[w] = n;               // Done: no longer on the stack
+            } while (stack[sp] != v);
+            if (!reserveStates(&states, &capacity, size + (top - sp))) goto cleanup;
+            for (int i = sp; i < top; i++) {
+                mark[stack[i]] = c;
+                states[size++] = stack[i];
+            }
+            for (int i = sp; i < top; i++) {
+                int x = stack[i];
+                for (int e = offsets[x]; e < offsets[x + 1]; e++) {
+                    int d = A->closure_of[targets[e]];
+                    if (d == c) continue;
+                    int from = A->closure_offsets[d], count = A->closure_offsets[d + 1] - from;
+                    if (!reserveStates(&states, &capacity, size + count)) goto cleanup;
+                    for (int t = 0; t < count; t++) {
+                        int z = states[from + t];
+                        if (mark[z] == c) continue;
+                        mark[z] = c;
+                        states[size++] = z;
+                    }
+                }
+            }
+            sortStates(states + begin, size - begin);
+            A->closure_offsets[c + 1] = size;
+        }
+    }
+
+    A->closure_states = automatonAlloc(A, (size > 0 ? size : 1) * sizeof(int));
+    if (!A->closure_states) goto cleanup;
+    memcpy(A->closure_states, states, size * sizeof(int));
+    ok = true;
+
+cleanup:
+    free(states);
+    arenaRelease(&scratch);
+    return ok;
+}
+
+bool setEpsilonTransitions(Automaton *A, const int *offsets, const int *targets) {
+    freeEpsilon(A);
+    if (!offsets || offsets[A->num_states] == 0) return true;
+    int n = A->num_states, m = offsets[n];
+    A->eps_offsets = automatonAlloc(A, (n + 1) * sizeof(int));
+    A->eps_targets = automatonAlloc(A, (m > 0 ? m : 1) * sizeof(int));
+    bool ok = A->eps_offsets && A->eps_targets;
+    if (ok) {
+        memcpy(A->eps_offsets, offsets, (n + 1) * sizeof(int));
+        memcpy(A->eps_targets, targets, m * sizeof(int));
+        STATS_START(timer);
+        ok = computeClosures(A);
+        STATS_END(PHASE_EPSILON_CLOSURE, timer);
+    }
+    if (!ok) freeEpsilon(A);
+    return ok;
+}
+
+// --- Builder (CSR freezing) ---
+
+bool builderInit(AutomatonBuilder *B, int num_states, int num_symbols, int expected) {
+    memset(B, 0, sizeof(AutomatonBuilder));
+    B->num_states = num_states;
+    B->num_symbols = num_symbols;
+    B->capacity = expected > 16 ? expected : 16;
+    B->cells = malloc(B->capacity * sizeof(int));
+    B->dests = malloc(B->capacity * sizeof(int));
+    if (!B->cells || !B->dests) {
+        builderFree(B);
+        return false;
+    }
+    return true;
+}
+
+void builderFree(AutomatonBuilder *B) {
+    if (!B) return;
+    free(B->cells);
+    free(B->dests);
+    free(B->eps_from);
+    free(B->eps_to);
+    B->cells = NULL;
+    B->dests = NULL;
+    B->eps_from = NULL;
+    B->eps_to = NULL;
+    B->count = B->eps_count = 0;
+    B->capacity = B->eps_capacity = 0;
+}
+
+// Appends (key, dest) to a pair of parallel arrays grown by doubling
+static bool pushPair(int **keys, int **dests, int *count, int *capacity, int key, int dest) {
+    if (*count >= *capacity) {
+        int new_cap = *capacity > 0 ? *capacity * 2 : 16;
+        int *grown = realloc(*keys, new_cap * sizeof(int));
+        if (!grown) return false;
+        *keys = grown;
+        grown = realloc(*dests, new_cap * sizeof(int));
+        if (!grown) return false;
+        *dests = grown;
+        *capacity = new_cap;
+    }
+    (*keys)[*count] = key;
+    (*dests)[*count] = dest;
+    (*count)++;
     return true;
-}
\ No newline at end of file
+}
+
+bool builderAdd(AutomatonBuilder *B, int from, int symbol_idx, int to) {
+    if (from < 0 || from >= B->num_states || symbol_idx < 0 || symbol_idx >= B->num_symbols ||
+        to < 0 || to >= B->num_states) return false;
+    return pushPair(&B->cells, &B->dests, &B->count, &B->capacity, from * B->num_symbols + symbol_idx, to);
+}
+
+bool builderAddEpsilon(AutomatonBuilder *B, int from, int to) {
+    if (from < 0 || from >= B->num_states || to < 0 || to >= B->num_states) return false;
+    return pushPair(&B->eps_from, &B->eps_to, &B->eps_count, &B->eps_capacity, from, to);
+}
+
+// CSR arrays (allocated from A) of `count` (key, dest) pairs over num_keys
+// keys, each key's destinations sorted and deduplicated
+static bool freezePairs(Automaton *A, const int *keys, const int *dests, int count, int num_keys,
+                        int **offsets_out, int **targets_out) {
+    bool inArena = arenaInUse(&A->arena);
+    int *offsets = automatonAlloc(A, (num_keys + 1) * sizeof(int));
+    int *targets = automatonAlloc(A, (count > 0 ? count : 1) * sizeof(int));
+    if (!offsets || !targets) {
+        if (!inArena) { free(offsets); free(targets); }
+        return false;
+    }
+    memset(offsets, 0, (num_keys + 1) * sizeof(int));
+
+    // Counting sort by key: offsets[c] serves as the fill cursor, then is shifted back
+    for (int i = 0; i < count; i++) offsets[keys[i] + 1]++;
+    for (int c = 0; c < num_keys; c++) offsets[c + 1] += offsets[c];
+    for (int i = 0; i < count; i++) targets[offsets[keys[i]]++] = dests[i];
+    for (int c = num_keys; c > 0; c--) offsets[c] = offsets[c - 1];
+    offsets[0] = 0;
+
+    // Sort and deduplicate each key, compacting in place
+    int write = 0;
+    for (int c = 0; c < num_keys; c++) {
+        int begin = offsets[c], end = offsets[c + 1];
+        sortStates(targets + begin, end - begin);
+        offsets[c] = write;
+        for (int i = begin; i < end; i++) {
+            if (i == begin || targets[i] != targets[i - 1]) targets[write++] = targets[i];
+        }
+    }
+    offsets[num_keys] = write;
+    STATS_COUNT(COUNT_TRANSITIONS, write);
+
+    if (!inArena) {
+        int *shrunk = realloc(targets, (write > 0 ? write : 1) * sizeof(int));
+        if (shrunk) targets = shrunk;
+    }
+    *offsets_out = offsets;
+    *targets_out = targets;
+    return true;
+}
+
+bool builderFreeze(AutomatonBuilder *B, Automaton *A) {
+    int *offsets, *targets;
+    if (!freezePairs(A, B->cells, B->dests, B->count, B->num_states * B->num_symbols, &offsets, &targets))
+        return false;
+    freeTransitions(A);
+    A->offsets = offsets;
+    A->targets = targets;
+
+    freeEpsilon(A);
+    if (B->eps_count > 0) {
+        if (!freezePairs(A, B->eps_from, B->eps_to, B->eps_count, B->num_states, &A->eps_offsets, &A->eps_targets))
+            return false;
+        STATS_START(timer);
+        bool ok = computeClosures(A);
+        STATS_END(PHASE_EPSILON_CLOSURE, timer);
+        if (!ok) {
+            freeEpsilon(A);
+            return false;
+        }
+    }
+    builderFree(B);
+    return true;
+}
+
+// --- Byte Classes ---
+
+// Same destinations from every state; symbol -1 has none anywhere
+static bool sameColumns(const Automaton *A, int x, int y) {
+    int k = A->num_symbols;
+    for (int s = 0; s < A->num_states; s++) {
+        int count_x = 0, count_y = 0;
+        const int *dx = x >= 0 ? cellTransitions(A, s * k + x, &count_x) : NULL;
+        const int *dy = y >= 0 ? cellTransitions(A, s * k + y, &count_y) : NULL;
+        if (count_x != count_y || (count_x > 0 && memcmp(dx, dy, count_x * sizeof(int)) != 0)) return false;
+    }
+    return true;
+}
+
+int byteClasses(const Automaton *A, uint8_t classes[ALPHABET_MAX], int representatives[ALPHABET_MAX]) {
+    // Hash every symbol's column in one pass over the cells; index k stands
+    // for the bytes outside the alphabet (an empty column)
+    int k = A->num_symbols;
+    uint64_t hashes[ALPHABET_MAX + 1];
+    uint64_t empty = hashBytes(NULL, 0);
+    for (int sym = 0; sym <= k; sym++) hashes[sym] = 0;
+    for (int s = 0; s < A->num_states; s++) {
+        for (int sym = 0; sym < k; sym++) {
+            int count;
+            const int *dests = cellTransitions(A, s * k + sym, &count);
+            hashes[sym] = (hashes[sym] ^ hashBytes(dests, count * sizeof(int))) * 0x9e3779b97f4a7c15ULL;
+        }
+        hashes[k] = (hashes[k] ^ empty) * 0x9e3779b97f4a7c15ULL;
+    }
+
+    // Bytes in order: join the first class with the same column (hashes
+    // only pick candidates, columns are compared), or open a new one
+    uint64_t class_hashes[ALPHABET_MAX];
+    int num_classes = 0, outside_class = -1;
+    for (int b = 0; b < ALPHABET_MAX; b++) {
+        int sym = A->alphabet.symbols[b];
+        if (sym < 0 && outside_class >= 0) {
+            classes[b] = (uint8_t)outside_class;
+            continue;
+        }
+        uint64_t h = hashes[sym >= 0 ? sym : k];
+        int c = 0;
+        while (c < num_classes && (class_hashes[c] != h || !sameColumns(A, representatives[c], sym))) c++;
+        if (sym < 0) outside_class = c;
+        if (c == num_classes) {
+            class_hashes[c] = h;
+            representatives[c] = sym;
+            num_classes++;
+        } else if (representatives[c] < 0) {
+            representatives[c] = sym;
+        }
+        classes[b] = (uint8_t)c;
+    }
+    return num_classes;
+}
@@ -4,6 +4,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "AutomateArena.h"
+
+// --- Alphabet ---
+// Symbol i of an automaton stands for the byte letters[i]. The default
+// lettering is 'a' + i (mod 256): the usual a, b, c... for small alphabets,
+// and every byte once for a 256-symbol alphabet, so automata over raw bytes
+// need no declaration. Any other set of distinct bytes can be declared.
+
+#define ALPHABET_MAX 256
+
+typedef struct {
+    unsigned char letters[ALPHABET_MAX];    // Symbol -> byte
+    int16_t symbols[ALPHABET_MAX];          // Byte -> symbol, -1 outside the alphabet
+} Alphabet;
+
+void alphabetDefault(Alphabet *L, int num_symbols);
+// False when the letters are not distinct
+bool alphabetSet(Alphabet *L, const unsigned char *letters, int num_symbols);
+bool alphabetIsDefault(const Alphabet *L, int num_symbols);
 
 // --- Dynamic Structures ---
 
@@ -23,14 +43,138 @@ typedef struct {
     int num_finals;
     int *finals;        // Dynamic array of final states
 
-    // Flattened 1D transition table for efficiency
+    // Transitions of cell (state * num_symbols + symbol), in one of two layouts:
+    // - editable: one TransitionList per cell (allocated on first addTransition)
+    // - frozen (CSR): destinations of cell c are targets[offsets[c] .. offsets[c + 1]),
+    //   sorted and without duplicates, as produced by an AutomatonBuilder.
+    // Read them through cellTransitions(), which handles both.
     TransitionList *transitions;
+    int *offsets;
+    int *targets;
+
+    Alphabet alphabet;  // Default lettering unless set after creation
+
+    // Epsilon transitions, CSR by state: eps_targets[eps_offsets[s] .. eps_offsets[s + 1]),
+    // all NULL when the automaton has none. Their reflexive-transitive
+    // closures are computed once, when the transitions are set: the states of
+    // an epsilon cycle share one sorted list, closure_of[s] indexes it in
+    // closure_offsets. Read them through epsilonClosure().
+    int *eps_offsets;
+    int *eps_targets;
+    int *closure_of;
+    int *closure_offsets;
+    int *closure_states;
+
+    // When in use, owns initials, finals, offsets and targets: they are never
+    // freed or realloc'd one by one, freeAutomaton() drops the whole region.
+    // Editable TransitionLists always live on the heap.
+    Arena arena;
 } Automaton;
 
 // --- Memory Management ---
+// num_symbols is at most ALPHABET_MAX
 bool createAutomaton(Automaton *A, int num_states, int num_symbols);
+// Same, with initials/finals/CSR storage carved from an arena sized for the automaton
+bool createAutomatonInArena(Automaton *A, int num_states, int num_symbols);
 void freeAutomaton(Automaton *A);
+// Allocates storage owned by A (its arena if it has one, the heap otherwise)
+void *automatonAlloc(Automaton *A, size_t size);
+// Works on both layouts (a frozen automaton is converted back to lists first)
 bool addTransition(Automaton *A, int from, int symbol_idx, int to);
+size_t automatonFootprint(const Automaton *A);
+// Replaces the epsilon transitions of A with a copy of the given CSR (NULL
+// offsets or no transitions: none) and computes their closures
+bool setEpsilonTransitions(Automaton *A, const int *offsets, const int *targets);
+// Same sizes, initial and final lists, and per-cell destinations (in order),
+// epsilon transitions included
+bool sameAutomaton(const Automaton *X, const Automaton *Y);
+// Alphabet holding the bytes of every input, in order of first appearance;
+// returns its size
+int mergeAlphabets(const Automaton *const *inputs, int count, Alphabet *merged);
+
+// --- Transition Access ---
+
+static inline const int *cellTransitions(const Automaton *A, int cell, int *count) {
+    if (A->offsets) {
+        *count = A->offsets[cell + 1] - A->offsets[cell];
+        return A->targets + A->offsets[cell];
+    }
+    if (A->transitions) {
+        *count = A->transitions[cell].count;
+        return A->transitions[cell].destinations;
+    }
+    *count = 0;
+    return NULL;
+}
+
+static inline int cellCount(const Automaton *A, int cell) {
+    int count;
+    cellTransitions(A, cell, &count);
+    return count;
+}
+
+static inline bool hasEpsilon(const Automaton *A) {
+    return A->eps_offsets != NULL;
+}
+
+static inline const int *epsilonTransitions(const Automaton *A, int state, int *count) {
+    if (!A->eps_offsets) {
+        *count = 0;
+        return NULL;
+    }
+    *count = A->eps_offsets[state + 1] - A->eps_offsets[state];
+    return A->eps_targets + A->eps_offsets[state];
+}
+
+// States reachable from `state` through epsilon transitions, itself
+// included, sorted. Only for automata with epsilon transitions.
+static inline const int *epsilonClosure(const Automaton *A, int state, int *count) {
+    int c = A->closure_of[state];
+    *count = A->closure_offsets[c + 1] - A->closure_offsets[c];
+    return A->closure_states + A->closure_offsets[c];
+}
+
+// Symbol of a byte, -1 when the byte is not in the alphabet
+static inline int symbolOf(const Automaton *A, unsigned char byte) {
+    return A->alphabet.symbols[byte];
+}
+
+// --- Byte Classes ---
+// Bytes whose transitions are the same from every state (bytes outside the
+// alphabet have none) are interchangeable for matching. Tables indexed by
+// class instead of symbol stay narrow whatever the alphabet: a 256-byte
+// alphabet where only digits matter collapses to two or three columns.
+// Fills classes[byte] (numbered in order of first byte) and, per class, a
+// symbol standing for it, or -1 for a class of bytes outside the alphabet.
+// Returns the number of classes.
+int byteClasses(const Automaton *A, uint8_t classes[ALPHABET_MAX], int representatives[ALPHABET_MAX]);
+
+// --- Builder (CSR freezing) ---
+// Collects (from, symbol, to) triples in two flat arrays, then freezes them
+// into the CSR layout with a counting sort: two allocations for the whole
+// transition relation instead of one per cell. Epsilon transitions are
+// collected apart and frozen the same way.
+
+typedef struct {
+    int num_states;
+    int num_symbols;
+    int count;
+    int capacity;
+    int *cells;         // from * num_symbols + symbol
+    int *dests;
+    int eps_count;
+    int eps_capacity;
+    int *eps_from;
+    int *eps_to;
+} AutomatonBuilder;
+
+bool builderInit(AutomatonBuilder *B, int num_states, int num_symbols, int expected);
+void builderFree(AutomatonBuilder *B);
+bool builderAdd(AutomatonBuilder *B, int from, int symbol_idx, int to);
+bool builderAddEpsilon(AutomatonBuilder *B, int from, int to);
+// Replaces the transitions of A (created with the same sizes), epsilon ones
+// included, and empties B
+bool builderFreeze(AutomatonBuilder *B, Automaton *A);
 
 // --- Utilities ---
 bool arrayContains(const int *array, int size, int value);
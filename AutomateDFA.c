@@ -0,0 +1,100 @@
+#include "AutomateDFA.h"
+#include "AutomateAnalysis.h"
+#include "AutomateIO.h" // For logMessage and unmapFile
+#include "AutomateStats.h"
+#include <string.h>
+
+// --- Freezing ---
+
+bool freezeDFA(const Automaton *A, DenseDFA *D, FILE *logFile) {
+    memset(D, 0, sizeof(DenseDFA));
+    if (!isDeterministic(A, logFile)) {
+        logAt(LOG_ERROR, logFile, "Erreur : Impossible de figer un automate non-deterministe.\n");
+        return false;
+    }
+
+    STATS_START(timer);
+    int representatives[ALPHABET_MAX];
+    D->num_classes = byteClasses(A, D->classes, representatives);
+    memcpy(D->letters, A->alphabet.letters, sizeof(D->letters));
+
+    int C = D->num_classes;
+    size_t cells = (size_t)A->num_states * C;
+    D->num_states = A->num_states;
+    D->num_symbols = A->num_symbols;
+    D->initial = A->initials[0];
+    D->narrow = A->num_states < DFA_NO_STATE16;
+    D->accept = calloc((A->num_states + 63) / 64 + 1, sizeof(uint64_t));
+    if (D->narrow) D->table16 = malloc((cells > 0 ? cells : 1) * sizeof(uint16_t));
+    else D->table32 = malloc((cells > 0 ? cells : 1) * sizeof(int32_t));
+    if (!D->accept || (D->narrow ? !D->table16 : !D->table32)) {
+        freeDenseDFA(D);
+        return false;
+    }
+
+    for (size_t c = 0; c < cells; c++) {
+        int sym = representatives[c % C], count = 0;
+        const int *dests = sym >= 0 ? cellTransitions(A, (int)(c / C) * A->num_symbols + sym, &count) : NULL;
+        if (D->narrow) D->table16[c] = count > 0 ? (uint16_t)dests[0] : DFA_NO_STATE16;
+        else D->table32[c] = count > 0 ? dests[0] : -1;
+    }
+    for (int i = 0; i < A->num_finals; i++) {
+        int f = A->finals[i];
+        D->accept[f >> 6] |= (uint64_t)1 << (f & 63);
+    }
+    STATS_END(PHASE_FREEZE, timer);
+    return true;
+}
+
+void freeDenseDFA(DenseDFA *D) {
+    if (!D) return;
+    if (D->image) {
+        MappedFile F = { D->image, D->image_size, D->image_mapped };
+        unmapFile(&F);
+    } else {
+        free(D->table16);
+        free(D->table32);
+        free(D->accept);
+    }
+    memset(D, 0, sizeof(DenseDFA));
+}
+
+// --- Matching ---
+
+bool recognizeWordDFA(const DenseDFA *D, const char *word) {
+    if (D->initial < 0) return false;
+    const unsigned char *p = (const unsigned char *)word;
+    const uint8_t *classes = D->classes;
+    int C = D->num_classes;
+    int current = D->initial;
+
+    // One specialised loop per cell width; bytes outside the alphabet fall
+    // in a column without transitions, so there is no range check
+    if (D->narrow) {
+        const uint16_t *table = D->table16;
+        for (; *p; p++) {
+            uint16_t next = table[(size_t)current * C + classes[*p]];
+            if (next == DFA_NO_STATE16) return false;
+            current = next;
+        }
+    } else {
+        const int32_t *table = D->table32;
+        for (; *p; p++) {
+            current = table[(size_t)current * C + classes[*p]];
+            if (current < 0) return false;
+        }
+    }
+    return dfaIsAccepting(D, current);
+}
+
+// Every symbol of the alphabet has a transition (bytes outside it need not)
+bool isCompleteDFA(const DenseDFA *D) {
+    bool used[ALPHABET_MAX] = { false };
+    for (int sym = 0; sym < D->num_symbols; sym++) used[D->classes[D->letters[sym]]] = true;
+    for (int s = 0; s < D->num_states; s++) {
+        for (int c = 0; c < D->num_classes; c++) {
+            if (used[c] && dfaNextClass(D, s, c) < 0) return false;
+        }
+    }
+    return true;
+}
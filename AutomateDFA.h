@@ -0,0 +1,59 @@
+#ifndef AUTOMATE_DFA_H
+#define AUTOMATE_DFA_H
+
+#include "AutomateCore.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// --- Frozen DFA ---
+// Read-only dense form of a deterministic Automaton: one contiguous table
+// indexed by state * num_classes + class, plus an accept bitmap. Columns are
+// byte classes (see byteClasses()), so every input byte has a column, bytes
+// outside the alphabet included, and a step needs no range check. The table
+// uses 16-bit cells whenever the state count allows it.
+
+#define DFA_NO_STATE16 UINT16_MAX
+
+typedef struct {
+    int num_states;
+    int num_symbols;
+    int num_classes;        // Table columns
+    int initial;            // -1 when the automaton has no initial state
+
+    bool narrow;            // table16 in use instead of table32
+    int32_t *table32;       // -1 = no transition
+    uint16_t *table16;      // DFA_NO_STATE16 = no transition
+    uint64_t *accept;       // Bit per state
+    uint8_t classes[ALPHABET_MAX];          // Byte -> column
+    unsigned char letters[ALPHABET_MAX];    // Symbol -> byte, as in the automaton
+
+    // Set when loaded by loadDenseDFA(): the tables point into this image
+    // (read-only mapping) and are released with it
+    const void *image;
+    size_t image_size;
+    bool image_mapped;
+} DenseDFA;
+
+bool freezeDFA(const Automaton *A, DenseDFA *D, FILE *logFile);
+void freeDenseDFA(DenseDFA *D);
+
+// Next state over a column, -1 when there is no transition
+static inline int dfaNextClass(const DenseDFA *D, int state, int column) {
+    size_t idx = (size_t)state * D->num_classes + column;
+    if (D->narrow) return D->table16[idx] == DFA_NO_STATE16 ? -1 : D->table16[idx];
+    return D->table32[idx];
+}
+
+static inline int dfaNext(const DenseDFA *D, int state, unsigned char byte) {
+    return dfaNextClass(D, state, D->classes[byte]);
+}
+
+static inline bool dfaIsAccepting(const DenseDFA *D, int state) {
+    return (D->accept[state >> 6] >> (state & 63)) & 1;
+}
+
+// DFA-only paths on the frozen table
+bool recognizeWordDFA(const DenseDFA *D, const char *word);
+bool isCompleteDFA(const DenseDFA *D);
+
+#endif // AUTOMATE_DFA_H
@@ -0,0 +1,373 @@
+#include "AutomateEquiv.h"
+#include "AutomateAnalysis.h"
+#include "AutomateSet.h"
+#include "AutomateStats.h"
+#include "AutomateTransform.h"
+#include <string.h>
+
+// --- Explored Pairs ---
+// Every pair remembers the pair it was reached from and the symbol read, so
+// the word leading to any pair can be rebuilt.
+
+typedef struct {
+    int left;       // Hopcroft-Karp: state node; antichains: state of A
+    int right;      // Hopcroft-Karp: state node; antichains: subset id of B
+    int parent;     // -1 for the initial pairs
+    int symbol;     // Merged symbol read from the parent
+} PairNode;
+
+typedef struct {
+    PairNode *nodes;
+    int count;
+    int capacity;
+} PairList;
+
+static int pushPair(PairList *L, int left, int right, int parent, int symbol) {
+    if (L->count == L->capacity) {
+        int capacity = L->capacity ? L->capacity * 2 : 256;
+        PairNode *temp = realloc(L->nodes, capacity * sizeof(PairNode));
+        if (!temp) return -1;
+        L->nodes = temp;
+        L->capacity = capacity;
+    }
+    L->nodes[L->count] = (PairNode){ left, right, parent, symbol };
+    return L->count++;
+}
+
+// Sets R to "no", with the word leading to pair `index` as the counterexample
+static bool refute(LanguageCheck *R, const PairList *L, int index, const Alphabet *merged, bool in_first) {
+    int length = 0;
+    for (int i = index; L->nodes[i].parent >= 0; i = L->nodes[i].parent) length++;
+    R->word = malloc(length + 1);
+    if (!R->word) return false;
+    R->word[length] = '\0';
+    R->length = length;
+    for (int i = index; L->nodes[i].parent >= 0; i = L->nodes[i].parent) {
+        R->word[--length] = merged->letters[L->nodes[i].symbol];
+    }
+    R->holds = false;
+    R->in_first = in_first;
+    return true;
+}
+
+static void initLanguageCheck(LanguageCheck *R) {
+    memset(R, 0, sizeof(LanguageCheck));
+    R->holds = true;
+}
+
+void freeLanguageCheck(LanguageCheck *R) {
+    if (!R) return;
+    free(R->word);
+    R->word = NULL;
+    R->length = 0;
+}
+
+// --- Hopcroft-Karp (DFAs) ---
+// Nodes: states of A, then states of B, then the dead state.
+
+typedef struct {
+    const Automaton *A;
+    const Automaton *B;
+    const Alphabet *merged;
+    int dead;
+} DFAPair;
+
+static int dfaStep(const DFAPair *P, int node, int symbol) {
+    if (node == P->dead) return node;
+    bool left = node < P->A->num_states;
+    const Automaton *X = left ? P->A : P->B;
+    int state = left ? node : node - P->A->num_states;
+    int sym = symbolOf(X, P->merged->letters[symbol]);
+    if (sym < 0) return P->dead;
+    int count;
+    const int *dests = cellTransitions(X, state * X->num_symbols + sym, &count);
+    if (count == 0) return P->dead;
+    return left ? dests[0] : dests[0] + P->A->num_states;
+}
+
+static int findRoot(int *parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];     // Path halving
+        x = parent[x];
+    }
+    return x;
+}
+
+static bool hopcroftKarp(const Automaton *A, const Automaton *B, LanguageCheck *R) {
+    Alphabet merged;
+    const Automaton *inputs[2] = { A, B };
+    int k = mergeAlphabets(inputs, 2, &merged);
+    DFAPair P = { A, B, &merged, A->num_states + B->num_states };
+    int num_nodes = P.dead + 1;
+
+    bool ok = false;
+    PairList pairs = { NULL, 0, 0 };
+    Bitset finals;
+    int *parent = malloc(num_nodes * sizeof(int));
+    int *size = malloc(num_nodes * sizeof(int));
+    if (!parent || !size || !bitsetInit(&finals, num_nodes)) {
+        free(parent);
+        free(size);
+        return false;
+    }
+    for (int x = 0; x < num_nodes; x++) {
+        parent[x] = x;
+        size[x] = 1;
+    }
+    for (int i = 0; i < A->num_finals; i++) bitsetAdd(&finals, A->finals[i]);
+    for (int i = 0; i < B->num_finals; i++) bitsetAdd(&finals, B->finals[i] + A->num_states);
+
+    int x = A->initials[0], y = B->initials[0] + A->num_states;
+    if (pushPair(&pairs, x, y, -1, -1) < 0) goto cleanup;
+    parent[y] = x;
+    size[x] += size[y];
+    if (bitsetContains(&finals, x) != bitsetContains(&finals, y)) {
+        ok = refute(R, &pairs, 0, &merged, bitsetContains(&finals, x));
+        goto cleanup;
+    }
+
+    for (int processed = 0; processed < pairs.count; processed++) {
+        int p = pairs.nodes[processed].left, q = pairs.nodes[processed].right;
+        for (int sym = 0; sym < k; sym++) {
+            x = dfaStep(&P, p, sym);
+            y = dfaStep(&P, q, sym);
+            int rx = findRoot(parent, x), ry = findRoot(parent, y);
+            if (rx == ry) continue;
+            // Union by size
+            if (size[rx] < size[ry]) {
+                int t = rx; rx = ry; ry = t;
+            }
+            parent[ry] = rx;
+            size[rx] += size[ry];
+
+            int id = pushPair(&pairs, x, y, processed, sym);
+            if (id < 0) goto cleanup;
+            if (bitsetContains(&finals, x) != bitsetContains(&finals, y)) {
+                ok = refute(R, &pairs, id, &merged, bitsetContains(&finals, x));
+                goto cleanup;
+            }
+        }
+    }
+    ok = true;
+
+cleanup:
+    R->pairs = pairs.count;
+    free(pairs.nodes);
+    free(parent);
+    free(size);
+    bitsetFree(&finals);
+    return ok;
+}
+
+// --- Antichains (NFAs) ---
+// Pairs (p, S): p a state of A, S an interned subset of B. The subsets
+// explored with each state p are kept by size, in groups of increasing size,
+// so that only the strictly smaller ones are tried as cover; equal subsets
+// are caught by the `seen` table of (p, S) pairs. With a deterministic B
+// every subset has at most one state, and the check is constant time.
+
+typedef struct {
+    int subset;
+    int next;       // Next entry of the group, -1 at the end
+} ChainEntry;
+
+typedef struct {
+    int size;       // Number of states of B in the group's subsets
+    int first;      // First entry
+    int next;       // Next group (larger size), -1 at the end
+} ChainGroup;
+
+// Makes room for one more item in a realloc'ed array
+static bool reserveOne(void **array, int count, int *capacity, size_t item) {
+    if (count < *capacity) return true;
+    int new_capacity = *capacity ? *capacity * 2 : 256;
+    void *temp = realloc(*array, new_capacity * item);
+    if (!temp) return false;
+    *array = temp;
+    *capacity = new_capacity;
+    return true;
+}
+
+// Sorted lists: every member of T is in S
+static bool sortedIncluded(const int *T, int t_count, const int *S, int s_count) {
+    if (t_count > s_count) return false;
+    int j = 0;
+    for (int i = 0; i < t_count; i++) {
+        while (j < s_count && S[j] < T[i]) j++;
+        if (j == s_count || S[j] != T[i]) return false;
+        j++;
+    }
+    return true;
+}
+
+typedef struct {
+    const Automaton *A;
+    const Automaton *B;
+    Alphabet merged;
+    SubsetTable table;      // Subsets of B
+    SubsetTable seen;       // Explored (p, subset id) pairs
+    PairList pairs;
+    ChainEntry *entries;
+    int num_entries;
+    int entries_capacity;
+    ChainGroup *groups;
+    int num_groups;
+    int groups_capacity;
+    int *head;              // First group of each state of A, -1 = none
+    Bitset finalsA;
+    Bitset finalsB;
+    SparseSet nextA;        // States of A reached by the pair being expanded
+    SparseSet nextB;        // Subset of B reached with them
+} Antichain;
+
+typedef enum { VISIT_OK, VISIT_REFUTED, VISIT_FAILED } VisitResult;
+
+// True when a subset explored with p is strictly included in nextB
+static bool covered(const Antichain *C, int p) {
+    for (int g = C->head[p]; g >= 0 && C->groups[g].size < C->nextB.count; g = C->groups[g].next) {
+        for (int e = C->groups[g].first; e >= 0; e = C->entries[e].next) {
+            size_t size;
+            const int *T = subsetTableKey(&C->table, C->entries[e].subset, &size);
+            if (sortedIncluded(T, (int)(size / sizeof(int)), C->nextB.dense, C->nextB.count)) return true;
+        }
+    }
+    return false;
+}
+
+// Files `subset` (of nextB's size) under p
+static bool addToChain(Antichain *C, int p, int subset) {
+    int size = C->nextB.count, prev = -1, g = C->head[p];
+    while (g >= 0 && C->groups[g].size < size) {
+        prev = g;
+        g = C->groups[g].next;
+    }
+    if (g < 0 || C->groups[g].size != size) {
+        if (!reserveOne((void **)&C->groups, C->num_groups, &C->groups_capacity, sizeof(ChainGroup))) return false;
+        C->groups[C->num_groups] = (ChainGroup){ size, -1, g };
+        g = C->num_groups++;
+        if (prev < 0) C->head[p] = g;
+        else C->groups[prev].next = g;
+    }
+    if (!reserveOne((void **)&C->entries, C->num_entries, &C->entries_capacity, sizeof(ChainEntry))) return false;
+    C->entries[C->num_entries] = (ChainEntry){ subset, C->groups[g].first };
+    C->groups[g].first = C->num_entries++;
+    return true;
+}
+
+// Adds the pairs (p, nextB) for every p in nextA that no known pair covers;
+// `parent` and `symbol` record how they were reached.
+static VisitResult visitPairs(Antichain *C, int parent, int symbol) {
+    bool subset_final = subsetIsFinal(C->nextB.dense, C->nextB.count, &C->finalsB);
+    int subset = -1;
+    for (int i = 0; i < C->nextA.count; i++) {
+        int p = C->nextA.dense[i];
+        if (bitsetContains(&C->finalsA, p) && !subset_final) {
+            return pushPair(&C->pairs, p, -1, parent, symbol) < 0 ? VISIT_FAILED : VISIT_REFUTED;
+        }
+        if (subset < 0) {
+            subset = subsetTableInsert(&C->table, C->nextB.dense, C->nextB.count * sizeof(int), NULL);
+            if (subset < 0) return VISIT_FAILED;
+        }
+        int key[2] = { p, subset };
+        if (subsetTableFind(&C->seen, key, sizeof(key)) >= 0 || covered(C, p)) continue;
+        if (subsetTableInsert(&C->seen, key, sizeof(key), NULL) < 0 || !addToChain(C, p, subset) ||
+            pushPair(&C->pairs, p, subset, parent, symbol) < 0) return VISIT_FAILED;
+    }
+    return VISIT_OK;
+}
+
+static bool antichainInclusion(const Automaton *A, const Automaton *B, LanguageCheck *R, bool in_first) {
+    Antichain C;
+    memset(&C, 0, sizeof(Antichain));
+    C.A = A;
+    C.B = B;
+    const Automaton *inputs[2] = { A, B };
+    int k = mergeAlphabets(inputs, 2, &C.merged);
+
+    bool ok = false;
+    Arena scratch;
+    if (!arenaInit(&scratch, ((size_t)A->num_states + B->num_states) * 16 + 4096)) return false;
+    if (!subsetTableInit(&C.table, 64)) {
+        arenaRelease(&scratch);
+        return false;
+    }
+    if (!subsetTableInit(&C.seen, 64)) {
+        subsetTableFree(&C.table);
+        arenaRelease(&scratch);
+        return false;
+    }
+    C.head = arenaAlloc(&scratch, A->num_states * sizeof(int));
+    if (!C.head || !bitsetInitArena(&C.finalsA, A->num_states, &scratch) ||
+        !bitsetInitArena(&C.finalsB, B->num_states, &scratch) ||
+        !sparseSetInitArena(&C.nextA, A->num_states, &scratch) ||
+        !sparseSetInitArena(&C.nextB, B->num_states, &scratch)) goto cleanup;
+    for (int p = 0; p < A->num_states; p++) C.head[p] = -1;
+    for (int i = 0; i < A->num_finals; i++) bitsetAdd(&C.finalsA, A->finals[i]);
+    for (int i = 0; i < B->num_finals; i++) bitsetAdd(&C.finalsB, B->finals[i]);
+
+    // Initial pairs: every initial state of A (closures included) with the initial subset of B
+    subsetStart(A, &C.nextA);
+    subsetStart(B, &C.nextB);
+    VisitResult result = visitPairs(&C, -1, -1);
+
+    for (int processed = 0; result == VISIT_OK && processed < C.pairs.count; processed++) {
+        for (int sym = 0; result == VISIT_OK && sym < k; sym++) {
+            // Pairs move when the list grows: read them before visiting
+            int p = C.pairs.nodes[processed].left, subset = C.pairs.nodes[processed].right;
+            unsigned char letter = C.merged.letters[sym];
+            int symA = symbolOf(A, letter), symB = symbolOf(B, letter);
+            if (symA < 0) continue;
+            subsetStep(A, &p, 1, symA, &C.nextA);
+            if (C.nextA.count == 0) continue;
+            if (symB >= 0) {
+                size_t size;
+                const int *S = subsetTableKey(&C.table, subset, &size);
+                subsetStep(B, S, (int)(size / sizeof(int)), symB, &C.nextB);
+            } else {
+                sparseSetClear(&C.nextB);
+            }
+            result = visitPairs(&C, processed, sym);
+        }
+    }
+    if (result == VISIT_REFUTED) ok = refute(R, &C.pairs, C.pairs.count - 1, &C.merged, in_first);
+    else ok = result == VISIT_OK;
+
+cleanup:
+    R->pairs += C.pairs.count;
+    free(C.pairs.nodes);
+    free(C.entries);
+    free(C.groups);
+    STATS_COUNT(COUNT_SUBSET_LOOKUPS, C.table.lookups);
+    STATS_COUNT(COUNT_SUBSET_PROBES, C.table.probes);
+    subsetTableFree(&C.table);
+    subsetTableFree(&C.seen);
+    arenaRelease(&scratch);
+    return ok;
+}
+
+// --- Entry Points ---
+
+bool checkInclusion(const Automaton *A, const Automaton *B, LanguageCheck *R, FILE *logFile) {
+    (void)logFile;
+    STATS_START(timer);
+    initLanguageCheck(R);
+    bool ok = antichainInclusion(A, B, R, true);
+    if (!ok) freeLanguageCheck(R);
+    STATS_END(PHASE_EQUIVALENCE, timer);
+    return ok;
+}
+
+bool checkEquivalence(const Automaton *A, const Automaton *B, LanguageCheck *R, FILE *logFile) {
+    STATS_START(timer);
+    initLanguageCheck(R);
+    bool ok;
+    if (isDeterministic(A, logFile) && isDeterministic(B, logFile)) {
+        ok = hopcroftKarp(A, B, R);
+    } else {
+        ok = antichainInclusion(A, B, R, true);
+        if (ok && R->holds) ok = antichainInclusion(B, A, R, false);
+    }
+    if (!ok) freeLanguageCheck(R);
+    STATS_END(PHASE_EQUIVALENCE, timer);
+    return ok;
+}
@@ -0,0 +1,42 @@
+#ifndef AUTOMATE_EQUIV_H
+#define AUTOMATE_EQUIV_H
+
+#include "AutomateCore.h"
+#include <stdio.h>
+
+// --- Language Equivalence and Inclusion ---
+// Decided without determinizing, completing or minimizing the inputs, and
+// with a counterexample word when the answer is no. Alphabets are merged by
+// byte: a byte outside an automaton's alphabet leads nowhere in it.
+//
+// - Two DFAs: Hopcroft-Karp. States of both automata (and one shared dead
+//   state for missing transitions) are merged in a union-find as pairs are
+//   proved equivalent, so each merge enqueues at most one pair: near-linear
+//   in the number of states.
+// - NFAs: antichains. L(A) is included in L(B) when no pair (p, S) reachable
+//   by a same word, p a state of A and S the set of states of B, has p final
+//   and S free of finals. S is built on the fly as in the subset
+//   construction, and a pair is skipped when a pair (p, T) with T a subset
+//   of S is already known (what T cannot refute, S cannot either). Equality
+//   is inclusion both ways.
+//
+// Pairs are explored breadth-first, so counterexamples tend to be short.
+
+typedef struct {
+    bool holds;             // Equivalent / included
+    // When !holds: a word of the first language that is not in the second,
+    // or the other way round for equivalence (in_first false).
+    // NUL-terminated, but the alphabet may contain NUL: use `length`.
+    unsigned char *word;
+    int length;
+    bool in_first;
+    long long pairs;        // Pairs explored
+} LanguageCheck;
+
+// False only when out of memory (R is then empty)
+bool checkEquivalence(const Automaton *A, const Automaton *B, LanguageCheck *R, FILE *logFile);
+// L(A) included in L(B)
+bool checkInclusion(const Automaton *A, const Automaton *B, LanguageCheck *R, FILE *logFile);
+void freeLanguageCheck(LanguageCheck *R);
+
+#endif // AUTOMATE_EQUIV_H
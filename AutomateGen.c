@@ -0,0 +1,114 @@
+#include "AutomateGen.h"
+#include <stdlib.h>
+
+// --- PRNG ---
+
+void genSeed(GenRandom *R, uint64_t seed) {
+    R->state = seed;
+}
+
+uint64_t genNext(GenRandom *R) {
+    uint64_t z = (R->state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+uint32_t genBelow(GenRandom *R, uint32_t bound) {
+    // Multiply-shift: bias below 2^-32, irrelevant here
+    return (uint32_t)(((genNext(R) >> 32) * (uint64_t)bound) >> 32);
+}
+
+// --- Automata ---
+
+void genDefaultParams(GenParams *P, int num_states, int num_symbols, uint64_t seed) {
+    P->num_states = num_states;
+    P->num_symbols = num_symbols;
+    P->density = 100;
+    P->degree = 1;
+    P->final_percent = 25;
+    P->epsilon_percent = 0;
+    P->seed = seed;
+}
+
+// Single initial state 0, room for every state as final
+static bool createWithStates(Automaton *A, int num_states, int num_symbols) {
+    if (!createAutomatonInArena(A, num_states, num_symbols)) return false;
+    A->initials = automatonAlloc(A, sizeof(int));
+    A->finals = automatonAlloc(A, (num_states > 0 ? num_states : 1) * sizeof(int));
+    if (!A->initials || !A->finals) {
+        freeAutomaton(A);
+        return false;
+    }
+    A->num_initials = 1;
+    A->initials[0] = 0;
+    return true;
+}
+
+bool generateRandom(Automaton *A, const GenParams *P) {
+    int n = P->num_states, k = P->num_symbols;
+    if (n < 1 || k < 0 || !createWithStates(A, n, k)) return false;
+    GenRandom R;
+    genSeed(&R, P->seed);
+    for (int i = 0; i < n; i++) {
+        if ((int)genBelow(&R, 100) < P->final_percent) A->finals[A->num_finals++] = i;
+    }
+
+    AutomatonBuilder B;
+    size_t expected = (size_t)n * k * P->degree * P->density / 100;
+    if (!builderInit(&B, n, k, (int)expected)) {
+        freeAutomaton(A);
+        return false;
+    }
+    bool ok = true;
+    for (int i = 0; i < n && ok; i++) {
+        for (int j = 0; j < k && ok; j++) {
+            if ((int)genBelow(&R, 100) >= P->density) continue;
+            for (int d = 0; d < P->degree && ok; d++) ok = builderAdd(&B, i, j, (int)genBelow(&R, (uint32_t)n));
+        }
+    }
+    // Drawn last, so the rest of the automaton does not depend on them
+    for (int i = 0; i < n && ok && P->epsilon_percent > 0; i++) {
+        if ((int)genBelow(&R, 100) < P->epsilon_percent) ok = builderAddEpsilon(&B, i, (int)genBelow(&R, (uint32_t)n));
+    }
+    if (!ok || !builderFreeze(&B, A)) {
+        builderFree(&B);
+        freeAutomaton(A);
+        return false;
+    }
+    return true;
+}
+
+bool generateBlowup(Automaton *A, int n) {
+    if (n < 0 || !createWithStates(A, n + 2, 2)) return false;
+    A->num_finals = 1;
+    A->finals[0] = n + 1;
+
+    AutomatonBuilder B;
+    bool ok = builderInit(&B, n + 2, 2, 2 * n + 3) &&
+              builderAdd(&B, 0, 0, 0) && builderAdd(&B, 0, 1, 0) && builderAdd(&B, 0, 0, 1);
+    for (int i = 1; i <= n && ok; i++) {
+        ok = builderAdd(&B, i, 0, i + 1) && builderAdd(&B, i, 1, i + 1);
+    }
+    if (!ok || !builderFreeze(&B, A)) {
+        builderFree(&B);
+        freeAutomaton(A);
+        return false;
+    }
+    return true;
+}
+
+// --- Words ---
+
+char *generateWords(int num_words, int length, int num_symbols, uint64_t seed) {
+    char *words = malloc((size_t)num_words * (length + 1));
+    if (!words) return NULL;
+    GenRandom R;
+    genSeed(&R, seed);
+    for (int w = 0; w < num_words; w++) {
+        char *word = words + (size_t)w * (length + 1);
+        for (int i = 0; i < length; i++) word[i] = (char)('a' + genBelow(&R, (uint32_t)num_symbols));
+        word[length] = '\0';
+    }
+    return words;
+}
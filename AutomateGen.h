@@ -0,0 +1,45 @@
+#ifndef AUTOMATE_GEN_H
+#define AUTOMATE_GEN_H
+
+#include "AutomateCore.h"
+#include <stdint.h>
+
+// --- Synthetic Automata ---
+// Reproducible generators for benchmarks and stress tests. They draw from
+// their own PRNG (splitmix64), never rand(), so a seed gives the same
+// automaton on every platform and benchmark results compare across machines.
+
+typedef struct {
+    uint64_t state;
+} GenRandom;
+
+void genSeed(GenRandom *R, uint64_t seed);
+uint64_t genNext(GenRandom *R);
+// Uniform in [0, bound)
+uint32_t genBelow(GenRandom *R, uint32_t bound);
+
+typedef struct {
+    int num_states;
+    int num_symbols;
+    int density;        // Percentage of (state, symbol) cells given transitions
+    int degree;         // Random destinations per such cell: 1 yields a (partial) DFA
+    int final_percent;  // Percentage of final states
+    int epsilon_percent;    // Percentage of states given one random epsilon transition
+    uint64_t seed;
+} GenParams;
+
+// 100% density, degree 1, a quarter of the states final, no epsilon transitions
+void genDefaultParams(GenParams *P, int num_states, int num_symbols, uint64_t seed);
+// State 0 is the single initial state. Built in CSR form.
+bool generateRandom(Automaton *A, const GenParams *P);
+
+// (a|b)*a(a|b)^n: n + 2 NFA states, 2^(n + 1) DFA states after
+// determinization (the classic worst case of the subset construction)
+bool generateBlowup(Automaton *A, int n);
+
+// num_words random words of `length` letters over the first num_symbols
+// letters of the default lettering (num_symbols < 160 keeps NUL out),
+// NUL-terminated with a stride of length + 1
+char *generateWords(int num_words, int length, int num_symbols, uint64_t seed);
+
+#endif // AUTOMATE_GEN_H
@@ -1,8 +1,19 @@
 #include "AutomateIO.h"
-#include <stdarg.h>
+#include "AutomateSet.h" // For hashBytes
+#include "AutomateStats.h"
+#include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 #include <dirent.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#define AUTOMATE_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 // --- Helper for safe input ---
 static void safe_gets(char *buffer, int size) {
     if (fgets(buffer, size, stdin) != NULL) {
@@ -13,28 +24,93 @@ static void safe_gets(char *buffer, int size) {
     }
 }
 
-// --- Logging ---
+// --- Symbols ---
+// In text, a symbol is its byte when printable (other than '\\' and '"'),
+// otherwise an escape: \\ \" \n \r \t or \xHH. In transitions, \e stands
+// for epsilon.
 
-void logMessage(FILE *logFile, const char *format, ...) {
-    va_list args;
-    va_start(args, format);
-    vprintf(format, args);
-    va_end(args);
+#define EPSILON_TOKEN "\\e"
 
-    if (logFile) {
-        va_start(args, format);
-        vfprintf(logFile, format, args);
-        va_end(args);
-        fflush(logFile);
+void formatSymbol(unsigned char byte, char out[5]) {
+    if (byte > ' ' && byte < 0x7F && byte != '\\' && byte != '"') {
+        out[0] = (char)byte;
+        out[1] = '\0';
+        return;
+    }
+    switch (byte) {
+        case '\\': strcpy(out, "\\\\"); break;
+        case '"': strcpy(out, "\\\""); break;
+        case '\n': strcpy(out, "\\n"); break;
+        case '\r': strcpy(out, "\\r"); break;
+        case '\t': strcpy(out, "\\t"); break;
+        default: snprintf(out, 5, "\\x%02X", byte); break;
     }
 }
 
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Reads one symbol (a byte or an escape) at *p, advancing past it
+static bool parseSymbol(const char **p, const char *end, unsigned char *out) {
+    const char *s = *p;
+    if (s >= end) return false;
+    if (*s != '\\') {
+        *out = (unsigned char)*s;
+        *p = s + 1;
+        return true;
+    }
+    if (++s >= end) return false;
+    switch (*s) {
+        case '\\': *out = '\\'; break;
+        case '"': *out = '"'; break;
+        case 'n': *out = '\n'; break;
+        case 'r': *out = '\r'; break;
+        case 't': *out = '\t'; break;
+        case 'x': {
+            int high = s + 2 < end ? hexDigit(s[1]) : -1, low = high >= 0 ? hexDigit(s[2]) : -1;
+            if (low < 0) return false;
+            *out = (unsigned char)(high * 16 + low);
+            s += 2;
+            break;
+        }
+        default: return false;
+    }
+    *p = s + 1;
+    return true;
+}
+
+// --- Printing ---
+
 void printAutomaton(const Automaton *A, FILE *logFile) {
+    if (!logEnabled(LOG_INFO)) return;
+
+    long long transitions = hasEpsilon(A) ? A->eps_offsets[A->num_states] : 0;
+    int cells = A->num_states * A->num_symbols;
+    for (int c = 0; c < cells; c++) transitions += cellCount(A, c);
+    bool full = logEnabled(LOG_DEBUG) ||
+                (transitions <= PRINT_FULL_LIMIT && A->num_initials <= PRINT_FULL_LIMIT &&
+                 A->num_finals <= PRINT_FULL_LIMIT);
+
+    char symbol[5];
     logMessage(logFile, "Alphabet : ");
-    for (int i = 0; i < A->num_symbols; i++)
-        logMessage(logFile, "%c ", 'a' + i);
+    for (int i = 0; i < A->num_symbols; i++) {
+        formatSymbol(A->alphabet.letters[i], symbol);
+        logMessage(logFile, "%s ", symbol);
+    }
     
     logMessage(logFile, "\nEtats : %d", A->num_states);
+
+    if (!full) {
+        logMessage(logFile, "\nEtats initiaux : %d etat(s)", A->num_initials);
+        logMessage(logFile, "\nEtats terminaux : %d etat(s)", A->num_finals);
+        logMessage(logFile, "\nTransitions : %lld (detail au niveau debug)\n", transitions);
+        logMessage(logFile, "-------------------------\n");
+        return;
+    }
     
     logMessage(logFile, "\nEtats initiaux : ");
     for (int i = 0; i < A->num_initials; i++)
@@ -47,67 +123,225 @@ void printAutomaton(const Automaton *A, FILE *logFile) {
     logMessage(logFile, "\nTransitions :\n");
     for (int i = 0; i < A->num_states; i++) {
         for (int j = 0; j < A->num_symbols; j++) {
-            int idx = i * A->num_symbols + j;
-            TransitionList *list = &A->transitions[idx];
-            for (int k = 0; k < list->count; k++) {
-                logMessage(logFile, "  %d --(%c)--> %d\n", i, 'a' + j, list->destinations[k]);
+            int count;
+            const int *dests = cellTransitions(A, i * A->num_symbols + j, &count);
+            formatSymbol(A->alphabet.letters[j], symbol);
+            for (int k = 0; k < count; k++) {
+                logMessage(logFile, "  %d --(%s)--> %d\n", i, symbol, dests[k]);
             }
         }
+        int count;
+        const int *dests = epsilonTransitions(A, i, &count);
+        for (int k = 0; k < count; k++) logMessage(logFile, "  %d --(" EPSILON_TOKEN ")--> %d\n", i, dests[k]);
     }
     logMessage(logFile, "-------------------------\n");
 }
 
+// --- Mapped Files ---
+
+bool mapFile(const char *filename, MappedFile *F, bool sequential) {
+    memset(F, 0, sizeof(MappedFile));
+#ifdef AUTOMATE_HAVE_MMAP
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            if (sequential) madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+            F->data = map;
+            F->size = (size_t)st.st_size;
+            F->mapped = true;
+            close(fd);
+            return true;
+        }
+    }
+    close(fd);
+#endif
+    // Fallback: read the whole file
+    FILE *file = fopen(filename, "rb");
+    if (!file) return false;
+    size_t size = 0, capacity = 1 << 16;
+    char *data = malloc(capacity);
+    while (data) {
+        size += fread(data + size, 1, capacity - size, file);
+        if (size < capacity) break;
+        char *temp = realloc(data, capacity * 2);
+        if (!temp) { free(data); data = NULL; break; }
+        data = temp;
+        capacity *= 2;
+    }
+    fclose(file);
+    if (!data) return false;
+    F->data = data;
+    F->size = size;
+    return true;
+}
+
+void unmapFile(MappedFile *F) {
+    if (!F) return;
+#ifdef AUTOMATE_HAVE_MMAP
+    if (F->mapped) munmap((void *)F->data, F->size);
+    else free((void *)F->data);
+#else
+    free((void *)F->data);
+#endif
+    memset(F, 0, sizeof(MappedFile));
+}
+
 // --- File Loading ---
+// The file is mapped read-only (or read into memory where mmap is missing)
+// and tokenized in place: no stdio buffering, no format-string parsing.
+// Pages are only touched once, in order, so the kernel can stream files
+// larger than RAM through the page cache.
+
+typedef struct {
+    MappedFile file;
+    const char *p;
+    const char *end;
+} Scanner;
+
+static bool scannerOpen(Scanner *S, const char *filename) {
+    if (!mapFile(filename, &S->file, true)) return false;
+    S->p = S->file.data;
+    S->end = S->file.data + S->file.size;
+    return true;
+}
+
+static void scannerClose(Scanner *S) {
+    unmapFile(&S->file);
+    S->p = S->end = NULL;
+}
+
+static inline void skipSpaces(Scanner *S) {
+    while (S->p < S->end && (*S->p == ' ' || (*S->p >= '\t' && *S->p <= '\r'))) S->p++;
+}
+
+// Same tokens as fscanf("%d"): optional sign, then at least one digit.
+// Values beyond the int range saturate.
+static bool scanInt(Scanner *S, int *out) {
+    skipSpaces(S);
+    const char *p = S->p;
+    bool negative = false;
+    if (p < S->end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+    if (p >= S->end || (unsigned)(*p - '0') > 9) return false;
+
+    long long value = 0;
+    for (; p < S->end && (unsigned)(*p - '0') <= 9; p++) {
+        if (value <= INT_MAX) value = value * 10 + (*p - '0');
+    }
+    if (negative) value = -value;
+    *out = value > INT_MAX ? INT_MAX : value < INT_MIN ? INT_MIN : (int)value;
+    S->p = p;
+    return true;
+}
+
+// Like fscanf(" %c"): the next non-space character, or an escape.
+// Sets *epsilon instead for \e.
+static bool scanSymbol(Scanner *S, unsigned char *out, bool *epsilon) {
+    skipSpaces(S);
+    *epsilon = S->end - S->p >= 2 && S->p[0] == '\\' && S->p[1] == 'e';
+    if (*epsilon) {
+        S->p += 2;
+        return true;
+    }
+    return parseSymbol(&S->p, S->end, out);
+}
+
+// Optional alphabet declaration after the symbol count: "letters", one
+// symbol (byte or escape) per letter. Sets *declared when present.
+static bool scanAlphabet(Scanner *S, unsigned char letters[ALPHABET_MAX], int num_symbols, bool *declared) {
+    skipSpaces(S);
+    *declared = S->p < S->end && *S->p == '"';
+    if (!*declared) return true;
+    S->p++;
+    int count = 0;
+    while (S->p < S->end && *S->p != '"') {
+        if (count >= num_symbols || !parseSymbol(&S->p, S->end, &letters[count++])) return false;
+    }
+    if (S->p >= S->end || count != num_symbols) return false;
+    S->p++;
+    return true;
+}
+
+// State indices read from a file, all in [0, limit)
+static bool validIndices(const int32_t *values, int count, int limit) {
+    for (int i = 0; i < count; i++) {
+        if (values[i] < 0 || values[i] >= limit) return false;
+    }
+    return true;
+}
 
 bool loadAutomaton(const char *filename, Automaton *A, FILE *logFile) {
     memset(A, 0, sizeof(Automaton)); // Safety init
+    STATS_START(timer);
 
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        logMessage(logFile, "Erreur : Impossible d'ouvrir %s\n", filename);
+    Scanner file;
+    if (!scannerOpen(&file, filename)) {
+        logAt(LOG_ERROR, logFile, "Erreur : Impossible d'ouvrir %s\n", filename);
         return false;
     }
 
     int n_sym, n_states, n_init, n_final, n_trans;
+    unsigned char letters[ALPHABET_MAX];
+    bool declared;
 
-    if (fscanf(file, "%d", &n_sym) != 1) goto error;
-    if (fscanf(file, "%d", &n_states) != 1) goto error;
+    if (!scanInt(&file, &n_sym)) goto error;
+    if (n_sym < 0 || n_sym > ALPHABET_MAX || !scanAlphabet(&file, letters, n_sym, &declared)) goto error;
+    if (!scanInt(&file, &n_states)) goto error;
 
-    if (!createAutomaton(A, n_states, n_sym)) goto error;
+    if (!createAutomatonInArena(A, n_states, n_sym)) goto error;
+    // Default lettering unless declared; repeated letters are an error
+    if (declared && !alphabetSet(&A->alphabet, letters, n_sym)) goto error_cleanup;
 
-    if (fscanf(file, "%d", &n_init) != 1) goto error_cleanup;
+    if (!scanInt(&file, &n_init) || n_init < 0) goto error_cleanup;
     A->num_initials = n_init;
-    A->initials = malloc(n_init * sizeof(int));
-    if (n_init > 0 && !A->initials) goto error_cleanup;
+    A->initials = automatonAlloc(A, (n_init > 0 ? n_init : 1) * sizeof(int));
+    if (!A->initials) goto error_cleanup;
     for (int i = 0; i < n_init; i++) {
-        if (fscanf(file, "%d", &A->initials[i]) != 1) goto error_cleanup;
+        if (!scanInt(&file, &A->initials[i])) goto error_cleanup;
     }
+    if (!validIndices(A->initials, n_init, n_states)) goto error_cleanup;
 
-    if (fscanf(file, "%d", &n_final) != 1) goto error_cleanup;
+    if (!scanInt(&file, &n_final) || n_final < 0) goto error_cleanup;
     A->num_finals = n_final;
-    A->finals = malloc(n_final * sizeof(int));
-    if (n_final > 0 && !A->finals) goto error_cleanup;
+    A->finals = automatonAlloc(A, (n_final > 0 ? n_final : 1) * sizeof(int));
+    if (!A->finals) goto error_cleanup;
     for (int i = 0; i < n_final; i++) {
-        if (fscanf(file, "%d", &A->finals[i]) != 1) goto error_cleanup;
+        if (!scanInt(&file, &A->finals[i])) goto error_cleanup;
     }
+    if (!validIndices(A->finals, n_final, n_states)) goto error_cleanup;
 
-    if (fscanf(file, "%d", &n_trans) != 1) goto error_cleanup;
+    if (!scanInt(&file, &n_trans)) goto error_cleanup;
+    AutomatonBuilder builder;
+    if (!builderInit(&builder, n_states, n_sym, n_trans)) goto error_cleanup;
     for (int i = 0; i < n_trans; i++) {
         int u, v;
-        char s;
-        if (fscanf(file, "%d %c %d", &u, &s, &v) == 3) {
-            addTransition(A, u, s - 'a', v);
+        unsigned char s;
+        bool epsilon;
+        // A malformed line ends the list, as it did with fscanf
+        if (!scanInt(&file, &u) || !scanSymbol(&file, &s, &epsilon) || !scanInt(&file, &v)) break;
+        // Out-of-range states or an unknown letter: the file is malformed
+        bool added = epsilon ? builderAddEpsilon(&builder, u, v) : builderAdd(&builder, u, symbolOf(A, s), v);
+        if (!added) {
+            builderFree(&builder);
+            goto error_cleanup;
         }
     }
+    if (!builderFreeze(&builder, A)) {
+        builderFree(&builder);
+        goto error_cleanup;
+    }
 
-    fclose(file);
+    scannerClose(&file);
+    STATS_END(PHASE_LOAD, timer);
     return true;
 
 error_cleanup:
     freeAutomaton(A);
 error:
-    logMessage(logFile, "Erreur : Format de fichier invalide ou incomplet (%s).\n", filename);
-    if (file) fclose(file);
+    logAt(LOG_ERROR, logFile, "Erreur : Format de fichier invalide ou incomplet (%s).\n", filename);
+    scannerClose(&file);
     return false;
 }
 
@@ -127,54 +361,132 @@ bool resolveAutomatesPath(char *buffer, size_t size, FILE *logFile) {
             return true;
         }
     }
-    logMessage(logFile, "Erreur critique : Impossible de trouver le dossier 'Automates'.\n");
+    logAt(LOG_ERROR, logFile, "Erreur critique : Impossible de trouver le dossier 'Automates'.\n");
     return false;
 }
 
-void listAndChooseFile(char *buffer, size_t size, FILE *logFile) {
-    char folderPath[512];
-    if (!resolveAutomatesPath(folderPath, sizeof(folderPath), logFile)) {
-        buffer[0] = '\0';
-        return;
+bool saveAutomaton(const Automaton *A, const char *filename, FILE *logFile) {
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        logAt(LOG_ERROR, logFile, "Erreur : Impossible d'ecrire %s\n", filename);
+        return false;
     }
+    setvbuf(file, NULL, _IOFBF, 1 << 16);
 
-    DIR *d = opendir(folderPath);
-    if (!d) return;
-
-    struct dirent *dir;
-    char files[100][256];
-    int count = 0;
+    long long num_trans = hasEpsilon(A) ? A->eps_offsets[A->num_states] : 0;
+    int cells = A->num_states * A->num_symbols;
+    for (int c = 0; c < cells; c++) num_trans += cellCount(A, c);
 
-    logMessage(logFile, "\nFichiers disponibles (dans %s) :\n", folderPath);
-    while ((dir = readdir(d)) != NULL) {
-        if (strstr(dir->d_name, ".txt")) {
-            strncpy(files[count], dir->d_name, 255);
-            logMessage(logFile, "%d. %s\n", count + 1, files[count]);
-            count++;
-            if (count >= 100) break;
+    char symbol[5];
+    fprintf(file, "%d", A->num_symbols);
+    if (!alphabetIsDefault(&A->alphabet, A->num_symbols)) {
+        fprintf(file, " \"");
+        for (int i = 0; i < A->num_symbols; i++) {
+            formatSymbol(A->alphabet.letters[i], symbol);
+            fputs(symbol, file);
         }
+        fprintf(file, "\"");
+    }
+    fprintf(file, "\n%d\n%d", A->num_states, A->num_initials);
+    for (int i = 0; i < A->num_initials; i++) fprintf(file, " %d", A->initials[i]);
+    fprintf(file, "\n%d", A->num_finals);
+    for (int i = 0; i < A->num_finals; i++) fprintf(file, " %d", A->finals[i]);
+    fprintf(file, "\n%lld\n", num_trans);
+    for (int c = 0; c < cells; c++) {
+        int count;
+        const int *dests = cellTransitions(A, c, &count);
+        formatSymbol(A->alphabet.letters[c % A->num_symbols], symbol);
+        for (int k = 0; k < count; k++)
+            fprintf(file, "%d %s %d\n", c / A->num_symbols, symbol, dests[k]);
+    }
+    for (int s = 0; s < A->num_states; s++) {
+        int count;
+        const int *dests = epsilonTransitions(A, s, &count);
+        for (int k = 0; k < count; k++) fprintf(file, "%d " EPSILON_TOKEN " %d\n", s, dests[k]);
+    }
+
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) logAt(LOG_ERROR, logFile, "Erreur : Impossible d'ecrire %s\n", filename);
+    return ok;
+}
+
+// --- Directory Listing ---
+
+bool fileListAdd(FileList *L, const char *path) {
+    if (L->count == L->capacity) {
+        int capacity = L->capacity ? L->capacity * 2 : 16;
+        char **paths = realloc(L->paths, capacity * sizeof(char *));
+        if (!paths) return false;
+        L->paths = paths;
+        L->capacity = capacity;
+    }
+    size_t len = strlen(path) + 1;
+    L->paths[L->count] = malloc(len);
+    if (!L->paths[L->count]) return false;
+    memcpy(L->paths[L->count++], path, len);
+    return true;
+}
+
+bool listAutomatonFiles(const char *folder, FileList *L) {
+    DIR *d = opendir(folder);
+    if (!d) return false;
+    bool ok = true;
+    struct dirent *entry;
+    while (ok && (entry = readdir(d)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len < 4 || strcmp(entry->d_name + len - 4, ".txt") != 0) continue;
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", folder, entry->d_name);
+        ok = fileListAdd(L, path);
     }
     closedir(d);
+    return ok;
+}
+
+void freeFileList(FileList *L) {
+    for (int i = 0; i < L->count; i++) free(L->paths[i]);
+    free(L->paths);
+    memset(L, 0, sizeof(FileList));
+}
+
+void listAndChooseFile(char *buffer, size_t size, FILE *logFile) {
+    char folderPath[512];
+    buffer[0] = '\0';
+    if (!resolveAutomatesPath(folderPath, sizeof(folderPath), logFile)) return;
 
-    if (count == 0) {
+    FileList files = { 0 };
+    if (!listAutomatonFiles(folderPath, &files)) {
+        freeFileList(&files);
+        return;
+    }
+
+    logMessage(logFile, "\nFichiers disponibles (dans %s) :\n", folderPath);
+    size_t prefix = strlen(folderPath) + 1;
+    for (int i = 0; i < files.count; i++)
+        logMessage(logFile, "%d. %s\n", i + 1, files.paths[i] + prefix);
+
+    if (files.count == 0) {
         logMessage(logFile, "Aucun fichier .txt trouve.\n");
+        freeFileList(&files);
         return;
     }
 
     int choice = 0;
     do {
-        printf("Votre choix (1-%d) : ", count);
+        printf("Votre choix (1-%d) : ", files.count);
         char input[10];
         safe_gets(input, sizeof(input));
         choice = atoi(input);
-    } while (choice < 1 || choice > count);
+    } while (choice < 1 || choice > files.count);
 
-    snprintf(buffer, size, "%s/%s", folderPath, files[choice - 1]);
+    snprintf(buffer, size, "%s", files.paths[choice - 1]);
+    freeFileList(&files);
 }
 
-void exportToDOT(const Automaton *A, const char *filename) {
+bool exportToDOT(const Automaton *A, const char *filename) {
     FILE *file = fopen(filename, "w");
-    if (!file) return;
+    if (!file) return false;
 
     fprintf(file, "digraph Automaton {\n");
     fprintf(file, "  rankdir=LR;\n");
@@ -193,17 +505,349 @@ void exportToDOT(const Automaton *A, const char *filename) {
         }
     }
 
-    // Transitions
+    // Transitions, labelled with the text-format symbol (quoted for DOT)
     for (int i = 0; i < A->num_states; i++) {
         for (int j = 0; j < A->num_symbols; j++) {
-            int idx = i * A->num_symbols + j;
-            TransitionList *tl = &A->transitions[idx];
-            for (int k = 0; k < tl->count; k++) {
-                fprintf(file, "  %d -> %d [label=\"%c\"];\n", i, tl->destinations[k], 'a' + j);
+            char symbol[5], label[9], *q = label;
+            formatSymbol(A->alphabet.letters[j], symbol);
+            for (const char *s = symbol; *s; s++) {
+                if (*s == '\\' || *s == '"') *q++ = '\\';
+                *q++ = *s;
+            }
+            *q = '\0';
+            int count;
+            const int *dests = cellTransitions(A, i * A->num_symbols + j, &count);
+            for (int k = 0; k < count; k++) {
+                fprintf(file, "  %d -> %d [label=\"%s\"];\n", i, dests[k], label);
             }
         }
+        int count;
+        const int *dests = epsilonTransitions(A, i, &count);
+        for (int k = 0; k < count; k++) fprintf(file, "  %d -> %d [label=\"&epsilon;\"];\n", i, dests[k]);
     }
 
     fprintf(file, "}\n");
+    bool ok = !ferror(file);
+    return fclose(file) == 0 && ok;
+}
+// --- Binary Frozen DFA ---
+// File layout (native byte order, recorded in the header):
+//   [DFAFileHeader, padded to DFA_FILE_ALIGN]
+//   [table: num_states * num_classes cells, uint16 or int32]
+//   [accept bitmap: uint64 words]
+//   [alphabet: the byte of each symbol]
+//   [classes: the column of each of the 256 bytes]
+// Every section starts on a DFA_FILE_ALIGN boundary so the mapped pointers
+// are correctly aligned. The checksum covers everything after the header.
+
+#define DFA_FILE_MAGIC "AUTODFA"
+#define DFA_FILE_VERSION 2   // 2: byte-class columns and any alphabet
+#define DFA_FILE_BYTE_ORDER 0x01020304u
+#define DFA_FILE_ALIGN 64
+#define DFA_FLAG_NARROW 1u
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t flags;
+    int32_t num_states;
+    int32_t num_symbols;
+    int32_t num_classes;
+    int32_t initial;
+    uint64_t table_offset, table_bytes;
+    uint64_t accept_offset, accept_bytes;
+    uint64_t alphabet_offset, alphabet_bytes;
+    uint64_t classes_offset, classes_bytes;
+    uint64_t file_size;
+    uint64_t checksum;
+} DFAFileHeader;
+
+static uint64_t alignUp(uint64_t offset) {
+    return (offset + DFA_FILE_ALIGN - 1) / DFA_FILE_ALIGN * DFA_FILE_ALIGN;
+}
+
+// Fills in the section layout of a DFA with the given shape.
+static void layoutDFAFile(DFAFileHeader *H) {
+    uint64_t cells = (uint64_t)H->num_states * (uint64_t)H->num_classes;
+    H->table_offset = alignUp(sizeof(DFAFileHeader));
+    H->table_bytes = cells * ((H->flags & DFA_FLAG_NARROW) ? sizeof(uint16_t) : sizeof(int32_t));
+    H->accept_offset = alignUp(H->table_offset + H->table_bytes);
+    H->accept_bytes = (((uint64_t)H->num_states + 63) / 64 + 1) * sizeof(uint64_t);
+    H->alphabet_offset = alignUp(H->accept_offset + H->accept_bytes);
+    H->alphabet_bytes = (uint64_t)H->num_symbols;
+    H->classes_offset = alignUp(H->alphabet_offset + H->alphabet_bytes);
+    H->classes_bytes = ALPHABET_MAX;
+    H->file_size = H->classes_offset + H->classes_bytes;
+}
+
+bool saveDenseDFA(const DenseDFA *D, const char *filename, FILE *logFile) {
+    DFAFileHeader H;
+    memset(&H, 0, sizeof(H));
+    memcpy(H.magic, DFA_FILE_MAGIC, sizeof(DFA_FILE_MAGIC));
+    H.version = DFA_FILE_VERSION;
+    H.byte_order = DFA_FILE_BYTE_ORDER;
+    H.flags = D->narrow ? DFA_FLAG_NARROW : 0;
+    H.num_states = D->num_states;
+    H.num_symbols = D->num_symbols;
+    H.num_classes = D->num_classes;
+    H.initial = D->initial;
+    layoutDFAFile(&H);
+
+    unsigned char *image = calloc(H.file_size, 1);
+    if (!image) {
+        logAt(LOG_ERROR, logFile, "Erreur : Memoire insuffisante pour ecrire %s\n", filename);
+        return false;
+    }
+    memcpy(image + H.table_offset, D->narrow ? (const void *)D->table16 : (const void *)D->table32, H.table_bytes);
+    memcpy(image + H.accept_offset, D->accept, H.accept_bytes);
+    memcpy(image + H.alphabet_offset, D->letters, H.alphabet_bytes);
+    memcpy(image + H.classes_offset, D->classes, H.classes_bytes);
+    H.checksum = hashBytes(image + sizeof(H), H.file_size - sizeof(H));
+    memcpy(image, &H, sizeof(H));
+
+    FILE *file = fopen(filename, "wb");
+    bool ok = file && fwrite(image, 1, H.file_size, file) == H.file_size;
+    if (file && fclose(file) != 0) ok = false;
+    free(image);
+    if (!ok) logAt(LOG_ERROR, logFile, "Erreur : Impossible d'ecrire %s\n", filename);
+    return ok;
+}
+
+bool isDenseDFAFile(const char *filename) {
+    char magic[8];
+    FILE *file = fopen(filename, "rb");
+    if (!file) return false;
+    bool match = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                 memcmp(magic, DFA_FILE_MAGIC, sizeof(DFA_FILE_MAGIC)) == 0;
     fclose(file);
-}
\ No newline at end of file
+    return match;
+}
+
+// Header checks: the sections must be exactly where layoutDFAFile() puts
+// them for this shape, and inside the file.
+static bool validDFAHeader(const DFAFileHeader *H, size_t file_size) {
+    if (memcmp(H->magic, DFA_FILE_MAGIC, sizeof(DFA_FILE_MAGIC)) != 0) return false;
+    if (H->version != DFA_FILE_VERSION || H->byte_order != DFA_FILE_BYTE_ORDER) return false;
+    if (H->num_states < 0 || H->num_symbols < 0 || H->num_symbols > ALPHABET_MAX || H->initial < -1 ||
+        H->initial >= H->num_states || H->num_classes < 1 || H->num_classes > ALPHABET_MAX) return false;
+    if ((H->flags & ~DFA_FLAG_NARROW) != 0) return false;
+    if ((H->flags & DFA_FLAG_NARROW) && H->num_states >= DFA_NO_STATE16) return false;
+
+    DFAFileHeader expected = *H;
+    layoutDFAFile(&expected);
+    return H->table_offset == expected.table_offset && H->table_bytes == expected.table_bytes &&
+           H->accept_offset == expected.accept_offset && H->accept_bytes == expected.accept_bytes &&
+           H->alphabet_offset == expected.alphabet_offset && H->alphabet_bytes == expected.alphabet_bytes &&
+           H->classes_offset == expected.classes_offset && H->classes_bytes == expected.classes_bytes &&
+           H->file_size == expected.file_size && H->file_size == file_size;
+}
+
+static bool verifyDFAImage(const DFAFileHeader *H, const DenseDFA *D, const unsigned char *image) {
+    if (hashBytes(image + sizeof(DFAFileHeader), H->file_size - sizeof(DFAFileHeader)) != H->checksum) return false;
+    Alphabet alphabet;
+    if (!alphabetSet(&alphabet, D->letters, D->num_symbols)) return false;
+    size_t cells = (size_t)D->num_states * D->num_classes;
+    for (size_t c = 0; c < cells; c++) {
+        if (D->narrow ? (D->table16[c] != DFA_NO_STATE16 && D->table16[c] >= D->num_states)
+                      : (D->table32[c] < -1 || D->table32[c] >= D->num_states)) return false;
+    }
+    return true;
+}
+
+bool loadDenseDFA(const char *filename, DenseDFA *D, bool verify, FILE *logFile) {
+    memset(D, 0, sizeof(DenseDFA));
+    MappedFile F;
+    if (!mapFile(filename, &F, false)) {
+        logAt(LOG_ERROR, logFile, "Erreur : Impossible d'ouvrir %s\n", filename);
+        return false;
+    }
+
+    DFAFileHeader H;
+    bool ok = F.size >= sizeof(H);
+    if (ok) {
+        memcpy(&H, F.data, sizeof(H));
+        ok = validDFAHeader(&H, F.size);
+    }
+    if (!ok && F.size >= sizeof(H) && memcmp(H.magic, DFA_FILE_MAGIC, sizeof(DFA_FILE_MAGIC)) == 0 &&
+        H.version != DFA_FILE_VERSION) {
+        logAt(LOG_ERROR, logFile, "Erreur : %s est au format DFA v%u (attendu v%d), a recompiler avec --compile.\n",
+              filename, H.version, DFA_FILE_VERSION);
+        unmapFile(&F);
+        return false;
+    }
+    if (ok) {
+        const unsigned char *image = (const unsigned char *)F.data;
+        D->num_states = H.num_states;
+        D->num_symbols = H.num_symbols;
+        D->num_classes = H.num_classes;
+        // Small sections: copied so the DFA reads them like a frozen one
+        memcpy(D->letters, image + H.alphabet_offset, H.alphabet_bytes);
+        memcpy(D->classes, image + H.classes_offset, H.classes_bytes);
+        D->initial = H.initial;
+        D->narrow = (H.flags & DFA_FLAG_NARROW) != 0;
+        // Read-only image: the DFA paths never write to these tables
+        if (D->narrow) D->table16 = (uint16_t *)(image + H.table_offset);
+        else D->table32 = (int32_t *)(image + H.table_offset);
+        D->accept = (uint64_t *)(image + H.accept_offset);
+        D->image = F.data;
+        D->image_size = F.size;
+        D->image_mapped = F.mapped;
+        // Checked even without `verify`: the matchers index the table with these
+        for (int b = 0; ok && b < ALPHABET_MAX; b++) ok = D->classes[b] < D->num_classes;
+        ok = ok && (!verify || verifyDFAImage(&H, D, image));
+    }
+    if (!ok) {
+        logAt(LOG_ERROR, logFile, "Erreur : Fichier DFA binaire invalide ou corrompu (%s).\n", filename);
+        unmapFile(&F);
+        memset(D, 0, sizeof(DenseDFA));
+    }
+    return ok;
+}
+
+// --- Binary Automaton ---
+// Any automaton (NFA or DFA) in CSR form, for caching transformation
+// results. Layout: [AutomatonFileHeader][initials][finals][offsets][targets],
+// then, with epsilon transitions, [epsilon offsets][epsilon targets], all
+// int32, and last [alphabet: the byte of each symbol]. Loading always checks the checksum and every index, then copies
+// into an arena-backed automaton.
+
+#define AUT_FILE_MAGIC "AUTOAUT"
+#define AUT_FILE_VERSION 3   // 2: alphabet section, 3: epsilon transitions
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    int32_t num_symbols;
+    int32_t num_states;
+    int32_t num_initials;
+    int32_t num_finals;
+    int32_t num_transitions;
+    int32_t num_epsilon;
+    uint64_t file_size;
+    uint64_t checksum;
+} AutomatonFileHeader;
+
+bool saveAutomatonBinary(const Automaton *A, const char *filename, FILE *logFile) {
+    size_t cells = (size_t)A->num_states * A->num_symbols;
+    size_t m = 0;
+    for (size_t c = 0; c < cells; c++) m += cellCount(A, (int)c);
+
+    AutomatonFileHeader H;
+    memset(&H, 0, sizeof(H));
+    memcpy(H.magic, AUT_FILE_MAGIC, sizeof(AUT_FILE_MAGIC));
+    H.version = AUT_FILE_VERSION;
+    H.byte_order = DFA_FILE_BYTE_ORDER;
+    H.num_symbols = A->num_symbols;
+    H.num_states = A->num_states;
+    H.num_initials = A->num_initials;
+    H.num_finals = A->num_finals;
+    H.num_transitions = (int32_t)m;
+    H.num_epsilon = hasEpsilon(A) ? A->eps_offsets[A->num_states] : 0;
+    size_t eps_ints = H.num_epsilon > 0 ? (size_t)A->num_states + 1 + H.num_epsilon : 0;
+    size_t ints = (size_t)A->num_initials + A->num_finals + cells + 1 + m + eps_ints;
+    size_t payload_size = ints * sizeof(int32_t) + A->num_symbols;
+    H.file_size = sizeof(H) + payload_size;
+
+    int32_t *payload = malloc(payload_size);
+    if (!payload) {
+        logAt(LOG_ERROR, logFile, "Erreur : Memoire insuffisante pour ecrire %s\n", filename);
+        return false;
+    }
+    int32_t *p = payload;
+    for (int i = 0; i < A->num_initials; i++) *p++ = A->initials[i];
+    for (int i = 0; i < A->num_finals; i++) *p++ = A->finals[i];
+    int32_t *offsets = p, *targets = p + cells + 1;
+    int32_t pos = 0;
+    for (size_t c = 0; c < cells; c++) {
+        int count;
+        const int *dests = cellTransitions(A, (int)c, &count);
+        offsets[c] = pos;
+        for (int t = 0; t < count; t++) targets[pos++] = dests[t];
+    }
+    offsets[cells] = pos;
+    if (eps_ints > 0) {
+        memcpy(targets + m, A->eps_offsets, (A->num_states + 1) * sizeof(int32_t));
+        memcpy(targets + m + A->num_states + 1, A->eps_targets, H.num_epsilon * sizeof(int32_t));
+    }
+    memcpy(payload + ints, A->alphabet.letters, A->num_symbols);
+    H.checksum = hashBytes(payload, payload_size);
+
+    FILE *file = fopen(filename, "wb");
+    bool ok = file && fwrite(&H, sizeof(H), 1, file) == 1 && fwrite(payload, 1, payload_size, file) == payload_size;
+    if (file && fclose(file) != 0) ok = false;
+    free(payload);
+    if (!ok) logAt(LOG_ERROR, logFile, "Erreur : Impossible d'ecrire %s\n", filename);
+    return ok;
+}
+
+bool loadAutomatonBinary(const char *filename, Automaton *A, FILE *logFile) {
+    memset(A, 0, sizeof(Automaton));
+    STATS_START(timer);
+    MappedFile F;
+    if (!mapFile(filename, &F, true)) {
+        logAt(LOG_ERROR, logFile, "Erreur : Impossible d'ouvrir %s\n", filename);
+        return false;
+    }
+
+    AutomatonFileHeader H;
+    bool ok = F.size >= sizeof(H);
+    if (ok) {
+        memcpy(&H, F.data, sizeof(H));
+        ok = memcmp(H.magic, AUT_FILE_MAGIC, sizeof(AUT_FILE_MAGIC)) == 0 && H.version == AUT_FILE_VERSION &&
+             H.byte_order == DFA_FILE_BYTE_ORDER && H.num_symbols >= 0 && H.num_symbols <= ALPHABET_MAX && H.num_states >= 0 &&
+             H.num_initials >= 0 && H.num_finals >= 0 && H.num_transitions >= 0 && H.num_epsilon >= 0 &&
+             H.file_size == F.size;
+    }
+    size_t cells = ok ? (size_t)H.num_states * H.num_symbols : 0;
+    size_t eps_ints = ok && H.num_epsilon > 0 ? (size_t)H.num_states + 1 + H.num_epsilon : 0;
+    size_t ints = ok ? (size_t)H.num_initials + H.num_finals + cells + 1 + H.num_transitions + eps_ints : 0;
+    ok = ok && sizeof(H) + ints * sizeof(int32_t) + H.num_symbols == F.size &&
+         hashBytes(F.data + sizeof(H), F.size - sizeof(H)) == H.checksum;
+
+    if (ok) {
+        // The header keeps the payload 4-byte aligned in the mapping
+        const int32_t *initials = (const int32_t *)(F.data + sizeof(H));
+        const int32_t *finals = initials + H.num_initials;
+        const int32_t *offsets = finals + H.num_finals, *targets = offsets + cells + 1;
+        ok = validIndices(initials, H.num_initials, H.num_states) && validIndices(finals, H.num_finals, H.num_states) &&
+             validIndices(targets, H.num_transitions, H.num_states) && offsets[0] == 0 &&
+             offsets[cells] == H.num_transitions;
+        for (size_t c = 0; ok && c < cells; c++) ok = offsets[c] <= offsets[c + 1];
+        const int32_t *eps_offsets = targets + H.num_transitions;
+        const int32_t *eps_targets = eps_ints > 0 ? eps_offsets + H.num_states + 1 : NULL;
+        if (ok && eps_ints > 0) {
+            ok = eps_offsets[0] == 0 && eps_offsets[H.num_states] == H.num_epsilon &&
+                 validIndices(eps_targets, H.num_epsilon, H.num_states);
+            for (int s = 0; ok && s < H.num_states; s++) ok = eps_offsets[s] <= eps_offsets[s + 1];
+        }
+
+        ok = ok && createAutomatonInArena(A, H.num_states, H.num_symbols) &&
+             alphabetSet(&A->alphabet, (const unsigned char *)(targets + H.num_transitions + eps_ints), H.num_symbols);
+        if (ok) {
+            A->num_initials = H.num_initials;
+            A->num_finals = H.num_finals;
+            A->initials = automatonAlloc(A, (H.num_initials > 0 ? H.num_initials : 1) * sizeof(int));
+            A->finals = automatonAlloc(A, (H.num_finals > 0 ? H.num_finals : 1) * sizeof(int));
+            A->offsets = automatonAlloc(A, (cells + 1) * sizeof(int));
+            A->targets = automatonAlloc(A, (H.num_transitions > 0 ? H.num_transitions : 1) * sizeof(int));
+            ok = A->initials && A->finals && A->offsets && A->targets;
+        }
+        if (ok) {
+            memcpy(A->initials, initials, H.num_initials * sizeof(int));
+            memcpy(A->finals, finals, H.num_finals * sizeof(int));
+            memcpy(A->offsets, offsets, (cells + 1) * sizeof(int));
+            memcpy(A->targets, targets, H.num_transitions * sizeof(int));
+            ok = eps_ints == 0 || setEpsilonTransitions(A, eps_offsets, eps_targets);
+        }
+    }
+    unmapFile(&F);
+    if (!ok) {
+        freeAutomaton(A);
+        memset(A, 0, sizeof(Automaton));
+        logAt(LOG_ERROR, logFile, "Erreur : Fichier automate binaire invalide ou corrompu (%s).\n", filename);
+    }
+    STATS_END(PHASE_LOAD, timer);
+    return ok;
+}
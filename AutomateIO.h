@@ -3,15 +3,65 @@
 
 #include <stdio.h>
 #include "AutomateCore.h"
+#include "AutomateDFA.h"
+#include "AutomateLog.h"
 
-// --- Logging ---
-void logMessage(FILE *logFile, const char *format, ...);
+// --- Printing ---
+// Above PRINT_FULL_LIMIT transitions (or initial/final states), only the
+// counts are printed unless the log level is LOG_DEBUG. Below LOG_INFO,
+// nothing is printed or even counted.
+#define PRINT_FULL_LIMIT 1000
 void printAutomaton(const Automaton *A, FILE *logFile);
+// A byte as written in the text format: itself when printable, otherwise an
+// escape (\\ \" \n \r \t or \xHH)
+void formatSymbol(unsigned char byte, char out[5]);
 
 // --- File Operations ---
 bool loadAutomaton(const char *filename, Automaton *A, FILE *logFile);
+// Writes A in the text format read by loadAutomaton()
+bool saveAutomaton(const Automaton *A, const char *filename, FILE *logFile);
 void listAndChooseFile(char *buffer, size_t size, FILE *logFile);
+
+// --- Directory Listing ---
+typedef struct {
+    char **paths;
+    int count;
+    int capacity;
+} FileList;
+
+bool fileListAdd(FileList *L, const char *path);
+// Appends "<folder>/<name>" for every .txt file of folder, in directory order
+bool listAutomatonFiles(const char *folder, FileList *L);
+void freeFileList(FileList *L);
+
 bool resolveAutomatesPath(char *buffer, size_t size, FILE *logFile);
-void exportToDOT(const Automaton *A, const char *filename);
+bool exportToDOT(const Automaton *A, const char *filename);
+
+// --- Mapped Files ---
+// Read-only view of a whole file: mmap'ed where available, otherwise (or for
+// pipes and empty files) read into memory. `sequential` hints a single
+// front-to-back pass (aggressive read-ahead).
+typedef struct {
+    const char *data;
+    size_t size;
+    bool mapped;
+} MappedFile;
+
+bool mapFile(const char *filename, MappedFile *F, bool sequential);
+void unmapFile(MappedFile *F);
+
+// --- Binary Frozen DFA ---
+// Versioned on-disk image of a DenseDFA (table, accept bitmap, alphabet,
+// checksum). Loading maps the file and points the DFA straight into it: no
+// parsing, no copy. `verify` also checks the checksum and every table entry
+// (O(size)); without it only the header is validated.
+bool saveDenseDFA(const DenseDFA *D, const char *filename, FILE *logFile);
+bool loadDenseDFA(const char *filename, DenseDFA *D, bool verify, FILE *logFile);
+bool isDenseDFAFile(const char *filename);
+
+// --- Binary Automaton ---
+// Checksummed CSR image of any automaton; loading validates and copies it.
+bool saveAutomatonBinary(const Automaton *A, const char *filename, FILE *logFile);
+bool loadAutomatonBinary(const char *filename, Automaton *A, FILE *logFile);
 
 #endif // AUTOMATE_IO_H
\ No newline at end of file
@@ -0,0 +1,522 @@
+#include "AutomateIncremental.h"
+#include "AutomateAnalysis.h"
+#include "AutomateIO.h"
+#include "AutomateSet.h"
+#include "AutomateStats.h"
+#include "AutomateTransform.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define PENDING (-2)        // Class of an affected state not re-classified yet
+#define SLOT_EMPTY (-1)
+#define SLOT_REMOVED (-2)
+
+// --- Storage ---
+
+static bool growArray(void **array, size_t count, size_t size) {
+    void *temp = realloc(*array, (count > 0 ? count : 1) * size);
+    if (!temp) return false;
+    *array = temp;
+    return true;
+}
+
+static bool growStates(IncrementalDFA *D, int needed) {
+    if (needed <= D->capacity) return true;
+    int new_capacity = D->capacity ? D->capacity : 16;
+    while (new_capacity < needed) new_capacity *= 2;
+    size_t cells = (size_t)new_capacity * D->num_symbols;
+    bool ok = growArray((void **)&D->trans, cells, sizeof(int)) &&
+              growArray((void **)&D->pred_next, cells, sizeof(int)) &&
+              growArray((void **)&D->pred_prev, cells, sizeof(int)) &&
+              growArray((void **)&D->final, new_capacity, sizeof(bool)) &&
+              growArray((void **)&D->pred_head, new_capacity, sizeof(int)) &&
+              growArray((void **)&D->class_of, new_capacity, sizeof(int)) &&
+              growArray((void **)&D->class_size, new_capacity, sizeof(int)) &&
+              growArray((void **)&D->free_classes, new_capacity, sizeof(int)) &&
+              growArray((void **)&D->signatures, cells + new_capacity, sizeof(int)) &&
+              growArray((void **)&D->state_mark, new_capacity, sizeof(int)) &&
+              growArray((void **)&D->state_node, new_capacity, sizeof(int));
+    if (!ok) return false;
+    // Marks start below every epoch
+    memset(D->state_mark + D->capacity, 0, (new_capacity - D->capacity) * sizeof(int));
+    D->capacity = new_capacity;
+    return true;
+}
+
+bool incrementalInit(IncrementalDFA *D, const Alphabet *alphabet, int num_symbols) {
+    memset(D, 0, sizeof(IncrementalDFA));
+    D->num_symbols = num_symbols;
+    D->alphabet = *alphabet;
+    if (incrementalAddState(D, false) < 0) {
+        incrementalFree(D);
+        return false;
+    }
+    return true;
+}
+
+void incrementalFree(IncrementalDFA *D) {
+    free(D->trans);
+    free(D->pred_next);
+    free(D->pred_prev);
+    free(D->final);
+    free(D->pred_head);
+    free(D->class_of);
+    free(D->class_size);
+    free(D->free_classes);
+    free(D->signatures);
+    free(D->slots);
+    free(D->state_mark);
+    free(D->state_node);
+    memset(D, 0, sizeof(IncrementalDFA));
+}
+
+// --- Register ---
+// Signature of a state: its final flag, then the class of each successor
+// (INCREMENTAL_DEAD for none). Two states are equivalent exactly when their
+// signatures are equal, once the classes of their successors are exact.
+
+static int *signatureOf(const IncrementalDFA *D, int c) {
+    return D->signatures + (size_t)c * (D->num_symbols + 1);
+}
+
+static size_t signatureSize(const IncrementalDFA *D) {
+    return (D->num_symbols + 1) * sizeof(int);
+}
+
+static void stateSignature(const IncrementalDFA *D, int state, int *sig) {
+    int k = D->num_symbols;
+    sig[0] = D->final[state];
+    for (int sym = 0; sym < k; sym++) {
+        int to = D->trans[(size_t)state * k + sym];
+        sig[sym + 1] = to >= 0 ? D->class_of[to] : INCREMENTAL_DEAD;
+    }
+}
+
+static bool deadSignature(const IncrementalDFA *D, const int *sig) {
+    if (sig[0]) return false;
+    for (int sym = 0; sym < D->num_symbols; sym++) {
+        if (sig[sym + 1] != INCREMENTAL_DEAD) return false;
+    }
+    return true;
+}
+
+static int registerFind(const IncrementalDFA *D, const int *sig) {
+    if (D->num_slots == 0) return -1;
+    int mask = D->num_slots - 1;
+    for (int i = (int)(hashBytes(sig, signatureSize(D)) & mask); D->slots[i] != SLOT_EMPTY; i = (i + 1) & mask) {
+        int c = D->slots[i];
+        if (c >= 0 && memcmp(signatureOf(D, c), sig, signatureSize(D)) == 0) return c;
+    }
+    return -1;
+}
+
+static void registerPlace(IncrementalDFA *D, int c) {
+    int mask = D->num_slots - 1;
+    int i = (int)(hashBytes(signatureOf(D, c), signatureSize(D)) & mask);
+    while (D->slots[i] >= 0) i = (i + 1) & mask;
+    if (D->slots[i] == SLOT_EMPTY) D->used_slots++;
+    D->slots[i] = c;
+}
+
+// Stores the signature of class c and registers it
+static bool registerClass(IncrementalDFA *D, int c, const int *sig) {
+    memcpy(signatureOf(D, c), sig, signatureSize(D));
+    if ((D->used_slots + 1) * 2 > D->num_slots) {
+        // Rebuilt at a quarter full at most, dropping the removed slots
+        int num_slots = 16;
+        while (num_slots < 4 * (D->num_classes + 1)) num_slots *= 2;
+        int *old = D->slots, old_count = D->num_slots;
+        D->slots = malloc(num_slots * sizeof(int));
+        if (!D->slots) {
+            D->slots = old;
+            return false;
+        }
+        for (int i = 0; i < num_slots; i++) D->slots[i] = SLOT_EMPTY;
+        D->num_slots = num_slots;
+        D->used_slots = 0;
+        for (int i = 0; i < old_count; i++) {
+            if (old[i] >= 0) registerPlace(D, old[i]);
+        }
+        free(old);
+    }
+    registerPlace(D, c);
+    return true;
+}
+
+static void registerRemove(IncrementalDFA *D, int c) {
+    int mask = D->num_slots - 1;
+    int i = (int)(hashBytes(signatureOf(D, c), signatureSize(D)) & mask);
+    while (D->slots[i] != c) i = (i + 1) & mask;
+    D->slots[i] = SLOT_REMOVED;
+}
+
+// --- Classes ---
+
+// New class id, with no state and no signature yet
+static int allocClass(IncrementalDFA *D) {
+    int id = D->num_free > 0 ? D->free_classes[--D->num_free] : D->next_class++;
+    D->class_size[id] = 0;
+    D->num_classes++;
+    return id;
+}
+
+static void joinClass(IncrementalDFA *D, int state, int c) {
+    D->class_of[state] = c;
+    if (c != INCREMENTAL_DEAD) D->class_size[c]++;
+}
+
+// The state becomes PENDING; a class left empty is unregistered and freed
+static void leaveClass(IncrementalDFA *D, int state) {
+    int c = D->class_of[state];
+    D->class_of[state] = PENDING;
+    if (c == INCREMENTAL_DEAD || --D->class_size[c] > 0) return;
+    registerRemove(D, c);
+    D->free_classes[D->num_free++] = c;
+    D->num_classes--;
+}
+
+// A pending state whose successors all have their classes
+static bool classifyState(IncrementalDFA *D, int state, int *sig) {
+    stateSignature(D, state, sig);
+    int c = INCREMENTAL_DEAD;
+    if (!deadSignature(D, sig)) {
+        c = registerFind(D, sig);
+        if (c < 0) {
+            c = allocClass(D);
+            if (!registerClass(D, c, sig)) return false;
+        }
+    }
+    joinClass(D, state, c);
+    return true;
+}
+
+// Pending states that may reach one another (their other successors have
+// their classes), classified by partition refinement over them, one node per
+// class (a member stands for it) and a dead node looping on every symbol.
+// The table is complete, so the blocks are exact classes: a block holding
+// the dead node is the dead class, one holding a class node is that class,
+// any other is a new class.
+static bool refineStates(IncrementalDFA *D, const int *states, int count, int *sig) {
+    int n = D->num_states, k = D->num_symbols;
+    int num_nodes = 1 + count + D->num_classes;
+    int *node_of = malloc((n > 0 ? n : 1) * sizeof(int));                          // Pending state -> node
+    int *class_node = malloc((D->next_class > 0 ? D->next_class : 1) * sizeof(int));
+    int *node_state = malloc(num_nodes * sizeof(int));                              // Node -> state
+    int *table = malloc(((size_t)num_nodes * k > 0 ? (size_t)num_nodes * k : 1) * sizeof(int));
+    bool *isFinal = malloc(num_nodes * sizeof(bool));
+    int *block = malloc(num_nodes * sizeof(int));
+    int *block_class = malloc(num_nodes * sizeof(int));
+    int num_blocks;
+    bool ok = node_of && class_node && node_state && table && isFinal && block && block_class;
+    if (!ok) goto cleanup;
+
+    for (int i = 0; i < count; i++) {
+        node_of[states[i]] = i + 1;
+        node_state[i + 1] = states[i];
+    }
+    int nodes = count + 1;
+    for (int c = 0; c < D->next_class; c++) class_node[c] = -1;
+    for (int s = 0; s < n; s++) {
+        int c = D->class_of[s];
+        if (c >= 0 && class_node[c] == -1) {
+            class_node[c] = nodes;
+            node_state[nodes++] = s;
+        }
+    }
+
+    for (int sym = 0; sym < k; sym++) table[sym] = 0;
+    isFinal[0] = false;
+    for (int i = 1; i < nodes; i++) {
+        int s = node_state[i];
+        for (int sym = 0; sym < k; sym++) {
+            int to = D->trans[(size_t)s * k + sym];
+            int c = to >= 0 ? D->class_of[to] : INCREMENTAL_DEAD;
+            table[(size_t)i * k + sym] = c == PENDING ? node_of[to] : c == INCREMENTAL_DEAD ? 0 : class_node[c];
+        }
+        isFinal[i] = D->final[s];
+    }
+    ok = coarsestPartition(nodes, k, table, isFinal, block, &num_blocks);
+    if (!ok) goto cleanup;
+
+    for (int b = 0; b < num_blocks; b++) block_class[b] = PENDING;
+    block_class[block[0]] = INCREMENTAL_DEAD;
+    for (int i = count + 1; i < nodes; i++) block_class[block[i]] = D->class_of[node_state[i]];
+    // New classes are registered once every state has its class, as their
+    // signatures may name one another
+    int first_new = nodes;
+    for (int i = 1; i <= count; i++) {
+        int b = block[i];
+        if (block_class[b] == PENDING) {
+            block_class[b] = allocClass(D);
+            node_state[--first_new] = states[i - 1];
+        }
+        joinClass(D, states[i - 1], block_class[b]);
+    }
+    for (int i = first_new; i < nodes && ok; i++) {
+        stateSignature(D, node_state[i], sig);
+        ok = registerClass(D, D->class_of[node_state[i]], sig);
+    }
+
+cleanup:
+    free(node_of);
+    free(class_node);
+    free(node_state);
+    free(table);
+    free(isFinal);
+    free(block);
+    free(block_class);
+    return ok;
+}
+
+bool incrementalInitFrom(IncrementalDFA *D, const Automaton *A, FILE *logFile) {
+    if (!isDeterministic(A, logFile)) {
+        logAt(LOG_ERROR, logFile, "Erreur : la minimisation incrementale demande un automate deterministe\n");
+        return false;
+    }
+    int n = A->num_states, k = A->num_symbols;
+    memset(D, 0, sizeof(IncrementalDFA));
+    D->num_symbols = k;
+    D->alphabet = A->alphabet;
+    if (!growStates(D, n)) {
+        incrementalFree(D);
+        return false;
+    }
+    D->num_states = n;
+    D->initial = A->initials[0];
+    for (int s = 0; s < n; s++) {
+        D->final[s] = false;
+        D->pred_head[s] = -1;
+        D->class_of[s] = PENDING;
+    }
+    for (int i = 0; i < A->num_finals; i++) D->final[A->finals[i]] = true;
+    for (int cell = 0; cell < n * k; cell++) {
+        int count;
+        const int *dests = cellTransitions(A, cell, &count);
+        int to = count > 0 ? dests[0] : -1;
+        D->trans[cell] = to;
+        if (to < 0) continue;
+        D->pred_prev[cell] = -1;
+        D->pred_next[cell] = D->pred_head[to];
+        if (D->pred_head[to] != -1) D->pred_prev[D->pred_head[to]] = cell;
+        D->pred_head[to] = cell;
+    }
+
+    // No class yet: one refinement of the whole DFA
+    STATS_START(timer);
+    int *states = malloc(n * sizeof(int));
+    int *sig = malloc((k + 1) * sizeof(int));
+    bool ok = states && sig;
+    if (ok) {
+        for (int s = 0; s < n; s++) states[s] = s;
+        ok = refineStates(D, states, n, sig);
+    }
+    free(states);
+    free(sig);
+    STATS_END(PHASE_MINIMIZE_INCREMENTAL, timer);
+    if (!ok) incrementalFree(D);
+    return ok;
+}
+
+// --- Updates ---
+
+// Re-classifies `changed` and every state that reaches it, by strongly
+// connected component in Tarjan's order (successors first)
+static bool reclassify(IncrementalDFA *D, int changed) {
+    STATS_START(timer);
+    int k = D->num_symbols;
+    D->epoch++;
+    int *affected = malloc(D->num_states * sizeof(int));
+    if (!affected) return false;
+
+    // Affected states, backwards from `changed`
+    int count = 0;
+    D->state_mark[changed] = D->epoch;
+    D->state_node[changed] = count;
+    affected[count++] = changed;
+    for (int i = 0; i < count; i++) {
+        for (int cell = D->pred_head[affected[i]]; cell != -1; cell = D->pred_next[cell]) {
+            int from = cell / k;
+            if (D->state_mark[from] == D->epoch) continue;
+            D->state_mark[from] = D->epoch;
+            D->state_node[from] = count;
+            affected[count++] = from;
+        }
+    }
+    // Classes left with affected states only have stale signatures: leave
+    // them all before any lookup
+    for (int i = 0; i < count; i++) leaveClass(D, affected[i]);
+
+    bool ok = false;
+    int *index = malloc(count * sizeof(int));
+    int *low = malloc(count * sizeof(int));
+    int *stack = malloc(count * sizeof(int));       // Component search stack
+    int *calls = malloc(count * sizeof(int));       // Depth-first path
+    int *next_symbol = malloc(count * sizeof(int));
+    int *members = malloc(count * sizeof(int));
+    bool *on_stack = calloc(count, sizeof(bool));
+    int *sig = malloc((k + 1) * sizeof(int));
+    if (!index || !low || !stack || !calls || !next_symbol || !members || !on_stack || !sig) goto cleanup;
+
+    for (int v = 0; v < count; v++) index[v] = -1;
+    int counter = 0, top = 0;
+    for (int root = 0; root < count; root++) {
+        if (index[root] != -1) continue;
+        int depth = 0;
+        calls[depth++] = root;
+        next_symbol[root] = 0;
+        index[root] = low[root] = counter++;
+        stack[top++] = root;
+        on_stack[root] = true;
+        while (depth > 0) {
+            int v = calls[depth - 1];
+            if (next_symbol[v] < k) {
+                int to = D->trans[(size_t)affected[v] * k + next_symbol[v]++];
+                if (to < 0 || D->state_mark[to] != D->epoch) continue;
+                int w = D->state_node[to];
+                if (index[w] == -1) {
+                    index[w] = low[w] = counter++;
+                    next_symbol[w] = 0;
+                    stack[top++] = w;
+                    on_stack[w] = true;
+                    calls[depth++] = w;
+                } else if (on_stack[w] && index[w] < low[v]) {
+                    low[v] = index[w];
+                }
+                continue;
+            }
+            depth--;
+            if (depth > 0 && low[v] < low[calls[depth - 1]]) low[calls[depth - 1]] = low[v];
+            if (low[v] != index[v]) continue;
+
+            // v roots a component: its members are on top of the stack
+            int size = 0, w;
+            do {
+                w = stack[--top];
+                on_stack[w] = false;
+                members[size++] = affected[w];
+            } while (w != v);
+            bool cycle = size > 1;
+            for (int sym = 0; sym < k && !cycle; sym++) cycle = D->trans[(size_t)members[0] * k + sym] == members[0];
+            if (cycle) {
+                D->stats.refinements++;
+                if (!refineStates(D, members, size, sig)) goto cleanup;
+            } else if (!classifyState(D, members[0], sig)) {
+                goto cleanup;
+            }
+        }
+    }
+    D->stats.updates++;
+    D->stats.affected += count;
+    ok = true;
+
+cleanup:
+    free(affected);
+    free(index);
+    free(low);
+    free(stack);
+    free(calls);
+    free(next_symbol);
+    free(members);
+    free(on_stack);
+    free(sig);
+    STATS_END(PHASE_MINIMIZE_INCREMENTAL, timer);
+    return ok;
+}
+
+int incrementalAddState(IncrementalDFA *D, bool final) {
+    int s = D->num_states;
+    if (!growStates(D, s + 1)) return -1;
+    for (int sym = 0; sym < D->num_symbols; sym++) D->trans[(size_t)s * D->num_symbols + sym] = -1;
+    D->final[s] = false;
+    D->pred_head[s] = -1;
+    D->class_of[s] = INCREMENTAL_DEAD;
+    D->num_states++;
+    if (final && !incrementalSetFinal(D, s, true)) return -1;
+    return s;
+}
+
+bool incrementalSetFinal(IncrementalDFA *D, int state, bool final) {
+    if (state < 0 || state >= D->num_states) return false;
+    if (D->final[state] == final) return true;
+    D->final[state] = final;
+    return reclassify(D, state);
+}
+
+bool incrementalSetTransition(IncrementalDFA *D, int from, unsigned char letter, int to, FILE *logFile) {
+    int sym = D->alphabet.symbols[letter];
+    if (sym < 0 || sym >= D->num_symbols) {
+        logAt(LOG_ERROR, logFile, "Erreur : lettre hors de l'alphabet\n");
+        return false;
+    }
+    if (from < 0 || from >= D->num_states || to < -1 || to >= D->num_states) {
+        logAt(LOG_ERROR, logFile, "Erreur : etat invalide\n");
+        return false;
+    }
+    int cell = from * D->num_symbols + sym;
+    int old = D->trans[cell];
+    if (old == to) return true;
+    if (old >= 0) {
+        if (D->pred_prev[cell] != -1) D->pred_next[D->pred_prev[cell]] = D->pred_next[cell];
+        else D->pred_head[old] = D->pred_next[cell];
+        if (D->pred_next[cell] != -1) D->pred_prev[D->pred_next[cell]] = D->pred_prev[cell];
+    }
+    if (to >= 0) {
+        D->pred_prev[cell] = -1;
+        D->pred_next[cell] = D->pred_head[to];
+        if (D->pred_head[to] != -1) D->pred_prev[D->pred_head[to]] = cell;
+        D->pred_head[to] = cell;
+    }
+    D->trans[cell] = to;
+
+    // An equivalent target leaves every language as it was
+    int old_class = old >= 0 ? D->class_of[old] : INCREMENTAL_DEAD;
+    int new_class = to >= 0 ? D->class_of[to] : INCREMENTAL_DEAD;
+    return old_class == new_class || reclassify(D, from);
+}
+
+// --- Minimal DFA ---
+
+bool incrementalMinimal(const IncrementalDFA *D, Automaton *out) {
+    int k = D->num_symbols;
+    int size = D->num_classes > 0 ? D->num_classes : 1;
+    int *group = malloc((D->next_class > 0 ? D->next_class : 1) * sizeof(int));    // Class -> state of out
+    int *rep = malloc(size * sizeof(int));                                          // State of out -> member
+    int *trans = malloc(((size_t)size * k > 0 ? (size_t)size * k : 1) * sizeof(int));
+    bool ok = group && rep && trans;
+    int num_groups = 0;
+    if (ok) {
+        for (int c = 0; c < D->next_class; c++) group[c] = -1;
+        int start = D->class_of[D->initial];
+        if (start != INCREMENTAL_DEAD) {
+            group[start] = num_groups;
+            rep[num_groups++] = D->initial;
+        }
+        for (int g = 0; g < num_groups; g++) {
+            for (int sym = 0; sym < k; sym++) {
+                int to = D->trans[(size_t)rep[g] * k + sym];
+                int c = to >= 0 ? D->class_of[to] : INCREMENTAL_DEAD;
+                if (c != INCREMENTAL_DEAD && group[c] == -1) {
+                    group[c] = num_groups;
+                    rep[num_groups++] = to;
+                }
+                trans[(size_t)g * k + sym] = c != INCREMENTAL_DEAD ? group[c] : -1;
+            }
+        }
+        // Empty language: the one-state form trim() gives
+        if (num_groups == 0) {
+            for (int sym = 0; sym < k; sym++) trans[sym] = -1;
+        }
+        ok = createDeterministic(out, num_groups > 0 ? num_groups : 1, k, trans, 1);
+    }
+    if (ok) {
+        out->initials[0] = 0;
+        out->alphabet = D->alphabet;
+        for (int g = 0; g < num_groups; g++) {
+            if (D->final[rep[g]]) out->finals[out->num_finals++] = g;
+        }
+    }
+    free(group);
+    free(rep);
+    free(trans);
+    return ok;
+}
@@ -0,0 +1,98 @@
+#ifndef AUTOMATE_INCREMENTAL_H
+#define AUTOMATE_INCREMENTAL_H
+
+#include "AutomateCore.h"
+#include <stdio.h>
+
+// --- Incremental Minimization ---
+// A DFA edited one state, final flag or transition at a time, whose
+// Myhill-Nerode classes (states with the same language) are kept up to
+// date, so the minimal DFA can be read back after any edit without
+// minimizing from scratch.
+//
+// An edit on state p changes the language of p and of the states that
+// reach p (the affected states), and of no other: the other states keep
+// their classes. The affected states are re-classified by strongly
+// connected component, successors first (Tarjan's order), so the classes
+// of their successors are always known:
+// - A state on no cycle has the class of its signature (final flag and
+//   class of each successor), found in a hash register of the signatures of
+//   all classes, or a new class.
+// - The states of a cycle are re-classified together, by the partition
+//   refinement of minimize() run over them and one node per class.
+// An edit that changes no language (a transition to a state equivalent to
+// the old target, as to a new state without transitions) costs O(1). So
+// does any other edit not counting its affected states, as long as they form
+// no cycle: adding words or rules to a dictionary never re-minimizes it.
+//
+// Transitions are partial: a missing one leads to the empty language, and
+// the states whose language is empty share the INCREMENTAL_DEAD class. The
+// minimal DFA read back is trim, as trim() then minimize() would give.
+
+#define INCREMENTAL_DEAD (-1)
+
+typedef struct {
+    long long updates;      // Edits that changed a language
+    long long affected;     // States re-classified, summed over updates
+    long long refinements;  // Cycles re-classified by partition refinement
+} IncrementalStats;
+
+typedef struct {
+    int num_states;
+    int num_symbols;
+    Alphabet alphabet;
+    int initial;
+    int capacity;           // States allocated
+    int *trans;             // trans[state * num_symbols + symbol], -1 = none
+    bool *final;
+
+    // Predecessors of each state, as a doubly linked list of cells (a cell
+    // holds at most one transition, so it is its own list node)
+    int *pred_head;         // Per state, first cell leading to it, -1 = none
+    int *pred_next;         // Per cell
+    int *pred_prev;
+
+    // Class ids live below next_class (at most one per state), and are
+    // reused once their last state leaves them
+    int *class_of;          // Per state, class id or INCREMENTAL_DEAD
+    int num_classes;        // Live classes, the dead one excluded
+    int next_class;
+    int *class_size;        // Per class id, 0 = free
+    int *free_classes;      // Stack of free class ids
+    int num_free;
+
+    // Register: open addressing over class ids, keyed by their signatures
+    int *signatures;        // Per class id, final flag then num_symbols classes
+    int *slots;             // Class id, -1 = empty, -2 = removed
+    int num_slots;          // Power of two
+    int used_slots;         // Live and removed
+
+    // Affected states: marks are valid when equal to the current epoch
+    int epoch;
+    int *state_mark;
+    int *state_node;        // Affected state -> position in the component search
+
+    IncrementalStats stats;
+} IncrementalDFA;
+
+// One initial, non-final state and no transition
+bool incrementalInit(IncrementalDFA *D, const Alphabet *alphabet, int num_symbols);
+// Starts from a DFA (one initial state, no epsilon transitions)
+bool incrementalInitFrom(IncrementalDFA *D, const Automaton *A, FILE *logFile);
+void incrementalFree(IncrementalDFA *D);
+
+// The edits below return false on bad arguments, or when out of memory (D
+// can then only be freed)
+
+// New state, with no transition: -1 when out of memory
+int incrementalAddState(IncrementalDFA *D, bool final);
+bool incrementalSetFinal(IncrementalDFA *D, int state, bool final);
+// Sets the transition from `from` on `letter` (a byte of the alphabet),
+// replacing the previous one; to = -1 removes it
+bool incrementalSetTransition(IncrementalDFA *D, int from, unsigned char letter, int to, FILE *logFile);
+
+// The minimal DFA of the current language, states in breadth-first order
+// from the initial one
+bool incrementalMinimal(const IncrementalDFA *D, Automaton *out);
+
+#endif // AUTOMATE_INCREMENTAL_H
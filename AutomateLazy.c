@@ -0,0 +1,168 @@
+#include "AutomateLazy.h"
+#include "AutomateTransform.h"
+#include <stdlib.h>
+#include <string.h>
+
+// A flush that matched fewer characters than this per state it had built
+// counts as thrashing; LAZY_MAX_THRASH of them in a row give up the cache.
+#define LAZY_MIN_STEPS_PER_STATE 10
+#define LAZY_MAX_THRASH 3
+#define LAZY_FAILED (-3)
+
+// --- Cache ---
+
+// Estimated bytes held by one cached state: its key, the table's cached hash
+// and offset, about two hash buckets, its transition row and accept flag.
+static size_t stateCost(const LazyDFA *L, size_t key_size) {
+    return key_size + sizeof(uint64_t) + sizeof(size_t) + 2 * sizeof(int) +
+           (size_t)L->num_classes * sizeof(int) + 1;
+}
+
+// Out of memory for a new table, the cache is given up for good: later
+// words must not reach the freed one
+static bool resetCache(LazyDFA *L) {
+    subsetTableFree(&L->table);
+    L->memory_used = 0;
+    L->initial = -1;
+    L->steps_since_flush = 0;
+    if (subsetTableInit(&L->table, 64)) return true;
+    L->thrashing = true;
+    return false;
+}
+
+static bool flushCache(LazyDFA *L) {
+    L->stats.flushes++;
+    if (L->steps_since_flush < (long long)L->table.count * LAZY_MIN_STEPS_PER_STATE) {
+        if (++L->thrash_count >= LAZY_MAX_THRASH) L->thrashing = true;
+    } else {
+        L->thrash_count = 0;
+    }
+    return resetCache(L);
+}
+
+static bool growStates(LazyDFA *L, int needed) {
+    int new_capacity = L->capacity ? L->capacity : 64;
+    while (new_capacity < needed) new_capacity *= 2;
+    int *trans = realloc(L->trans, (size_t)new_capacity * L->num_classes * sizeof(int));
+    if (!trans) return false;
+    L->trans = trans;
+    uint8_t *accepting = realloc(L->accepting, new_capacity);
+    if (!accepting) return false;
+    L->accepting = accepting;
+    L->capacity = new_capacity;
+    return true;
+}
+
+// Interns the subset held in L->work, flushing the cache first if the new
+// state would exceed the memory cap. Returns its id or LAZY_FAILED.
+static int internWork(LazyDFA *L) {
+    size_t key_size = L->work.count * sizeof(int);
+    int id = subsetTableFind(&L->table, L->work.dense, key_size);
+    if (id >= 0) return id;
+
+    size_t cost = stateCost(L, key_size);
+    if (L->memory_used + cost > L->memory_limit && L->table.count > 0) {
+        if (!flushCache(L)) return LAZY_FAILED;
+    }
+    id = subsetTableInsert(&L->table, L->work.dense, key_size, NULL);
+    if (id < 0) return LAZY_FAILED;
+    if (id >= L->capacity && !growStates(L, id + 1)) return LAZY_FAILED;
+
+    // Classes of bytes outside the alphabet are dead from the start
+    int *row = L->trans + (size_t)id * L->num_classes;
+    for (int c = 0; c < L->num_classes; c++) row[c] = L->representatives[c] >= 0 ? LAZY_UNKNOWN : -1;
+    L->accepting[id] = subsetIsFinal(L->work.dense, L->work.count, &L->finals);
+    L->memory_used += cost;
+    return id;
+}
+
+static int startState(LazyDFA *L) {
+    if (L->initial >= 0) return L->initial;
+    subsetStart(L->A, &L->work);
+    if (L->work.count == 0) return -1;
+    int id = internWork(L);
+    if (id >= 0) L->initial = id;
+    return id;
+}
+
+// --- Lifecycle ---
+
+bool lazyDFAInit(LazyDFA *L, const Automaton *A, size_t memory_limit) {
+    memset(L, 0, sizeof(LazyDFA));
+    L->A = A;
+    L->memory_limit = memory_limit > 0 ? memory_limit : LAZY_DEFAULT_MEMORY;
+    L->initial = -1;
+    L->num_classes = byteClasses(A, L->classes, L->representatives);
+    if (!subsetTableInit(&L->table, 64) || !sparseSetInit(&L->work, A->num_states) ||
+        !bitsetInit(&L->finals, A->num_states) || !nfaSimInit(&L->sim, A)) {
+        lazyDFAFree(L);
+        return false;
+    }
+    for (int i = 0; i < A->num_finals; i++) bitsetAdd(&L->finals, A->finals[i]);
+    return true;
+}
+
+void lazyDFAFree(LazyDFA *L) {
+    if (!L) return;
+    subsetTableFree(&L->table);
+    free(L->trans);
+    free(L->accepting);
+    sparseSetFree(&L->work);
+    bitsetFree(&L->finals);
+    nfaSimFree(&L->sim);
+    L->trans = NULL;
+    L->accepting = NULL;
+    L->capacity = 0;
+}
+
+int lazyDFACachedStates(const LazyDFA *L) {
+    return L->table.count;
+}
+
+// --- Matching ---
+
+bool lazyDFAAccepts(LazyDFA *L, const char *word) {
+    if (L->thrashing) goto fallback;
+
+    const Automaton *A = L->A;
+    int columns = L->num_classes;
+    int state = startState(L);
+    if (state == LAZY_FAILED) goto fallback;
+
+    for (const unsigned char *p = (const unsigned char *)word; *p; p++) {
+        if (state < 0) return false;
+        int column = L->classes[*p];
+
+        L->steps_since_flush++;
+        int next = L->trans[(size_t)state * columns + column];
+        if (next != LAZY_UNKNOWN) {
+            L->stats.hits++;
+            state = next;
+            continue;
+        }
+
+        L->stats.misses++;
+        size_t size;
+        const int *states = subsetTableKey(&L->table, state, &size);
+        subsetStep(A, states, (int)(size / sizeof(int)), L->representatives[column], &L->work);
+        if (L->work.count == 0) {
+            next = -1;
+        } else {
+            long long flushes = L->stats.flushes;
+            next = internWork(L);
+            if (next == LAZY_FAILED) goto fallback;
+            // A flush dropped the current state's row: just move on
+            if (L->stats.flushes != flushes) {
+                state = next;
+                continue;
+            }
+        }
+        L->trans[(size_t)state * columns + column] = next;
+        state = next;
+    }
+    return state >= 0 && L->accepting[state];
+
+fallback:
+    L->stats.nfa_words++;
+    return nfaSimAccepts(&L->sim, word);
+}
@@ -0,0 +1,60 @@
+#ifndef AUTOMATE_LAZY_H
+#define AUTOMATE_LAZY_H
+
+#include "AutomateAnalysis.h"
+#include "AutomateSet.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Lazy DFA ---
+// Builds DFA states from the NFA only when input reaches them (subset
+// construction one transition at a time, as in determinize()). Built states
+// and transitions are cached up to a memory cap; when the cap is hit the
+// whole cache is flushed and rebuilt from the current state. If flushes come
+// too often (little input matched per cached state), the cache is thrashing
+// and words are matched by plain NFA simulation instead.
+
+#define LAZY_DEFAULT_MEMORY ((size_t)8 << 20)
+#define LAZY_UNKNOWN (-2)   // Transition not computed yet (-1 = dead)
+
+typedef struct {
+    long long hits;         // Transitions found in the cache
+    long long misses;       // Transitions computed from the NFA
+    long long flushes;      // Cache resets on hitting the memory cap
+    long long nfa_words;    // Words matched by the NFA fallback
+} LazyStats;
+
+typedef struct {
+    const Automaton *A;
+    size_t memory_limit;
+    size_t memory_used;     // Estimated bytes held by cached states
+
+    SubsetTable table;      // Subset -> cached state id
+    // Rows are indexed by byte class (see byteClasses()), not by symbol
+    int num_classes;
+    uint8_t classes[ALPHABET_MAX];
+    int representatives[ALPHABET_MAX];
+    int *trans;             // trans[id * num_classes + class]: target id, -1 or LAZY_UNKNOWN
+    uint8_t *accepting;
+    int capacity;           // States allocated in trans / accepting
+    int initial;            // Cached id of the initial subset, -1 when flushed
+
+    SparseSet work;
+    Bitset finals;
+    NFASimulator sim;
+
+    long long steps_since_flush;
+    int thrash_count;       // Consecutive flushes that made little progress
+    bool thrashing;         // Cache given up (or out of memory): NFA simulation only
+
+    LazyStats stats;
+} LazyDFA;
+
+// memory_limit = 0 selects LAZY_DEFAULT_MEMORY. The automaton must outlive L.
+bool lazyDFAInit(LazyDFA *L, const Automaton *A, size_t memory_limit);
+void lazyDFAFree(LazyDFA *L);
+
+bool lazyDFAAccepts(LazyDFA *L, const char *word);
+int lazyDFACachedStates(const LazyDFA *L);
+
+#endif // AUTOMATE_LAZY_H
@@ -0,0 +1,366 @@
+#include "AutomateLog.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef AUTOMATE_HAVE_THREADS
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#endif
+
+typedef struct {
+    LogLevel level;
+    bool console;
+    FILE *file;         // Bound log file, NULL when unbound
+    char *buffer;       // Messages not yet handed over to the file
+    size_t used;
+    size_t capacity;
+#ifdef AUTOMATE_HAVE_THREADS
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    bool async;
+    bool stop;
+    pthread_t writer;
+    char *spare;        // Second buffer, swapped with `buffer` at each hand-over
+    char *pending;      // Buffer being written by the writer thread, NULL when idle
+    size_t pending_size;
+#endif
+} Logger;
+
+static Logger logger = {
+    .level = LOG_INFO,
+    .console = true,
+#ifdef AUTOMATE_HAVE_THREADS
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .changed = PTHREAD_COND_INITIALIZER,
+#endif
+};
+
+#ifdef AUTOMATE_HAVE_THREADS
+#define LOCK() pthread_mutex_lock(&logger.lock)
+#define UNLOCK() pthread_mutex_unlock(&logger.lock)
+#else
+#define LOCK() ((void)0)
+#define UNLOCK() ((void)0)
+#endif
+
+static void writeOut(const char *data, size_t size) {
+    fwrite(data, 1, size, logger.file);
+    fflush(logger.file);
+}
+
+// --- Buffer Hand-over (lock held) ---
+
+#ifdef AUTOMATE_HAVE_THREADS
+static void waitWriterIdle(void) {
+    while (logger.pending) pthread_cond_wait(&logger.changed, &logger.lock);
+}
+#endif
+
+// Sends the gathered messages to the file: directly, or through the writer
+// thread, which gets the full buffer while logging goes on in the spare one.
+static void handOver(void) {
+    if (logger.used == 0) return;
+#ifdef AUTOMATE_HAVE_THREADS
+    if (logger.async) {
+        waitWriterIdle();
+        logger.pending = logger.buffer;
+        logger.pending_size = logger.used;
+        logger.buffer = logger.spare;
+        logger.spare = NULL;
+        logger.used = 0;
+        pthread_cond_broadcast(&logger.changed);
+        return;
+    }
+#endif
+    writeOut(logger.buffer, logger.used);
+    logger.used = 0;
+}
+
+static void append(const char *message, size_t size) {
+    if (logger.used + size > logger.capacity) handOver();
+    if (size > logger.capacity) {
+        // Larger than the whole buffer: write it in place, after what precedes it
+#ifdef AUTOMATE_HAVE_THREADS
+        waitWriterIdle();
+#endif
+        writeOut(message, size);
+        return;
+    }
+    memcpy(logger.buffer + logger.used, message, size);
+    logger.used += size;
+}
+
+// --- Writer Thread ---
+
+#ifdef AUTOMATE_HAVE_THREADS
+static void *writerLoop(void *arg) {
+    (void)arg;
+    LOCK();
+    while (true) {
+        if (!logger.pending) {
+            if (logger.stop) break;
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += (long)LOG_ASYNC_INTERVAL_MS * 1000000L;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+            deadline.tv_nsec %= 1000000000L;
+            int rc = 0;
+            while (!logger.pending && !logger.stop && rc != ETIMEDOUT)
+                rc = pthread_cond_timedwait(&logger.changed, &logger.lock, &deadline);
+            // Periodic flush: take whatever has been gathered meanwhile
+            if (!logger.pending && !logger.stop) handOver();
+            continue;
+        }
+        char *data = logger.pending;
+        size_t size = logger.pending_size;
+        UNLOCK();
+        writeOut(data, size);
+        LOCK();
+        logger.spare = data;
+        logger.pending = NULL;
+        pthread_cond_broadcast(&logger.changed);
+    }
+    UNLOCK();
+    return NULL;
+}
+#endif
+
+// --- Lifecycle ---
+
+void logDefaultOptions(LogOptions *O) {
+    O->level = LOG_INFO;
+    O->console = true;
+    O->async = false;
+    O->buffer_size = 0;
+}
+
+bool logOpen(FILE *logFile, const LogOptions *O) {
+    logClose();
+    logger.level = O->level;
+    logger.console = O->console;
+    if (!logFile) return true;
+
+    size_t capacity = O->buffer_size > 0 ? O->buffer_size : LOG_DEFAULT_BUFFER;
+    char *buffer = malloc(capacity);
+    if (!buffer) return false;
+
+    LOCK();
+    logger.file = logFile;
+    logger.buffer = buffer;
+    logger.capacity = capacity;
+    logger.used = 0;
+#ifdef AUTOMATE_HAVE_THREADS
+    logger.stop = false;
+    logger.pending = NULL;
+    logger.spare = O->async ? malloc(capacity) : NULL;
+    // Without a second buffer or a thread, stay synchronous
+    logger.async = logger.spare && pthread_create(&logger.writer, NULL, writerLoop, NULL) == 0;
+    if (!logger.async) {
+        free(logger.spare);
+        logger.spare = NULL;
+    }
+#endif
+    UNLOCK();
+    return true;
+}
+
+void logFlush(void) {
+    LOCK();
+    if (logger.file) {
+        handOver();
+#ifdef AUTOMATE_HAVE_THREADS
+        waitWriterIdle();
+#endif
+    }
+    UNLOCK();
+}
+
+void logClose(void) {
+    LOCK();
+    if (!logger.file) {
+        UNLOCK();
+        return;
+    }
+    handOver();
+#ifdef AUTOMATE_HAVE_THREADS
+    if (logger.async) {
+        logger.stop = true;
+        pthread_cond_broadcast(&logger.changed);
+        UNLOCK();
+        pthread_join(logger.writer, NULL);
+        LOCK();
+        logger.async = false;
+    }
+    free(logger.spare);
+    logger.spare = NULL;
+#endif
+    free(logger.buffer);
+    logger.buffer = NULL;
+    logger.capacity = 0;
+    logger.file = NULL;
+    UNLOCK();
+}
+
+// --- Levels ---
+
+void logSetLevel(LogLevel level) {
+    logger.level = level;
+}
+
+bool logEnabled(LogLevel level) {
+    return level <= logger.level;
+}
+
+bool logParseLevel(const char *name, LogLevel *level) {
+    static const char *names[] = { "quiet", "error", "info", "debug" };
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            *level = (LogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// --- Captures ---
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+enum {
+    RECORD_MESSAGE,     // Console and log file
+    RECORD_CONSOLE,     // Message logged without a log file
+    RECORD_OUTPUT       // Program output (stdout only)
+};
+
+static THREAD_LOCAL LogCapture *capture;
+
+void logCaptureBegin(LogCapture *C) {
+    memset(C, 0, sizeof(LogCapture));
+    capture = C;
+}
+
+void logCaptureEnd(void) {
+    capture = NULL;
+}
+
+static bool reserve(LogCapture *C, size_t needed) {
+    if (needed <= C->capacity) return true;
+    size_t capacity = C->capacity ? C->capacity : 4096;
+    while (capacity < needed) capacity *= 2;
+    char *data = realloc(C->data, capacity);
+    if (!data) return false;
+    C->data = data;
+    C->capacity = capacity;
+    return true;
+}
+
+static bool record(int kind, const char *text, size_t size) {
+    LogCapture *C = capture;
+    if (C->size > 0 && C->data[C->last] == (char)kind) {
+        if (!reserve(C, C->size + size)) return false;
+        size_t length;
+        memcpy(&length, C->data + C->last + 1, sizeof(size_t));
+        length += size;
+        memcpy(C->data + C->last + 1, &length, sizeof(size_t));
+    } else {
+        if (!reserve(C, C->size + 1 + sizeof(size_t) + size)) return false;
+        C->last = C->size;
+        C->data[C->size] = (char)kind;
+        memcpy(C->data + C->size + 1, &size, sizeof(size_t));
+        C->size += 1 + sizeof(size_t);
+    }
+    memcpy(C->data + C->size, text, size);
+    C->size += size;
+    return true;
+}
+
+// --- Messages ---
+
+static void deliver(FILE *logFile, const char *message, size_t size) {
+    if (logger.console) fwrite(message, 1, size, stdout);
+    if (logFile) {
+        LOCK();
+        if (logFile == logger.file) {
+            append(message, size);
+        } else {
+            fwrite(message, 1, size, logFile);
+            fflush(logFile);
+        }
+        UNLOCK();
+    }
+}
+
+// Formats, then records (capture, or stdout only when output) or delivers.
+// A record that does not fit in memory is written at once rather than lost.
+static void emit(FILE *logFile, bool output, const char *format, va_list args) {
+    char local[1024];
+    va_list copy;
+    va_copy(copy, args);
+    int n = vsnprintf(local, sizeof(local), format, args);
+    char *message = local;
+    if (n >= (int)sizeof(local)) {
+        message = malloc((size_t)n + 1);
+        if (message) vsnprintf(message, (size_t)n + 1, format, copy);
+        else {
+            message = local;
+            n = sizeof(local) - 1;
+        }
+    }
+    va_end(copy);
+    if (n <= 0) return;
+
+    int kind = output ? RECORD_OUTPUT : logFile ? RECORD_MESSAGE : RECORD_CONSOLE;
+    if (!capture || !record(kind, message, (size_t)n)) {
+        if (output) fwrite(message, 1, (size_t)n, stdout);
+        else deliver(logFile, message, (size_t)n);
+    }
+    if (message != local) free(message);
+}
+
+void logAt(LogLevel level, FILE *logFile, const char *format, ...) {
+    if (level > logger.level) return;
+    va_list args;
+    va_start(args, format);
+    emit(logFile, false, format, args);
+    va_end(args);
+}
+
+void logMessage(FILE *logFile, const char *format, ...) {
+    if (LOG_INFO > logger.level) return;
+    va_list args;
+    va_start(args, format);
+    emit(logFile, false, format, args);
+    va_end(args);
+}
+
+void logOutput(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    emit(NULL, true, format, args);
+    va_end(args);
+}
+
+void logOutputBytes(const char *data, size_t size) {
+    if (!capture || !record(RECORD_OUTPUT, data, size)) fwrite(data, 1, size, stdout);
+}
+
+void logReplay(LogCapture *C, FILE *logFile) {
+    size_t pos = 0;
+    while (pos < C->size) {
+        int kind = C->data[pos];
+        size_t size;
+        memcpy(&size, C->data + pos + 1, sizeof(size_t));
+        const char *text = C->data + pos + 1 + sizeof(size_t);
+        if (kind == RECORD_OUTPUT) fwrite(text, 1, size, stdout);
+        else deliver(kind == RECORD_MESSAGE ? logFile : NULL, text, size);
+        pos += 1 + sizeof(size_t) + size;
+    }
+    free(C->data);
+    memset(C, 0, sizeof(LogCapture));
+}
@@ -0,0 +1,77 @@
+#ifndef AUTOMATE_LOG_H
+#define AUTOMATE_LOG_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+// --- Logging ---
+// Every message is echoed to stdout and appended to a log file. Messages
+// below the current level cost one comparison. Once logOpen() has bound a
+// log file, messages for it are formatted once and gathered in a large
+// in-memory buffer. That buffer is written out when full, on logFlush() and
+// on logClose(), instead of one fflush per message. In async mode a
+// background thread does the writes and also flushes every
+// LOG_ASYNC_INTERVAL_MS, so the file trails the program by at most that
+// long. Without logOpen() (or for another FILE), messages go straight to
+// the file and are flushed one by one, as before.
+
+typedef enum {
+    LOG_QUIET,      // Nothing at all
+    LOG_ERROR,      // Errors only
+    LOG_INFO,       // Normal output (default)
+    LOG_DEBUG       // Everything, including full dumps of large automata
+} LogLevel;
+
+#define LOG_DEFAULT_BUFFER (1u << 20)
+#define LOG_ASYNC_INTERVAL_MS 200
+
+typedef struct {
+    LogLevel level;
+    bool console;       // Echo messages to stdout
+    bool async;         // Write the log file from a background thread (needs thread support)
+    size_t buffer_size; // Bytes gathered before a write, 0 for LOG_DEFAULT_BUFFER
+} LogOptions;
+
+void logDefaultOptions(LogOptions *O);
+// Applies the options and, when logFile is not NULL, binds it as the buffered log file
+bool logOpen(FILE *logFile, const LogOptions *O);
+// Writes out everything gathered so far and waits until it is in the file
+void logFlush(void);
+// Flushes, stops the writer thread and unbinds the file (which stays open)
+void logClose(void);
+
+void logSetLevel(LogLevel level);
+bool logEnabled(LogLevel level);
+// Parses "quiet", "error", "info" or "debug"
+bool logParseLevel(const char *name, LogLevel *level);
+
+void logAt(LogLevel level, FILE *logFile, const char *format, ...);
+// Same as logAt(LOG_INFO, ...)
+void logMessage(FILE *logFile, const char *format, ...);
+
+// --- Program Output ---
+// Results meant for stdout only: never written to the log file, whatever
+// the level. Captured like messages (below).
+void logOutput(const char *format, ...);
+void logOutputBytes(const char *data, size_t size);
+
+// --- Captures ---
+// While a capture is active on a thread, everything that thread logs or
+// outputs is recorded in memory instead of being written. logReplay() writes
+// it out later. Parallel workers capture one task each, and the captures are
+// replayed in task order, so the output reads as if the tasks had run one
+// after another.
+
+typedef struct {
+    char *data;         // Records: kind byte, size_t length, text
+    size_t size;
+    size_t capacity;
+    size_t last;        // Offset of the last record, extended by records of the same kind
+} LogCapture;
+
+void logCaptureBegin(LogCapture *C);
+void logCaptureEnd(void);
+// Writes the recorded messages (to stdout and logFile) and output, then frees C
+void logReplay(LogCapture *C, FILE *logFile);
+
+#endif // AUTOMATE_LOG_H
@@ -0,0 +1,272 @@
+#include "AutomateMatch.h"
+#include "AutomateStats.h"
+#include "AutomateThreads.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define STREAM_BLOCK_SIZE ((size_t)1 << 20)
+#define PARALLEL_BLOCK_SIZE ((size_t)64 << 20)
+#define PARALLEL_MIN_CHUNK ((size_t)256 << 10)
+#define PARALLEL_CHUNKS_PER_THREAD 4
+
+// --- Matcher Construction ---
+
+bool buildBatchMatcher(const DenseDFA *D, BatchMatcher *M) {
+    memset(M, 0, sizeof(BatchMatcher));
+    // Premultiplied rows must fit the int32 table, dead state included
+    if (((int64_t)D->num_states + 1) * D->num_classes > INT32_MAX) return false;
+    M->num_states = D->num_states + 1;
+    M->num_columns = D->num_classes;
+    M->dead = D->num_states * M->num_columns;
+    M->initial = D->initial >= 0 ? D->initial * M->num_columns : M->dead;
+    memcpy(M->column_of, D->classes, sizeof(M->column_of));
+
+    M->table = malloc((size_t)M->num_states * M->num_columns * sizeof(int32_t));
+    M->accepting = calloc(M->num_states, sizeof(uint8_t));
+    if (!M->table || !M->accepting) {
+        freeBatchMatcher(M);
+        return false;
+    }
+    for (int s = 0; s < M->num_states; s++) {
+        int32_t *row = M->table + (size_t)s * M->num_columns;
+        for (int c = 0; c < M->num_columns; c++) {
+            int next = s < D->num_states ? dfaNextClass(D, s, c) : -1;
+            row[c] = next >= 0 ? next * M->num_columns : M->dead;
+        }
+        M->accepting[s] = s < D->num_states && dfaIsAccepting(D, s);
+    }
+    return true;
+}
+
+void freeBatchMatcher(BatchMatcher *M) {
+    if (!M) return;
+    free(M->table);
+    free(M->accepting);
+    M->table = NULL;
+    M->accepting = NULL;
+}
+
+// --- Results ---
+
+void initBatchResult(BatchResult *R, bool want_bitmap) {
+    memset(R, 0, sizeof(BatchResult));
+    R->want_bitmap = want_bitmap;
+}
+
+void freeBatchResult(BatchResult *R) {
+    if (!R) return;
+    free(R->bitmap);
+    R->bitmap = NULL;
+    R->bitmap_words = 0;
+}
+
+// Makes room for bits [0, num_bits) in the bitmap; new words are zero.
+static bool reserveBits(BatchResult *R, long long num_bits) {
+    size_t needed = (size_t)((num_bits + 63) >> 6);
+    if (needed <= R->bitmap_words) return true;
+    size_t new_words = R->bitmap_words ? R->bitmap_words * 2 : 1024;
+    while (new_words < needed) new_words *= 2;
+    uint64_t *temp = realloc(R->bitmap, new_words * sizeof(uint64_t));
+    if (!temp) return false;
+    memset(temp + R->bitmap_words, 0, (new_words - R->bitmap_words) * sizeof(uint64_t));
+    R->bitmap = temp;
+    R->bitmap_words = new_words;
+    return true;
+}
+
+static bool recordWord(BatchResult *R, bool accepted) {
+    long long i = R->num_words++;
+    R->num_accepted += accepted;
+    if (!R->want_bitmap) return true;
+
+    if (!reserveBits(R, i + 1)) return false;
+    if (accepted) R->bitmap[i >> 6] |= (uint64_t)1 << (i & 63);
+    return true;
+}
+
+// Appends the words of `part` after those already in R.
+static bool appendResult(BatchResult *R, const BatchResult *part) {
+    long long base = R->num_words;
+    if (R->want_bitmap && part->num_words > 0) {
+        if (!reserveBits(R, base + part->num_words)) return false;
+        int shift = (int)(base & 63);
+        uint64_t *dst = R->bitmap + (base >> 6);
+        size_t n = (size_t)((part->num_words + 63) >> 6);
+        for (size_t w = 0; w < n; w++) {
+            uint64_t bits = part->bitmap[w];
+            dst[w] |= bits << shift;
+            // Spill-over bits belong to words < base + num_words, so dst[w + 1] exists
+            if (shift && (bits >> (64 - shift))) dst[w + 1] |= bits >> (64 - shift);
+        }
+    }
+    R->num_words += part->num_words;
+    R->num_accepted += part->num_accepted;
+    return true;
+}
+
+// --- Matching ---
+
+typedef struct {
+    int state;
+    bool in_word;       // Bytes seen since the last newline
+    bool pending_cr;    // Block ended on '\r': drop it if a '\n' follows
+} MatchCursor;
+
+static inline int runBytes(const BatchMatcher *M, int state, const unsigned char *p, const unsigned char *end) {
+    const int32_t *table = M->table;
+    const uint8_t *column_of = M->column_of;
+    while (p < end) state = table[state + column_of[*p++]];
+    return state;
+}
+
+static bool matchChunk(const BatchMatcher *M, const unsigned char *p, const unsigned char *end,
+                       MatchCursor *cur, BatchResult *R) {
+    if (cur->pending_cr) {
+        cur->pending_cr = false;
+        if (p < end && *p != '\n') {
+            static const unsigned char cr = '\r';
+            cur->state = runBytes(M, cur->state, &cr, &cr + 1);
+        }
+    }
+    while (p < end) {
+        const unsigned char *nl = memchr(p, '\n', (size_t)(end - p));
+        const unsigned char *stop = nl ? nl : end;
+        const unsigned char *word_end = stop;
+        if (word_end > p && word_end[-1] == '\r') {
+            word_end--;
+            if (!nl) cur->pending_cr = true;
+        }
+        if (stop > p) cur->in_word = true;
+        cur->state = runBytes(M, cur->state, p, word_end);
+        if (!nl) break;
+
+        if (!recordWord(R, M->accepting[cur->state / M->num_columns])) return false;
+        cur->state = M->initial;
+        cur->in_word = false;
+        p = nl + 1;
+    }
+    return true;
+}
+
+static bool finishMatch(const BatchMatcher *M, MatchCursor *cur, BatchResult *R) {
+    if (!cur->in_word) return true;
+    return recordWord(R, M->accepting[cur->state / M->num_columns]);
+}
+
+bool matchBuffer(const BatchMatcher *M, const char *buffer, size_t size, BatchResult *R) {
+    MatchCursor cur = { M->initial, false, false };
+    const unsigned char *p = (const unsigned char *)buffer;
+    return matchChunk(M, p, p + size, &cur, R) && finishMatch(M, &cur, R);
+}
+
+bool matchStream(const BatchMatcher *M, FILE *in, BatchResult *R) {
+    unsigned char *block = malloc(STREAM_BLOCK_SIZE);
+    if (!block) return false;
+
+    STATS_START(timer);
+    MatchCursor cur = { M->initial, false, false };
+    bool ok = true;
+    size_t got;
+    while (ok && (got = fread(block, 1, STREAM_BLOCK_SIZE, in)) > 0) {
+        ok = matchChunk(M, block, block + got, &cur, R);
+    }
+    if (ok && ferror(in)) ok = false;
+    free(block);
+    ok = ok && finishMatch(M, &cur, R);
+    STATS_END(PHASE_MATCH, timer);
+    return ok;
+}
+
+// --- Parallel Matching ---
+// The buffer is cut into chunks that end right after a '\n', so every chunk
+// holds whole words and is matched independently against the shared
+// read-only matcher. Per-chunk results are appended to R in input order.
+
+typedef struct {
+    const BatchMatcher *M;
+    const char *buffer;
+    size_t *bounds;         // Chunk c is buffer[bounds[c] .. bounds[c + 1])
+    BatchResult *parts;
+    bool *ok;
+} ParallelMatch;
+
+static void matchChunkTask(void *ctx, int c) {
+    ParallelMatch *P = ctx;
+    P->ok[c] = matchBuffer(P->M, P->buffer + P->bounds[c], P->bounds[c + 1] - P->bounds[c], &P->parts[c]);
+}
+
+bool matchBufferParallel(const BatchMatcher *M, const char *buffer, size_t size, int num_threads, BatchResult *R) {
+    STATS_START(timer);
+    size_t max_chunks = size / PARALLEL_MIN_CHUNK;
+    if (num_threads <= 1 || max_chunks < 2) {
+        bool ok = matchBuffer(M, buffer, size, R);
+        STATS_END(PHASE_MATCH, timer);
+        return ok;
+    }
+    int num_chunks = num_threads * PARALLEL_CHUNKS_PER_THREAD;
+    if ((size_t)num_chunks > max_chunks) num_chunks = (int)max_chunks;
+
+    ParallelMatch P = { M, buffer, NULL, NULL, NULL };
+    P.bounds = malloc((num_chunks + 1) * sizeof(size_t));
+    P.parts = malloc(num_chunks * sizeof(BatchResult));
+    P.ok = malloc(num_chunks * sizeof(bool));
+    bool ok = P.bounds && P.parts && P.ok;
+    if (ok) {
+        P.bounds[0] = 0;
+        for (int c = 1; c < num_chunks; c++) {
+            size_t cut = size / num_chunks * c;
+            if (cut < P.bounds[c - 1]) cut = P.bounds[c - 1];
+            const char *nl = memchr(buffer + cut, '\n', size - cut);
+            P.bounds[c] = nl ? (size_t)(nl - buffer) + 1 : size;
+        }
+        P.bounds[num_chunks] = size;
+        for (int c = 0; c < num_chunks; c++) initBatchResult(&P.parts[c], R->want_bitmap);
+
+        parallelFor(num_chunks, num_threads, matchChunkTask, &P);
+        for (int c = 0; c < num_chunks; c++) {
+            ok = ok && P.ok[c] && appendResult(R, &P.parts[c]);
+            freeBatchResult(&P.parts[c]);
+        }
+    }
+    free(P.bounds);
+    free(P.parts);
+    free(P.ok);
+    STATS_END(PHASE_MATCH, timer);
+    return ok;
+}
+
+bool matchStreamParallel(const BatchMatcher *M, FILE *in, int num_threads, BatchResult *R) {
+    if (num_threads <= 1) return matchStream(M, in, R);
+
+    size_t capacity = PARALLEL_BLOCK_SIZE, used = 0;
+    char *block = malloc(capacity);
+    if (!block) return false;
+
+    bool ok = true;
+    while (ok) {
+        size_t got = fread(block + used, 1, capacity - used, in);
+        used += got;
+        if (used < capacity) {
+            // Short read: end of input, the last line may lack its '\n'
+            ok = matchBufferParallel(M, block, used, num_threads, R);
+            break;
+        }
+
+        size_t cut = used;
+        while (cut > 0 && block[cut - 1] != '\n') cut--;
+        if (cut == 0) {
+            // One line fills the whole block: grow it
+            char *temp = realloc(block, capacity * 2);
+            if (!temp) { ok = false; break; }
+            block = temp;
+            capacity *= 2;
+            continue;
+        }
+        ok = matchBufferParallel(M, block, cut, num_threads, R);
+        memmove(block, block + cut, used - cut);
+        used -= cut;
+    }
+    if (ferror(in)) ok = false;
+    free(block);
+    return ok;
+}
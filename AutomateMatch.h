@@ -0,0 +1,57 @@
+#ifndef AUTOMATE_MATCH_H
+#define AUTOMATE_MATCH_H
+
+#include "AutomateDFA.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// --- Batch Matcher ---
+// Total DFA over raw bytes compiled from a DenseDFA: every byte maps to the
+// column of its byte class, missing transitions go to an absorbing dead
+// state. The inner loop is a single table load per byte with
+// no range or "no transition" checks. Words are newline-delimited; a
+// trailing '\r' is ignored.
+
+typedef struct {
+    int num_states;         // DFA states + dead state
+    int num_columns;        // Byte classes of the DFA
+    // States are stored premultiplied (row offset = state * num_columns), so a
+    // step is table[row + column] with no multiply on the dependency chain
+    int initial;
+    int dead;
+    uint8_t column_of[256];
+    int32_t *table;         // row + column -> next row
+    uint8_t *accepting;     // Indexed by state (row / num_columns)
+} BatchMatcher;
+
+typedef struct {
+    long long num_words;
+    long long num_accepted;
+
+    // Optional accept bitmap (bit i = word i accepted), grown as needed
+    bool want_bitmap;
+    uint64_t *bitmap;
+    size_t bitmap_words;
+} BatchResult;
+
+// False when out of memory, or when (states + 1) * classes does not fit an int32
+bool buildBatchMatcher(const DenseDFA *D, BatchMatcher *M);
+void freeBatchMatcher(BatchMatcher *M);
+
+void initBatchResult(BatchResult *R, bool want_bitmap);
+void freeBatchResult(BatchResult *R);
+static inline bool batchAccepted(const BatchResult *R, long long word) {
+    return (R->bitmap[word >> 6] >> (word & 63)) & 1;
+}
+
+// Classifies every line of buffer[0 .. size). A last line without '\n' counts as a word.
+bool matchBuffer(const BatchMatcher *M, const char *buffer, size_t size, BatchResult *R);
+// Same over a stream read in large blocks; lines may span blocks.
+bool matchStream(const BatchMatcher *M, FILE *in, BatchResult *R);
+
+// Parallel variants: newline-aligned chunks matched on num_threads threads,
+// results identical to the sequential ones (same counts, same bitmap order).
+bool matchBufferParallel(const BatchMatcher *M, const char *buffer, size_t size, int num_threads, BatchResult *R);
+bool matchStreamParallel(const BatchMatcher *M, FILE *in, int num_threads, BatchResult *R);
+
+#endif // AUTOMATE_MATCH_H
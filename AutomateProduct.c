@@ -0,0 +1,168 @@
+#include "AutomateProduct.h"
+#include "AutomateAnalysis.h"
+#include "AutomateIO.h"
+#include "AutomateSet.h"
+#include "AutomateStats.h"
+#include "AutomateTransform.h"
+#include <string.h>
+
+static const char *opNames[] = { "intersection", "union", "difference", "symdiff" };
+
+bool parseProductOp(const char *name, ProductOp *op) {
+    for (int i = 0; i < (int)(sizeof(opNames) / sizeof(opNames[0])); i++) {
+        if (strcmp(name, opNames[i]) == 0) {
+            *op = (ProductOp)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *productOpName(ProductOp op) {
+    return opNames[op];
+}
+
+// --- Tuples ---
+// Component i of a tuple is a state of input i, -1 once it is dead.
+
+// False when no word can take the tuple to an accepting one
+static bool tupleAlive(const int32_t *tuple, int count, ProductOp op) {
+    switch (op) {
+        case PRODUCT_INTERSECTION:
+            for (int i = 0; i < count; i++) {
+                if (tuple[i] < 0) return false;
+            }
+            return true;
+        case PRODUCT_DIFFERENCE:
+            return tuple[0] >= 0;
+        default:
+            for (int i = 0; i < count; i++) {
+                if (tuple[i] >= 0) return true;
+            }
+            return false;
+    }
+}
+
+static bool tupleAccepting(const int32_t *tuple, int count, const Bitset *finals, ProductOp op) {
+    int accepted = 0;
+    for (int i = 0; i < count; i++) accepted += tuple[i] >= 0 && bitsetContains(&finals[i], tuple[i]);
+    switch (op) {
+        case PRODUCT_INTERSECTION:
+            return accepted == count;
+        case PRODUCT_UNION:
+            return accepted > 0;
+        case PRODUCT_DIFFERENCE:
+            return accepted == 1 && tuple[0] >= 0 && bitsetContains(&finals[0], tuple[0]);
+        case PRODUCT_SYMMETRIC_DIFFERENCE:
+            return accepted & 1;
+    }
+    return false;
+}
+
+// --- Product Construction ---
+
+bool productAutomaton(const Automaton *A, const Automaton *B, ProductOp op, Automaton *out, FILE *logFile) {
+    const Automaton *inputs[2] = { A, B };
+    return productAutomata(inputs, 2, op, out, logFile);
+}
+
+bool productAutomata(const Automaton *const *inputs, int count, ProductOp op, Automaton *out, FILE *logFile) {
+    if (count < 1) return false;
+    for (int i = 0; i < count; i++) {
+        if (!isDeterministic(inputs[i], logFile)) {
+            logAt(LOG_ERROR, logFile, "Erreur : le produit demande des automates deterministes (automate %d)\n", i + 1);
+            return false;
+        }
+    }
+
+    STATS_START(timer);
+    bool ok = false;
+
+    Alphabet merged;
+    int k = mergeAlphabets(inputs, count, &merged);
+
+    size_t total_states = 0;
+    for (int i = 0; i < count; i++) total_states += inputs[i]->num_states;
+
+    Arena scratch;
+    SubsetTable table;
+    if (!arenaInit(&scratch, total_states * (k + 1) * sizeof(int) + 4096)) return false;
+    if (!subsetTableInit(&table, 64)) {
+        arenaRelease(&scratch);
+        return false;
+    }
+
+    // Per-input transitions over the merged alphabet, delta[i][state * k + symbol], -1 = none
+    int **delta = arenaAlloc(&scratch, count * sizeof(int *));
+    Bitset *finals = arenaAlloc(&scratch, count * sizeof(Bitset));
+    int32_t *tuple = arenaAlloc(&scratch, count * sizeof(int32_t));
+    int32_t *next = arenaAlloc(&scratch, count * sizeof(int32_t));
+    int trans_capacity = 64;
+    int *trans = arenaAlloc(&scratch, trans_capacity * (k > 0 ? k : 1) * sizeof(int)); // Product transitions, -1 = none
+    if (!delta || !finals || !tuple || !next || !trans) goto cleanup;
+
+    for (int i = 0; i < count; i++) {
+        const Automaton *I = inputs[i];
+        int n = I->num_states;
+        delta[i] = arenaAlloc(&scratch, ((size_t)n * k > 0 ? (size_t)n * k : 1) * sizeof(int));
+        if (!delta[i] || !bitsetInitArena(&finals[i], n, &scratch)) goto cleanup;
+        for (size_t c = 0; c < (size_t)n * k; c++) delta[i][c] = -1;
+        for (int s = 0; s < n; s++) {
+            for (int sym = 0; sym < I->num_symbols; sym++) {
+                int dest_count;
+                const int *dests = cellTransitions(I, s * I->num_symbols + sym, &dest_count);
+                if (dest_count > 0) delta[i][(size_t)s * k + merged.symbols[I->alphabet.letters[sym]]] = dests[0];
+            }
+        }
+        for (int f = 0; f < I->num_finals; f++) bitsetAdd(&finals[i], I->finals[f]);
+        tuple[i] = I->initials[0];
+    }
+    if (subsetTableInsert(&table, tuple, count * sizeof(int32_t), NULL) < 0) goto cleanup;
+
+    for (int processed = 0; processed < table.count; processed++) {
+        if (table.count > trans_capacity) {
+            int old_capacity = trans_capacity;
+            while (trans_capacity < table.count) trans_capacity *= 2;
+            int *temp = arenaAlloc(&scratch, trans_capacity * (k > 0 ? k : 1) * sizeof(int));
+            if (!temp) goto cleanup;
+            memcpy(temp, trans, old_capacity * k * sizeof(int));
+            trans = temp;
+        }
+
+        // The key may move when the table grows: work on a copy
+        memcpy(tuple, subsetTableKey(&table, processed, NULL), count * sizeof(int32_t));
+        if (!tupleAlive(tuple, count, op)) {
+            // Only the initial tuple can be dead: the language is empty
+            for (int sym = 0; sym < k; sym++) trans[processed * k + sym] = -1;
+            continue;
+        }
+        for (int sym = 0; sym < k; sym++) {
+            for (int i = 0; i < count; i++) {
+                next[i] = tuple[i] >= 0 ? delta[i][(size_t)tuple[i] * k + sym] : -1;
+            }
+            int id = -1;
+            if (tupleAlive(next, count, op)) {
+                id = subsetTableInsert(&table, next, count * sizeof(int32_t), NULL);
+                if (id < 0) goto cleanup;
+            }
+            trans[processed * k + sym] = id;
+        }
+    }
+
+    if (!createDeterministic(out, table.count, k, trans, 1)) goto cleanup;
+    out->initials[0] = 0;
+    out->alphabet = merged;
+    for (int id = 0; id < table.count; id++) {
+        const int32_t *key = subsetTableKey(&table, id, NULL);
+        if (tupleAccepting(key, count, finals, op)) out->finals[out->num_finals++] = id;
+    }
+    ok = true;
+
+cleanup:
+    STATS_COUNT(COUNT_SUBSET_LOOKUPS, table.lookups);
+    STATS_COUNT(COUNT_SUBSET_PROBES, table.probes);
+    subsetTableFree(&table);
+    arenaRelease(&scratch);
+    STATS_END(PHASE_PRODUCT, timer);
+    return ok;
+}
@@ -0,0 +1,40 @@
+#ifndef AUTOMATE_PRODUCT_H
+#define AUTOMATE_PRODUCT_H
+
+#include "AutomateCore.h"
+#include <stdio.h>
+
+// --- Product Construction ---
+// Boolean combinations of DFAs, exploring only the tuples of states
+// reachable from the tuple of initial states. Tuples are interned in a
+// SubsetTable (tuple -> product state), as determinize() does with subsets,
+// and numbered in discovery order.
+//
+// Inputs must be deterministic; partial DFAs are fine, a missing transition
+// leaves that component dead (accepting nothing from there on). Alphabets
+// are merged by byte, in order of first appearance: a symbol an input lacks
+// also kills that component. Tuples that can no longer be accepted under
+// the operation (a dead component in an intersection, a dead first
+// component in a difference, every component dead otherwise) are dropped,
+// so the result is a partial DFA.
+//
+// The n-ary variant builds the product of all inputs in one pass: no
+// intermediate product is built, nor its blow-up paid, when combining many
+// automata into one.
+
+typedef enum {
+    PRODUCT_INTERSECTION,           // Words accepted by every input
+    PRODUCT_UNION,                  // By at least one
+    PRODUCT_DIFFERENCE,             // By the first and by none of the others
+    PRODUCT_SYMMETRIC_DIFFERENCE    // By an odd number of inputs
+} ProductOp;
+
+// Names: intersection, union, difference, symdiff
+bool parseProductOp(const char *name, ProductOp *op);
+const char *productOpName(ProductOp op);
+
+bool productAutomaton(const Automaton *A, const Automaton *B, ProductOp op, Automaton *out, FILE *logFile);
+// count >= 1 inputs
+bool productAutomata(const Automaton *const *inputs, int count, ProductOp op, Automaton *out, FILE *logFile);
+
+#endif // AUTOMATE_PRODUCT_H
@@ -0,0 +1,435 @@
+#include "AutomateRegex.h"
+#include "AutomateLog.h"
+#include "AutomateSet.h"
+#include "AutomateStats.h"
+#include <stdlib.h>
+#include <string.h>
+
+// --- Syntax Tree ---
+
+typedef enum {
+    NODE_EMPTY,         // The empty word
+    NODE_LETTERS,       // One position: a letter, a class or "."
+    NODE_CONCAT,
+    NODE_UNION,
+    NODE_STAR,
+    NODE_PLUS,
+    NODE_OPTIONAL
+} NodeType;
+
+typedef struct Node Node;
+struct Node {
+    NodeType type;
+    int position;           // NODE_LETTERS
+    bool negated;           // NODE_LETTERS: `letters` is taken against the alphabet
+    uint64_t letters[4];    // NODE_LETTERS: bytes
+    Node *child;            // First operand
+    Node *next;             // Next operand of the parent
+};
+
+typedef struct {
+    const char *pattern;
+    size_t length;
+    size_t pos;
+    Arena *arena;
+    const Alphabet *alphabet;   // NULL: the pattern's bytes
+    uint64_t named[4];          // Bytes the pattern names
+    Node **positions;           // Position -> node, from 1
+    int num_positions;
+    int capacity;
+    int depth;
+    const char *error;          // First error, at error_pos
+    size_t error_pos;
+} Parser;
+
+static inline void addByte(uint64_t *set, unsigned char byte) {
+    set[byte >> 6] |= (uint64_t)1 << (byte & 63);
+}
+
+static Node *fail(Parser *P, size_t pos, const char *message) {
+    if (!P->error) {
+        P->error = message;
+        P->error_pos = pos;
+    }
+    return NULL;
+}
+
+static Node *newNode(Parser *P, NodeType type) {
+    Node *N = arenaCalloc(P->arena, 1, sizeof(Node));
+    if (!N) return fail(P, P->pos, "memoire insuffisante");
+    N->type = type;
+    return N;
+}
+
+static Node *newPosition(Parser *P) {
+    if (P->num_positions + 1 >= P->capacity) {
+        int capacity = P->capacity ? P->capacity * 2 : 64;
+        Node **temp = realloc(P->positions, capacity * sizeof(Node *));
+        if (!temp) return fail(P, P->pos, "memoire insuffisante");
+        P->positions = temp;
+        P->capacity = capacity;
+    }
+    Node *N = newNode(P, NODE_LETTERS);
+    if (!N) return NULL;
+    N->position = ++P->num_positions;
+    P->positions[N->position] = N;
+    return N;
+}
+
+// A byte written in the pattern; outside a given alphabet, an error
+static bool nameByte(Parser *P, unsigned char byte, size_t pos) {
+    if (P->alphabet && P->alphabet->symbols[byte] < 0) return fail(P, pos, "lettre hors de l'alphabet") != NULL;
+    addByte(P->named, byte);
+    return true;
+}
+
+// One byte, possibly escaped
+static bool readByte(Parser *P, unsigned char *byte) {
+    char c = P->pattern[P->pos++];
+    if (c == '\\') {
+        if (P->pos >= P->length) return fail(P, P->pos - 1, "echappement incomplet") != NULL;
+        c = P->pattern[P->pos++];
+        if (c == 'n') c = '\n';
+        else if (c == 't') c = '\t';
+    }
+    *byte = (unsigned char)c;
+    return true;
+}
+
+// --- Parser (recursive descent) ---
+
+static Node *parseUnion(Parser *P);
+
+// [...] once the opening bracket is consumed
+static Node *parseClass(Parser *P, size_t start) {
+    Node *N = newPosition(P);
+    if (!N) return NULL;
+    if (P->pos < P->length && P->pattern[P->pos] == '^') {
+        N->negated = true;
+        P->pos++;
+    }
+    for (bool first = true;; first = false) {
+        if (P->pos >= P->length) return fail(P, start, "crochet fermant attendu");
+        if (P->pattern[P->pos] == ']' && !first) {
+            P->pos++;
+            return N;
+        }
+        size_t at = P->pos;
+        unsigned char low, high;
+        if (!readByte(P, &low)) return NULL;
+        if (P->pos + 1 < P->length && P->pattern[P->pos] == '-' && P->pattern[P->pos + 1] != ']') {
+            P->pos++;
+            if (!readByte(P, &high)) return NULL;
+            if (high < low) return fail(P, at, "intervalle invalide");
+            // A range only keeps the letters of a given alphabet
+            for (int b = low; b <= high; b++) {
+                if (!P->alphabet || P->alphabet->symbols[b] >= 0) {
+                    addByte(N->letters, (unsigned char)b);
+                    addByte(P->named, (unsigned char)b);
+                }
+            }
+        } else {
+            if (!nameByte(P, low, at)) return NULL;
+            addByte(N->letters, low);
+        }
+    }
+}
+
+static Node *parseAtom(Parser *P) {
+    size_t at = P->pos;
+    char c = P->pattern[P->pos];
+    if (c == '(') {
+        P->pos++;
+        Node *inner = parseUnion(P);
+        if (!inner) return NULL;
+        if (P->pos >= P->length || P->pattern[P->pos] != ')') return fail(P, at, "parenthese fermante attendue");
+        P->pos++;
+        return inner;
+    }
+    if (c == '*' || c == '+' || c == '?') return fail(P, at, "operateur sans operande");
+    if (c == '[') {
+        P->pos++;
+        return parseClass(P, at);
+    }
+    if (c == '.') {
+        P->pos++;
+        Node *N = newPosition(P);
+        if (N) N->negated = true;
+        return N;
+    }
+    if (c == '\\' && P->pos + 1 < P->length && P->pattern[P->pos + 1] == 'e') {
+        P->pos += 2;
+        return newNode(P, NODE_EMPTY);
+    }
+    unsigned char byte;
+    if (!readByte(P, &byte) || !nameByte(P, byte, at)) return NULL;
+    Node *N = newPosition(P);
+    if (N) addByte(N->letters, byte);
+    return N;
+}
+
+// Stacked operators collapse: e** is e*, and mixing any two of *, + and ?
+// gives *, so the tree stays as deep as the pattern's groups
+static Node *parseRepeat(Parser *P) {
+    Node *N = parseAtom(P);
+    while (N && P->pos < P->length) {
+        char c = P->pattern[P->pos];
+        NodeType type = c == '*' ? NODE_STAR : c == '+' ? NODE_PLUS : c == '?' ? NODE_OPTIONAL : NODE_EMPTY;
+        if (type == NODE_EMPTY) break;
+        P->pos++;
+        bool repeated = N->type == NODE_STAR || N->type == NODE_PLUS || N->type == NODE_OPTIONAL;
+        if (repeated) {
+            if (N->type != type) N->type = NODE_STAR;
+            continue;
+        }
+        Node *R = newNode(P, type);
+        if (!R) return NULL;
+        R->child = N;
+        N = R;
+    }
+    return N;
+}
+
+static Node *parseConcat(Parser *P) {
+    Node *C = newNode(P, NODE_CONCAT);
+    Node *tail = NULL;
+    while (C && P->pos < P->length && P->pattern[P->pos] != '|' && P->pattern[P->pos] != ')') {
+        Node *item = parseRepeat(P);
+        if (!item) return NULL;
+        if (tail) tail->next = item;
+        else C->child = item;
+        tail = item;
+    }
+    if (!C || !C->child) return C ? newNode(P, NODE_EMPTY) : NULL;
+    return C->child->next ? C : C->child;
+}
+
+static Node *parseUnion(Parser *P) {
+    if (++P->depth > REGEX_MAX_DEPTH) return fail(P, P->pos, "motif trop imbrique");
+    Node *first = parseConcat(P);
+    if (!first || P->pos >= P->length || P->pattern[P->pos] != '|') {
+        P->depth--;
+        return first;
+    }
+    Node *U = newNode(P, NODE_UNION);
+    if (!U) return NULL;
+    U->child = first;
+    for (Node *tail = first; P->pos < P->length && P->pattern[P->pos] == '|'; ) {
+        P->pos++;
+        Node *next = parseConcat(P);
+        if (!next) return NULL;
+        tail->next = next;
+        tail = next;
+    }
+    P->depth--;
+    return U;
+}
+
+// --- Glushkov Construction ---
+// For each subtree: whether it accepts the empty word, and its first and
+// last positions (disjoint between siblings, so unions are concatenations).
+// Follow transitions are added to the builder as the tree is walked: last
+// positions of a concatenation's left part to first positions of its right
+// part, and last to first positions of a repeated subtree.
+
+typedef struct {
+    bool nullable;
+    int *first;
+    int num_first;
+    int *last;
+    int num_last;
+} Glushkov;
+
+typedef struct {
+    Node **positions;
+    const Alphabet *alphabet;
+    AutomatonBuilder *builder;
+    Arena *scratch;
+} GlushkovCtx;
+
+// Transitions from every state of `from` into every position of `to`, on the position's letters
+static bool linkPositions(GlushkovCtx *C, const int *from, int num_from, const int *to, int num_to) {
+    for (int i = 0; i < num_to; i++) {
+        const Node *N = C->positions[to[i]];
+        for (int w = 0; w < 4; w++) {
+            for (uint64_t word = N->letters[w]; word; word &= word - 1) {
+                int symbol = C->alphabet->symbols[w * 64 + lowestBit(word)];
+                for (int j = 0; j < num_from; j++) {
+                    if (!builderAdd(C->builder, from[j], symbol, to[i])) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static bool glushkov(GlushkovCtx *C, const Node *N, Glushkov *G);
+
+// Results of the operands of N, in order, leaving out those that only match
+// the empty word (no positions, nothing to link): *dropped tells if any was
+static Glushkov *glushkovOperands(GlushkovCtx *C, const Node *N, int *count, bool *dropped) {
+    int n = 0;
+    for (const Node *item = N->child; item; item = item->next) n++;
+    Glushkov *parts = arenaAlloc(C->scratch, n * sizeof(Glushkov));
+    if (!parts) return NULL;
+    *count = 0;
+    *dropped = false;
+    for (const Node *item = N->child; item; item = item->next) {
+        Glushkov *part = &parts[*count];
+        if (!glushkov(C, item, part)) return NULL;
+        if (!part->nullable || part->num_first > 0 || part->num_last > 0) (*count)++;
+        else *dropped = true;
+    }
+    return parts;
+}
+
+// First (or last) positions of parts[from..to), gathered in one array, so
+// each list is copied once per node whatever the number of operands
+static int *gatherPositions(Arena *R, const Glushkov *parts, int from, int to, bool last, int *count) {
+    int total = 0;
+    for (int i = from; i < to; i++) total += last ? parts[i].num_last : parts[i].num_first;
+    int *positions = arenaAlloc(R, (total > 0 ? total : 1) * sizeof(int));
+    if (!positions) return NULL;
+    int at = 0;
+    for (int i = from; i < to; i++) {
+        int size = last ? parts[i].num_last : parts[i].num_first;
+        if (size > 0) memcpy(positions + at, last ? parts[i].last : parts[i].first, size * sizeof(int));
+        at += size;
+    }
+    *count = total;
+    return positions;
+}
+
+static bool glushkov(GlushkovCtx *C, const Node *N, Glushkov *G) {
+    memset(G, 0, sizeof(Glushkov));
+    switch (N->type) {
+        case NODE_EMPTY:
+            G->nullable = true;
+            return true;
+        case NODE_LETTERS:
+            G->first = G->last = arenaAlloc(C->scratch, sizeof(int));
+            if (!G->first) return false;
+            G->first[0] = N->position;
+            G->num_first = G->num_last = 1;
+            return true;
+        case NODE_CONCAT: {
+            int count;
+            bool dropped;
+            Glushkov *parts = glushkovOperands(C, N, &count, &dropped);
+            if (!parts) return false;
+            // Each operand follows the last positions of the operands before
+            // it, back to the nearest one that does not accept the empty word
+            for (int i = 1; i < count; i++) {
+                for (int j = i - 1; j >= 0 && parts[i].num_first > 0; j--) {
+                    if (!linkPositions(C, parts[j].last, parts[j].num_last, parts[i].first, parts[i].num_first)) {
+                        return false;
+                    }
+                    if (!parts[j].nullable) break;
+                }
+            }
+            int head = 0, tail = count - 1;
+            while (head < count && parts[head].nullable) head++;
+            while (tail >= 0 && parts[tail].nullable) tail--;
+            G->nullable = head == count;
+            G->first = gatherPositions(C->scratch, parts, 0, head < count ? head + 1 : count, false, &G->num_first);
+            G->last = gatherPositions(C->scratch, parts, tail >= 0 ? tail : 0, count, true, &G->num_last);
+            return G->first && G->last;
+        }
+        case NODE_UNION: {
+            int count;
+            Glushkov *parts = glushkovOperands(C, N, &count, &G->nullable);
+            if (!parts) return false;
+            for (int i = 0; i < count; i++) G->nullable = G->nullable || parts[i].nullable;
+            G->first = gatherPositions(C->scratch, parts, 0, count, false, &G->num_first);
+            G->last = gatherPositions(C->scratch, parts, 0, count, true, &G->num_last);
+            return G->first && G->last;
+        }
+        default:
+            if (!glushkov(C, N->child, G)) return false;
+            if (N->type != NODE_OPTIONAL && !linkPositions(C, G->last, G->num_last, G->first, G->num_first)) {
+                return false;
+            }
+            if (N->type != NODE_PLUS) G->nullable = true;
+            return true;
+    }
+}
+
+// --- Compilation ---
+
+bool compileRegex(const char *pattern, const Alphabet *alphabet, int num_symbols, Automaton *out, FILE *logFile) {
+    STATS_START(timer);
+    bool ok = false;
+    Arena scratch;
+    size_t length = strlen(pattern);
+    if (!arenaInit(&scratch, length * 4 * sizeof(Node) + 4096)) return false;
+    Parser P = { 0 };
+    P.pattern = pattern;
+    P.length = length;
+    P.arena = &scratch;
+    P.alphabet = alphabet;
+
+    Node *root = parseUnion(&P);
+    if (root && P.pos < P.length) root = fail(&P, P.pos, "parenthese ouvrante manquante");
+    if (!root) {
+        logAt(LOG_ERROR, logFile, "Erreur : motif invalide (position %d) : %s\n", (int)P.error_pos + 1,
+              P.error ? P.error : "memoire insuffisante");
+        goto cleanup;
+    }
+
+    // The alphabet, then "." and [^...] taken against it
+    Alphabet L;
+    uint64_t universe[4] = { 0 };
+    if (alphabet) {
+        L = *alphabet;
+        for (int i = 0; i < num_symbols; i++) addByte(universe, alphabet->letters[i]);
+    } else {
+        unsigned char letters[ALPHABET_MAX];
+        num_symbols = 0;
+        for (int b = 0; b < ALPHABET_MAX; b++) {
+            if (P.named[b >> 6] >> (b & 63) & 1) letters[num_symbols++] = (unsigned char)b;
+        }
+        if (num_symbols == 0) {
+            logAt(LOG_ERROR, logFile, "Erreur : le motif ne nomme aucune lettre, alphabet a preciser\n");
+            goto cleanup;
+        }
+        alphabetSet(&L, letters, num_symbols);
+        memcpy(universe, P.named, sizeof(universe));
+    }
+    for (int p = 1; p <= P.num_positions; p++) {
+        Node *N = P.positions[p];
+        for (int w = 0; w < 4; w++) N->letters[w] = (N->negated ? ~N->letters[w] : N->letters[w]) & universe[w];
+    }
+
+    int n = P.num_positions + 1;
+    if (!createAutomatonInArena(out, n, num_symbols)) goto cleanup;
+    out->alphabet = L;
+    out->initials = automatonAlloc(out, sizeof(int));
+    out->finals = automatonAlloc(out, n * sizeof(int));
+    AutomatonBuilder builder;
+    if (!out->initials || !out->finals || !builderInit(&builder, n, num_symbols, 4 * n)) {
+        freeAutomaton(out);
+        goto cleanup;
+    }
+
+    GlushkovCtx C = { P.positions, &L, &builder, &scratch };
+    Glushkov G;
+    int initial = 0;
+    ok = glushkov(&C, root, &G) && linkPositions(&C, &initial, 1, G.first, G.num_first);
+    if (ok) {
+        out->initials[out->num_initials++] = 0;
+        if (G.nullable) out->finals[out->num_finals++] = 0;
+        for (int i = 0; i < G.num_last; i++) out->finals[out->num_finals++] = G.last[i];
+        ok = builderFreeze(&builder, out);
+    }
+    if (!ok) {
+        builderFree(&builder);
+        freeAutomaton(out);
+        logAt(LOG_ERROR, logFile, "Erreur : Memoire insuffisante\n");
+    }
+
+cleanup:
+    free(P.positions);
+    arenaRelease(&scratch);
+    STATS_END(PHASE_REGEX, timer);
+    return ok;
+}
@@ -0,0 +1,33 @@
+#ifndef AUTOMATE_REGEX_H
+#define AUTOMATE_REGEX_H
+
+#include "AutomateCore.h"
+#include <stdio.h>
+
+// --- Regular Expressions ---
+// Compiles a pattern into an NFA with the Glushkov (position) construction:
+// one state per letter occurrence plus an initial state, and no epsilon
+// transition. A transition on x goes into every position that can read x
+// next (follow sets). Positions are numbered from 1 in pattern order.
+//
+// Syntax, loosest first:
+//   e|f    alternation (either side may be empty: the empty word)
+//   ef     concatenation
+//   e* e+ e?   repetition: any number, at least one, at most one
+//   (e)    grouping; () is the empty word, as is \e
+//   .      any letter of the alphabet
+//   [abc] [a-z] [^abc]   character classes; ] first and - first or last
+//          are literal, [^...] is taken against the alphabet
+//   \x     the byte x itself (\n and \t: newline and tab)
+//
+// The alphabet is the one given, or else the bytes the pattern names,
+// sorted (a pattern naming none, as "" or ".*", needs one); a named byte
+// outside a given alphabet is an error. Syntax errors are logged with their
+// position in the pattern.
+
+#define REGEX_MAX_DEPTH 1000    // Nested groups and operators
+
+// alphabet NULL: the pattern's own bytes
+bool compileRegex(const char *pattern, const Alphabet *alphabet, int num_symbols, Automaton *out, FILE *logFile);
+
+#endif // AUTOMATE_REGEX_H
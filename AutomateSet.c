@@ -0,0 +1,268 @@
+#include "AutomateSet.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_BUCKETS 64
+#define BITSET_MEMORY_BUDGET ((size_t)64 << 20) // bytes of successor bitsets
+
+// --- Hashing ---
+
+static uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t hashBytes(const void *data, size_t size) {
+    const unsigned char *p = data;
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ (uint64_t)size;
+    while (size >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = mix64(h ^ w) + 0x9e3779b97f4a7c15ULL;
+        p += 8;
+        size -= 8;
+    }
+    if (size > 0) {
+        uint64_t w = 0;
+        memcpy(&w, p, size);
+        h = mix64(h ^ w);
+    }
+    return mix64(h);
+}
+
+// --- Subset Table ---
+
+bool subsetTableInit(SubsetTable *T, int expected) {
+    memset(T, 0, sizeof(SubsetTable));
+
+    int buckets = MIN_BUCKETS;
+    while (buckets < expected * 2) buckets *= 2;
+
+    T->key_capacity = buckets / 2;
+    T->offsets = malloc((T->key_capacity + 1) * sizeof(size_t));
+    T->hashes = malloc(T->key_capacity * sizeof(uint64_t));
+    T->buckets = malloc(buckets * sizeof(int));
+    if (!T->offsets || !T->hashes || !T->buckets) {
+        subsetTableFree(T);
+        return false;
+    }
+    T->bucket_mask = buckets - 1;
+    for (int i = 0; i < buckets; i++) T->buckets[i] = -1;
+    T->offsets[0] = 0;
+    return true;
+}
+
+void subsetTableFree(SubsetTable *T) {
+    if (!T) return;
+    free(T->offsets);
+    free(T->hashes);
+    free(T->pool);
+    free(T->buckets);
+    memset(T, 0, sizeof(SubsetTable));
+}
+
+static int findSlot(const SubsetTable *T, const void *key, size_t size, uint64_t h, int *probes) {
+    int slot = (int)(h & (uint64_t)T->bucket_mask);
+    *probes = 1;
+    while (T->buckets[slot] != -1) {
+        int id = T->buckets[slot];
+        if (T->hashes[id] == h && T->offsets[id + 1] - T->offsets[id] == size &&
+            memcmp(T->pool + T->offsets[id], key, size) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & T->bucket_mask;
+        (*probes)++;
+    }
+    return slot;
+}
+
+static bool growBuckets(SubsetTable *T) {
+    int buckets = (T->bucket_mask + 1) * 2;
+    int *temp = malloc(buckets * sizeof(int));
+    if (!temp) return false;
+    for (int i = 0; i < buckets; i++) temp[i] = -1;
+
+    free(T->buckets);
+    T->buckets = temp;
+    T->bucket_mask = buckets - 1;
+    for (int id = 0; id < T->count; id++) {
+        int slot = (int)(T->hashes[id] & (uint64_t)T->bucket_mask);
+        while (T->buckets[slot] != -1) slot = (slot + 1) & T->bucket_mask;
+        T->buckets[slot] = id;
+    }
+    return true;
+}
+
+int subsetTableFind(const SubsetTable *T, const void *key, size_t size) {
+    int probes;
+    return T->buckets[findSlot(T, key, size, hashBytes(key, size), &probes)];
+}
+
+int subsetTableInsert(SubsetTable *T, const void *key, size_t size, bool *inserted) {
+    uint64_t h = hashBytes(key, size);
+    int probes;
+    int slot = findSlot(T, key, size, h, &probes);
+    T->lookups++;
+    T->probes += probes;
+    if (inserted) *inserted = false;
+    if (T->buckets[slot] != -1) return T->buckets[slot];
+
+    // Keep the load factor under 1/2
+    if ((T->count + 1) * 2 > T->bucket_mask + 1) {
+        if (!growBuckets(T)) return -1;
+        slot = findSlot(T, key, size, h, &probes);
+    }
+    if (T->count >= T->key_capacity) {
+        int new_cap = T->key_capacity * 2;
+        size_t *new_offsets = realloc(T->offsets, (new_cap + 1) * sizeof(size_t));
+        if (!new_offsets) return -1;
+        T->offsets = new_offsets;
+        uint64_t *new_hashes = realloc(T->hashes, new_cap * sizeof(uint64_t));
+        if (!new_hashes) return -1;
+        T->hashes = new_hashes;
+        T->key_capacity = new_cap;
+    }
+    if (T->pool_size + size > T->pool_capacity) {
+        size_t new_cap = T->pool_capacity ? T->pool_capacity * 2 : 1024;
+        while (new_cap < T->pool_size + size) new_cap *= 2;
+        unsigned char *new_pool = realloc(T->pool, new_cap);
+        if (!new_pool) return -1;
+        T->pool = new_pool;
+        T->pool_capacity = new_cap;
+    }
+
+    int id = T->count++;
+    if (size > 0) memcpy(T->pool + T->pool_size, key, size);
+    T->pool_size += size;
+    T->offsets[id + 1] = T->pool_size;
+    T->hashes[id] = h;
+    T->buckets[slot] = id;
+    if (inserted) *inserted = true;
+    return id;
+}
+
+const void *subsetTableKey(const SubsetTable *T, int id, size_t *size) {
+    if (size) *size = T->offsets[id + 1] - T->offsets[id];
+    return T->pool + T->offsets[id];
+}
+
+// --- Canonical Subsets ---
+
+static int compareInts(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+void sortStates(int *states, int count) {
+    if (count < 16) {
+        // Insertion sort: subsets are usually tiny
+        for (int i = 1; i < count; i++) {
+            int v = states[i];
+            int j = i - 1;
+            while (j >= 0 && states[j] > v) { states[j + 1] = states[j]; j--; }
+            states[j + 1] = v;
+        }
+    } else {
+        qsort(states, count, sizeof(int), compareInts);
+    }
+}
+
+// --- Bitset State Sets ---
+
+bool bitsetInit(Bitset *S, int num_states) {
+    S->num_states = num_states;
+    S->num_words = BITSET_WORDS(num_states);
+    S->words = calloc(S->num_words > 0 ? S->num_words : 1, sizeof(uint64_t));
+    return S->words != NULL;
+}
+
+bool bitsetInitArena(Bitset *S, int num_states, Arena *R) {
+    S->num_states = num_states;
+    S->num_words = BITSET_WORDS(num_states);
+    S->words = arenaCalloc(R, S->num_words > 0 ? S->num_words : 1, sizeof(uint64_t));
+    return S->words != NULL;
+}
+
+void bitsetFree(Bitset *S) {
+    if (!S) return;
+    free(S->words);
+    S->words = NULL;
+    S->num_words = 0;
+    S->num_states = 0;
+}
+
+void bitsetClear(Bitset *S) {
+    memset(S->words, 0, S->num_words * sizeof(uint64_t));
+}
+
+bool bitsetIsEmpty(const Bitset *S) {
+    for (int w = 0; w < S->num_words; w++) {
+        if (S->words[w]) return false;
+    }
+    return true;
+}
+
+int bitsetCount(const Bitset *S) {
+    int count = 0;
+    for (int w = 0; w < S->num_words; w++) {
+        for (uint64_t word = S->words[w]; word; word &= word - 1) count++;
+    }
+    return count;
+}
+
+int bitsetToArray(const Bitset *S, int *out) {
+    int count = 0;
+    for (int w = 0; w < S->num_words; w++) {
+        for (uint64_t word = S->words[w]; word; word &= word - 1) {
+            out[count++] = w * 64 + lowestBit(word);
+        }
+    }
+    return count;
+}
+
+// --- Sparse State Sets ---
+
+bool sparseSetInit(SparseSet *S, int capacity) {
+    S->capacity = capacity;
+    S->count = 0;
+    S->dense = malloc((capacity > 0 ? capacity : 1) * sizeof(int));
+    // calloc keeps the sparse index defined for sparseSetContains
+    S->sparse = calloc(capacity > 0 ? capacity : 1, sizeof(int));
+    if (!S->dense || !S->sparse) {
+        sparseSetFree(S);
+        return false;
+    }
+    return true;
+}
+
+bool sparseSetInitArena(SparseSet *S, int capacity, Arena *R) {
+    S->capacity = capacity;
+    S->count = 0;
+    S->dense = arenaAlloc(R, (capacity > 0 ? capacity : 1) * sizeof(int));
+    S->sparse = arenaCalloc(R, capacity > 0 ? capacity : 1, sizeof(int));
+    return S->dense && S->sparse;
+}
+
+void sparseSetFree(SparseSet *S) {
+    if (!S) return;
+    free(S->dense);
+    free(S->sparse);
+    S->dense = NULL;
+    S->sparse = NULL;
+    S->count = 0;
+    S->capacity = 0;
+}
+
+void sparseSetCanonicalize(SparseSet *S) {
+    sortStates(S->dense, S->count);
+    for (int i = 0; i < S->count; i++) S->sparse[S->dense[i]] = i;
+}
+
+bool preferBitsets(int num_states, int num_symbols) {
+    size_t bytes = (size_t)num_states * (size_t)num_symbols * (size_t)BITSET_WORDS(num_states) * sizeof(uint64_t);
+    return bytes <= BITSET_MEMORY_BUDGET;
+}
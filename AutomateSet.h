@@ -0,0 +1,136 @@
+#ifndef AUTOMATE_SET_H
+#define AUTOMATE_SET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "AutomateArena.h"
+
+// --- Hash-Indexed Subset Table ---
+// Interns canonical keys (e.g. a sorted list of NFA states) and hands out
+// dense ids 0, 1, 2... in insertion order. Keys are opaque byte strings,
+// so the same table can index subsets, state pairs or tuples.
+
+typedef struct {
+    int count;              // Number of interned keys
+    int key_capacity;       // Allocated entries in offsets/hashes
+
+    size_t *offsets;        // Key i lives in pool[offsets[i] .. offsets[i+1])
+    uint64_t *hashes;       // Cached hash of each key
+    unsigned char *pool;    // Concatenated key bytes
+    size_t pool_size;
+    size_t pool_capacity;
+
+    int bucket_mask;        // Number of buckets - 1 (power of two)
+    int *buckets;           // Open addressing, -1 = empty slot, else key id
+
+    // Work done by subsetTableInsert(), for the instrumentation
+    unsigned long long lookups;
+    unsigned long long probes;  // Slots inspected
+} SubsetTable;
+
+bool subsetTableInit(SubsetTable *T, int expected);
+void subsetTableFree(SubsetTable *T);
+
+// Returns the id of the key, or -1 if absent.
+int subsetTableFind(const SubsetTable *T, const void *key, size_t size);
+// Returns the id of the key, inserting it if needed (-1 on allocation failure).
+int subsetTableInsert(SubsetTable *T, const void *key, size_t size, bool *inserted);
+const void *subsetTableKey(const SubsetTable *T, int id, size_t *size);
+
+uint64_t hashBytes(const void *data, size_t size);
+
+// --- Canonical Subsets ---
+void sortStates(int *states, int count);
+
+// --- Bitset State Sets (dense) ---
+// One bit per state packed in 64-bit words: membership, union and equality
+// are a handful of word operations. Bits past num_states are always zero,
+// so the words can be compared or hashed directly.
+
+typedef struct {
+    int num_states;
+    int num_words;
+    uint64_t *words;
+} Bitset;
+
+#define BITSET_WORDS(n) (((n) + 63) / 64)
+
+bool bitsetInit(Bitset *S, int num_states);
+bool bitsetInitArena(Bitset *S, int num_states, Arena *R); // Released with the arena
+void bitsetFree(Bitset *S);
+void bitsetClear(Bitset *S);
+bool bitsetIsEmpty(const Bitset *S);
+int bitsetCount(const Bitset *S);
+// Writes the members in increasing order, returns how many were written.
+int bitsetToArray(const Bitset *S, int *out);
+
+static inline void bitsetAdd(Bitset *S, int state) {
+    S->words[state >> 6] |= (uint64_t)1 << (state & 63);
+}
+
+static inline bool bitsetContains(const Bitset *S, int state) {
+    return (S->words[state >> 6] >> (state & 63)) & 1;
+}
+
+// dst |= src, word by word (src has dst->num_words words)
+static inline void bitsetUnionWords(Bitset *dst, const uint64_t *src) {
+    for (int w = 0; w < dst->num_words; w++) dst->words[w] |= src[w];
+}
+
+static inline bool bitsetIntersects(const Bitset *S, const uint64_t *other) {
+    for (int w = 0; w < S->num_words; w++) {
+        if (S->words[w] & other[w]) return true;
+    }
+    return false;
+}
+
+// Index of the lowest set bit (word must be non-zero)
+static inline int lowestBit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int i = 0;
+    while (!(word & 1)) { word >>= 1; i++; }
+    return i;
+#endif
+}
+
+// --- Sparse State Sets ---
+// Briggs-Torczon sparse set: O(1) insert, membership and clear, with the
+// members listed densely. Used when the NFA is too large for bitsets;
+// sorting the dense part gives the canonical (sorted vector) form.
+
+typedef struct {
+    int capacity;
+    int count;
+    int *dense;     // Members, in insertion order
+    int *sparse;    // sparse[state] = position in dense
+} SparseSet;
+
+bool sparseSetInit(SparseSet *S, int capacity);
+bool sparseSetInitArena(SparseSet *S, int capacity, Arena *R); // Released with the arena
+void sparseSetFree(SparseSet *S);
+
+static inline void sparseSetClear(SparseSet *S) { S->count = 0; }
+
+static inline bool sparseSetContains(const SparseSet *S, int state) {
+    int pos = S->sparse[state];
+    return pos < S->count && S->dense[pos] == state;
+}
+
+static inline void sparseSetAdd(SparseSet *S, int state) {
+    if (!sparseSetContains(S, state)) {
+        S->sparse[state] = S->count;
+        S->dense[S->count++] = state;
+    }
+}
+
+// Sorts the members in place and reindexes them (canonical form)
+void sparseSetCanonicalize(SparseSet *S);
+
+// Dense bitsets pay n*k*ceil(n/64) words for precomputed successor sets;
+// below this budget they beat the sparse representation.
+bool preferBitsets(int num_states, int num_symbols);
+
+#endif // AUTOMATE_SET_H
@@ -0,0 +1,171 @@
+#include "AutomateStats.h"
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#define HAVE_RUSAGE 0
+#else
+#include <sys/resource.h>
+#define HAVE_RUSAGE 1
+#endif
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+#ifdef AUTOMATE_HAVE_THREADS
+#include <stdatomic.h>
+static atomic_size_t arena_bytes;
+static atomic_size_t arena_peak;
+#else
+static size_t arena_bytes;
+static size_t arena_peak;
+#endif
+
+static THREAD_LOCAL AutomateStats own;
+static THREAD_LOCAL AutomateStats *capture;
+
+static const char *phaseNames[NUM_PHASES] = {
+    "load", "epsilon_closure", "determinize", "determinize.successors", "determinize.explore", "determinize.output",
+    "standardize", "complete", "minimize", "minimize.setup", "minimize.refine", "minimize.quotient",
+    "minimize.brzozowski", "minimize.incremental", "trim", "product", "equivalence", "freeze", "match", "regex"
+};
+
+static const char *counterNames[NUM_COUNTERS] = {
+    "subsets", "subset_lookups", "subset_probes", "transitions", "refine_rounds", "block_splits", "arena_blocks"
+};
+
+static AutomateStats *current(void) {
+    return capture ? capture : &own;
+}
+
+// --- Probes ---
+
+double statsClock(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void statsPhase(StatsPhase phase, double start) {
+    AutomateStats *S = current();
+    S->seconds[phase] += statsClock() - start;
+    S->calls[phase]++;
+}
+
+void statsCount(StatsCounter counter, unsigned long long n) {
+    current()->counters[counter] += n;
+}
+
+void statsArenaChange(size_t added, size_t removed) {
+#ifdef AUTOMATE_HAVE_THREADS
+    size_t now = atomic_fetch_add(&arena_bytes, added) + added;
+    atomic_fetch_sub(&arena_bytes, removed);
+    size_t peak = atomic_load(&arena_peak);
+    while (now > peak && !atomic_compare_exchange_weak(&arena_peak, &peak, now)) {}
+#else
+    arena_bytes += added;
+    if (arena_bytes > arena_peak) arena_peak = arena_bytes;
+    arena_bytes -= removed;
+#endif
+}
+
+// --- Counters ---
+
+void statsReset(void) {
+    memset(current(), 0, sizeof(AutomateStats));
+#ifdef AUTOMATE_HAVE_THREADS
+    atomic_store(&arena_peak, atomic_load(&arena_bytes));
+#else
+    arena_peak = arena_bytes;
+#endif
+}
+
+void statsSnapshot(AutomateStats *S) {
+    *S = *current();
+}
+
+void statsMerge(const AutomateStats *S) {
+    AutomateStats *T = current();
+    for (int p = 0; p < NUM_PHASES; p++) {
+        T->seconds[p] += S->seconds[p];
+        T->calls[p] += S->calls[p];
+    }
+    for (int c = 0; c < NUM_COUNTERS; c++) T->counters[c] += S->counters[c];
+}
+
+void statsCaptureBegin(AutomateStats *C) {
+    memset(C, 0, sizeof(AutomateStats));
+    capture = C;
+}
+
+void statsCaptureEnd(void) {
+    capture = NULL;
+}
+
+// --- Memory ---
+
+size_t statsArenaBytes(void) {
+    return arena_bytes;
+}
+
+size_t statsArenaPeak(void) {
+    return arena_peak;
+}
+
+size_t statsPeakRSS(void) {
+#if HAVE_RUSAGE
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;            // Bytes
+#else
+    return (size_t)usage.ru_maxrss * 1024;     // Kilobytes
+#endif
+#else
+    return 0;
+#endif
+}
+
+// --- Report ---
+
+const char *statsPhaseName(StatsPhase phase) {
+    return phaseNames[phase];
+}
+
+const char *statsCounterName(StatsCounter counter) {
+    return counterNames[counter];
+}
+
+void statsWriteJSON(const AutomateStats *S, FILE *out) {
+#ifdef AUTOMATE_STATS
+    fprintf(out, "{\n  \"enabled\": true,\n  \"phases\": {\n");
+#else
+    fprintf(out, "{\n  \"enabled\": false,\n  \"phases\": {\n");
+#endif
+    for (int p = 0; p < NUM_PHASES; p++) {
+        fprintf(out, "    \"%s\": { \"calls\": %lld, \"seconds\": %.6f }%s\n", phaseNames[p], S->calls[p],
+                S->seconds[p], p + 1 < NUM_PHASES ? "," : "");
+    }
+    fprintf(out, "  },\n  \"counters\": {\n");
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        fprintf(out, "    \"%s\": %llu%s\n", counterNames[c], S->counters[c], c + 1 < NUM_COUNTERS ? "," : "");
+    }
+    fprintf(out, "  },\n  \"memory\": {\n");
+    fprintf(out, "    \"arena_bytes\": %zu,\n", statsArenaBytes());
+    fprintf(out, "    \"peak_arena_bytes\": %zu,\n", statsArenaPeak());
+    fprintf(out, "    \"peak_rss_bytes\": %zu\n", statsPeakRSS());
+    fprintf(out, "  }\n}\n");
+}
+
+bool statsSave(const char *path) {
+    FILE *out = strcmp(path, "-") == 0 ? stderr : fopen(path, "w");
+    if (!out) return false;
+    AutomateStats S;
+    statsSnapshot(&S);
+    statsWriteJSON(&S, out);
+    if (out == stderr) return true;
+    return fclose(out) == 0;
+}
@@ -0,0 +1,107 @@
+#ifndef AUTOMATE_STATS_H
+#define AUTOMATE_STATS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// --- Instrumentation ---
+// Per-phase wall time and work counters of the transformations, gathered
+// when built with AUTOMATE_STATS (CMake option of the same name, on by
+// default). Without it the STATS_* macros expand to nothing, and the API
+// remains but reports zeros with "enabled": false.
+//
+// Counters are per thread. Parallel workers capture one task each, and
+// statsMerge() adds them into the totals of the thread that collects them, as
+// cacheAddStats() does for the cache counters. Phase times are therefore
+// summed over threads. Memory is process-wide: bytes held by arenas (scratch
+// space and arena automata) and, where the system reports it, the peak RSS.
+
+typedef enum {
+    PHASE_LOAD,
+    PHASE_EPSILON_CLOSURE,          // Closures computed when epsilon transitions are set
+    PHASE_DETERMINIZE,
+    PHASE_DETERMINIZE_SUCCESSORS,   // Per-(state, symbol) successor bitsets
+    PHASE_DETERMINIZE_EXPLORE,      // Subset construction proper
+    PHASE_DETERMINIZE_OUTPUT,       // DFA transitions and finals
+    PHASE_STANDARDIZE,
+    PHASE_COMPLETE,
+    PHASE_MINIMIZE,
+    PHASE_MINIMIZE_SETUP,           // Transition sorts, initial partition
+    PHASE_MINIMIZE_REFINE,
+    PHASE_MINIMIZE_QUOTIENT,
+    PHASE_MINIMIZE_BRZOZOWSKI,      // Both reversals and determinizations
+    PHASE_MINIMIZE_INCREMENTAL,     // Re-classifying the states an update affects
+    PHASE_TRIM,
+    PHASE_PRODUCT,
+    PHASE_EQUIVALENCE,              // Equivalence and inclusion checks
+    PHASE_FREEZE,
+    PHASE_MATCH,
+    PHASE_REGEX,                    // Parsing and Glushkov construction
+    NUM_PHASES
+} StatsPhase;
+
+typedef enum {
+    COUNT_SUBSETS,          // DFA states discovered by determinize()
+    COUNT_SUBSET_LOOKUPS,   // Subset table insertions (found or new), product tuples included
+    COUNT_SUBSET_PROBES,    // Slots inspected by those lookups
+    COUNT_TRANSITIONS,      // Transitions stored in built automata
+    COUNT_REFINE_ROUNDS,    // Splitters processed by minimize(), passes of the table-filling reference
+    COUNT_BLOCK_SPLITS,     // Blocks created by minimize(), finals / non-finals split included
+    COUNT_ARENA_BLOCKS,     // Blocks requested from the system by arenas
+    NUM_COUNTERS
+} StatsCounter;
+
+typedef struct {
+    double seconds[NUM_PHASES];
+    long long calls[NUM_PHASES];
+    unsigned long long counters[NUM_COUNTERS];
+} AutomateStats;
+
+// Zeroes the calling thread's counters and restarts the arena peak from the current usage
+void statsReset(void);
+// Copy of the calling thread's counters
+void statsSnapshot(AutomateStats *S);
+// Adds S into the calling thread's counters
+void statsMerge(const AutomateStats *S);
+
+// While a capture is active, the calling thread counts into C (zeroed first)
+void statsCaptureBegin(AutomateStats *C);
+void statsCaptureEnd(void);
+
+size_t statsArenaBytes(void);
+size_t statsArenaPeak(void);
+// Peak resident set size of the process, 0 when unknown
+size_t statsPeakRSS(void);
+
+// Writes S and the memory figures as a JSON object
+void statsWriteJSON(const AutomateStats *S, FILE *out);
+// Writes the calling thread's counters as JSON to `path` ("-" for stderr)
+bool statsSave(const char *path);
+
+const char *statsPhaseName(StatsPhase phase);
+const char *statsCounterName(StatsCounter counter);
+
+// --- Probes ---
+// Timers are doubles from statsClock(); STATS_END adds the elapsed time to a
+// phase and counts one call. Callers accumulate counters locally and report
+// them once, so nothing is called per transition or per probe.
+
+double statsClock(void);
+void statsPhase(StatsPhase phase, double start);
+void statsCount(StatsCounter counter, unsigned long long n);
+void statsArenaChange(size_t added, size_t removed);
+
+#ifdef AUTOMATE_STATS
+#define STATS_START(timer) double timer = statsClock()
+#define STATS_END(phase, timer) statsPhase(phase, timer)
+#define STATS_COUNT(counter, n) statsCount(counter, (unsigned long long)(n))
+#define STATS_ARENA(added, removed) statsArenaChange(added, removed)
+#else
+#define STATS_START(timer) ((void)0)
+#define STATS_END(phase, timer) ((void)0)
+#define STATS_COUNT(counter, n) ((void)0)
+#define STATS_ARENA(added, removed) ((void)0)
+#endif
+
+#endif // AUTOMATE_STATS_H
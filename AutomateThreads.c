@@ -0,0 +1,57 @@
+#include "AutomateThreads.h"
+#include <stdlib.h>
+
+#ifdef AUTOMATE_HAVE_THREADS
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+typedef struct {
+    atomic_int next;
+    int num_tasks;
+    ParallelTask task;
+    void *ctx;
+} TaskQueue;
+
+static void *worker(void *arg) {
+    TaskQueue *Q = arg;
+    int i;
+    while ((i = atomic_fetch_add(&Q->next, 1)) < Q->num_tasks) Q->task(Q->ctx, i);
+    return NULL;
+}
+
+void parallelFor(int num_tasks, int num_threads, ParallelTask task, void *ctx) {
+    if (num_threads > num_tasks) num_threads = num_tasks;
+    if (num_threads <= 1) {
+        for (int i = 0; i < num_tasks; i++) task(ctx, i);
+        return;
+    }
+
+    TaskQueue Q = { .num_tasks = num_tasks, .task = task, .ctx = ctx };
+    atomic_init(&Q.next, 0);
+    pthread_t *threads = malloc((num_threads - 1) * sizeof(pthread_t));
+    int started = 0;
+    // Threads that fail to start are simply missing: the caller drains the queue
+    while (threads && started < num_threads - 1 && pthread_create(&threads[started], NULL, worker, &Q) == 0) started++;
+    worker(&Q);
+    for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+    free(threads);
+}
+
+int hardwareThreads(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+#else
+
+void parallelFor(int num_tasks, int num_threads, ParallelTask task, void *ctx) {
+    (void)num_threads;
+    for (int i = 0; i < num_tasks; i++) task(ctx, i);
+}
+
+int hardwareThreads(void) {
+    return 1;
+}
+
+#endif
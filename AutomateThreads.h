@@ -0,0 +1,20 @@
+#ifndef AUTOMATE_THREADS_H
+#define AUTOMATE_THREADS_H
+
+#include <stdbool.h>
+
+// --- Parallel Tasks ---
+// Runs task(ctx, i) for every i in [0, num_tasks) on up to num_threads
+// threads (the caller included). Workers pull the next index from a shared
+// counter, so uneven tasks balance themselves. Built without thread support
+// (AUTOMATE_HAVE_THREADS undefined) or with num_threads <= 1, the tasks run
+// in order on the calling thread.
+
+typedef void (*ParallelTask)(void *ctx, int index);
+
+void parallelFor(int num_tasks, int num_threads, ParallelTask task, void *ctx);
+
+// Online processors, 1 when unknown or without thread support
+int hardwareThreads(void);
+
+#endif // AUTOMATE_THREADS_H
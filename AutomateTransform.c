@@ -1,296 +1,762 @@
 #include "AutomateTransform.h"
 #include "AutomateIO.h" // For logMessage if needed
+#include "AutomateAnalysis.h"
+#include "AutomateSet.h"
+#include "AutomateStats.h"
 #include <string.h>
 
+// Copies the epsilon transitions of `state` in A from `as` in the builder
+static bool copyEpsilon(const Automaton *A, int state, AutomatonBuilder *B, int as) {
+    int count;
+    const int *dests = epsilonTransitions(A, state, &count);
+    bool ok = true;
+    for (int k = 0; k < count && ok; k++) ok = builderAddEpsilon(B, as, dests[k]);
+    return ok;
+}
+
 bool complete(const Automaton *A, Automaton *out, FILE *logFile) {
-    if (!createAutomaton(out, A->num_states + 1, A->num_symbols)) return false;
+    STATS_START(timer);
+    if (!createAutomatonInArena(out, A->num_states + 1, A->num_symbols)) return false;
+    out->alphabet = A->alphabet;
     int trashState = A->num_states;
+    int total_cells = A->num_states * A->num_symbols;
 
     out->num_initials = A->num_initials;
-    out->initials = malloc(out->num_initials * sizeof(int));
-    if (out->num_initials > 0 && !out->initials) {
+    out->initials = automatonAlloc(out, out->num_initials * sizeof(int));
+    out->num_finals = A->num_finals;
+    out->finals = automatonAlloc(out, out->num_finals * sizeof(int));
+    if (!out->initials || !out->finals) {
         freeAutomaton(out);
         return false;
     }
     memcpy(out->initials, A->initials, out->num_initials * sizeof(int));
+    memcpy(out->finals, A->finals, out->num_finals * sizeof(int));
 
-    out->num_finals = A->num_finals;
-    out->finals = malloc(out->num_finals * sizeof(int));
-    if (out->num_finals > 0 && !out->finals) {
+    int expected = A->offsets ? A->offsets[total_cells] + total_cells : total_cells * 2;
+    AutomatonBuilder builder;
+    if (!builderInit(&builder, out->num_states, out->num_symbols, expected)) {
         freeAutomaton(out);
         return false;
     }
-    memcpy(out->finals, A->finals, out->num_finals * sizeof(int));
-
-    for (int i = 0; i < A->num_states; i++) {
-        for (int j = 0; j < A->num_symbols; j++) {
-            int idx = i * A->num_symbols + j;
-            if (A->transitions[idx].count == 0) {
-                if (!addTransition(out, i, j, trashState)) {
-                    freeAutomaton(out);
-                    return false;
-                }
+    bool ok = true;
+    for (int i = 0; i < A->num_states && ok; i++) {
+        for (int j = 0; j < A->num_symbols && ok; j++) {
+            int count;
+            const int *dests = cellTransitions(A, i * A->num_symbols + j, &count);
+            if (count == 0) {
+                ok = builderAdd(&builder, i, j, trashState);
             } else {
-                for(int k=0; k < A->transitions[idx].count; k++) {
-                    if (!addTransition(out, i, j, A->transitions[idx].destinations[k])) {
-                        freeAutomaton(out);
-                        return false;
-                    }
-                }
+                for (int k = 0; k < count && ok; k++) ok = builderAdd(&builder, i, j, dests[k]);
             }
         }
     }
-    for (int j = 0; j < A->num_symbols; j++) {
-        if (!addTransition(out, trashState, j, trashState)) {
-            freeAutomaton(out);
-            return false;
-        }
+    for (int j = 0; j < A->num_symbols && ok; j++) {
+        ok = builderAdd(&builder, trashState, j, trashState);
+    }
+    for (int i = 0; i < A->num_states && ok; i++) ok = copyEpsilon(A, i, &builder, i);
+    if (!ok || !builderFreeze(&builder, out)) {
+        builderFree(&builder);
+        freeAutomaton(out);
+        return false;
     }
+    STATS_END(PHASE_COMPLETE, timer);
     return true;
 }
 
 bool standardize(const Automaton *A, Automaton *out, FILE *logFile) {
-    if (!createAutomaton(out, A->num_states + 1, A->num_symbols)) return false;
+    STATS_START(timer);
+    if (!createAutomatonInArena(out, A->num_states + 1, A->num_symbols)) return false;
+    out->alphabet = A->alphabet;
     int newInit = A->num_states;
+    int total_cells = A->num_states * A->num_symbols;
 
     out->num_initials = 1;
-    out->initials = malloc(sizeof(int));
-    if (!out->initials) {
+    out->initials = automatonAlloc(out, sizeof(int));
+    out->num_finals = A->num_finals;
+    out->finals = automatonAlloc(out, (A->num_finals + 1) * sizeof(int));
+    if (!out->initials || !out->finals) {
         freeAutomaton(out);
         return false;
     }
     out->initials[0] = newInit;
+    memcpy(out->finals, A->finals, A->num_finals * sizeof(int));
 
-    for(int i=0; i<A->num_states; i++) {
-        for(int j=0; j<A->num_symbols; j++) {
-            int idx = i * A->num_symbols + j;
-            for(int k=0; k<A->transitions[idx].count; k++) {
-                if (!addTransition(out, i, j, A->transitions[idx].destinations[k])) {
-                    freeAutomaton(out);
-                    return false;
-                }
-            }
+    bool initIsFinal = false;
+    for(int i=0; i<A->num_initials; i++) {
+        if (arrayContains(A->finals, A->num_finals, A->initials[i])) {
+            initIsFinal = true; break;
         }
     }
+    if (initIsFinal) out->finals[out->num_finals++] = newInit;
 
-    out->num_finals = A->num_finals;
-    out->finals = malloc((A->num_finals + 1) * sizeof(int));
-    if (!out->finals) {
+    int expected = A->offsets ? A->offsets[total_cells] * 2 : total_cells * 2;
+    AutomatonBuilder builder;
+    if (!builderInit(&builder, out->num_states, out->num_symbols, expected)) {
         freeAutomaton(out);
         return false;
     }
-    memcpy(out->finals, A->finals, A->num_finals * sizeof(int));
+    bool ok = true;
+    for (int c = 0; c < total_cells && ok; c++) {
+        int count;
+        const int *dests = cellTransitions(A, c, &count);
+        for (int k = 0; k < count && ok; k++) ok = builderAdd(&builder, c / A->num_symbols, c % A->num_symbols, dests[k]);
+    }
+    for (int i = 0; i < A->num_states && ok; i++) ok = copyEpsilon(A, i, &builder, i);
 
-    bool initIsFinal = false;
-    for(int i=0; i<A->num_initials; i++) {
-        if (arrayContains(A->finals, A->num_finals, A->initials[i])) {
-            initIsFinal = true; break;
+    // The new initial state copies the outgoing transitions of every old one,
+    // epsilon ones included (duplicates are merged when the builder freezes)
+    for (int i = 0; i < A->num_initials && ok; i++) {
+        for (int j = 0; j < A->num_symbols && ok; j++) {
+            int count;
+            const int *dests = cellTransitions(A, A->initials[i] * A->num_symbols + j, &count);
+            for (int k = 0; k < count && ok; k++) ok = builderAdd(&builder, newInit, j, dests[k]);
         }
+        ok = ok && copyEpsilon(A, A->initials[i], &builder, newInit);
     }
-    if (initIsFinal) out->finals[out->num_finals++] = newInit;
+    if (!ok || !builderFreeze(&builder, out)) {
+        builderFree(&builder);
+        freeAutomaton(out);
+        return false;
+    }
+    STATS_END(PHASE_STANDARDIZE, timer);
+    return true;
+}
 
-    for(int j=0; j<A->num_symbols; j++) {
-        for(int i=0; i<A->num_initials; i++) {
-            int oldInit = A->initials[i];
-            int idx = oldInit * A->num_symbols + j;
-            for(int k=0; k<A->transitions[idx].count; k++) {
-                int dest = A->transitions[idx].destinations[k];
-                int newIdx = newInit * A->num_symbols + j;
-                bool exists = false;
-                for(int t=0; t<out->transitions[newIdx].count; t++) {
-                    if(out->transitions[newIdx].destinations[t] == dest) exists = true;
-                }
-                if(!exists) {
-                    if (!addTransition(out, newInit, j, dest)) {
-                        freeAutomaton(out);
-                        return false;
-                    }
-                }
+// --- Trimming ---
+// Keeps the chosen states, renumbered in their original order, with the
+// transitions between them. When none is left, the result is the one-state
+// empty form: initial if A had initial states, not final, no transitions.
+
+static bool keepStates(const Automaton *A, const bool *keep, Automaton *out) {
+    int n = A->num_states, k = A->num_symbols;
+    int *renumber = malloc(n * sizeof(int));
+    if (!renumber) return false;
+    int kept = 0;
+    for (int s = 0; s < n; s++) renumber[s] = keep[s] ? kept++ : -1;
+
+    bool ok = createAutomatonInArena(out, kept > 0 ? kept : 1, k);
+    if (!ok) {
+        free(renumber);
+        return false;
+    }
+    out->alphabet = A->alphabet;
+    out->initials = automatonAlloc(out, (A->num_initials > 0 ? A->num_initials : 1) * sizeof(int));
+    out->finals = automatonAlloc(out, (A->num_finals > 0 ? A->num_finals : 1) * sizeof(int));
+    ok = out->initials && out->finals;
+    if (ok && kept == 0) {
+        if (A->num_initials > 0) out->initials[out->num_initials++] = 0;
+        free(renumber);
+        return true;
+    }
+    for (int i = 0; ok && i < A->num_initials; i++) {
+        if (renumber[A->initials[i]] >= 0) out->initials[out->num_initials++] = renumber[A->initials[i]];
+    }
+    for (int i = 0; ok && i < A->num_finals; i++) {
+        if (renumber[A->finals[i]] >= 0) out->finals[out->num_finals++] = renumber[A->finals[i]];
+    }
+
+    AutomatonBuilder builder;
+    int total_cells = n * k;
+    int expected = A->offsets ? A->offsets[total_cells] : total_cells;
+    ok = ok && builderInit(&builder, out->num_states, k, expected);
+    if (!ok) {
+        free(renumber);
+        freeAutomaton(out);
+        return false;
+    }
+    for (int s = 0; s < n && ok; s++) {
+        if (renumber[s] < 0) continue;
+        for (int sym = 0; sym < k && ok; sym++) {
+            int count;
+            const int *dests = cellTransitions(A, s * k + sym, &count);
+            for (int t = 0; t < count && ok; t++) {
+                if (renumber[dests[t]] >= 0) ok = builderAdd(&builder, renumber[s], sym, renumber[dests[t]]);
             }
         }
+        int count;
+        const int *dests = epsilonTransitions(A, s, &count);
+        for (int t = 0; t < count && ok; t++) {
+            if (renumber[dests[t]] >= 0) ok = builderAddEpsilon(&builder, renumber[s], renumber[dests[t]]);
+        }
+    }
+    free(renumber);
+    if (!ok || !builderFreeze(&builder, out)) {
+        builderFree(&builder);
+        freeAutomaton(out);
+        return false;
     }
     return true;
 }
 
-typedef struct { int *states; int count; } Subset;
+bool trim(const Automaton *A, Automaton *out, FILE *logFile) {
+    (void)logFile;
+    STATS_START(timer);
+    bool *useful = malloc(A->num_states * sizeof(bool));
+    bool *coreachable = malloc(A->num_states * sizeof(bool));
+    bool ok = useful && coreachable && markUsefulStates(A, useful, coreachable);
+    if (ok) {
+        for (int s = 0; s < A->num_states; s++) useful[s] = useful[s] && coreachable[s];
+        ok = keepStates(A, useful, out);
+    }
+    free(useful);
+    free(coreachable);
+    STATS_END(PHASE_TRIM, timer);
+    return ok;
+}
+
+bool removeUnreachable(const Automaton *A, Automaton *out, FILE *logFile) {
+    (void)logFile;
+    STATS_START(timer);
+    bool *reachable = malloc(A->num_states * sizeof(bool));
+    bool ok = reachable && markUsefulStates(A, reachable, NULL) && keepStates(A, reachable, out);
+    free(reachable);
+    STATS_END(PHASE_TRIM, timer);
+    return ok;
+}
+
+// True when some state cannot be reached from an initial one
+static bool hasUnreachable(const Automaton *A, bool *unreachable) {
+    bool *reachable = malloc(A->num_states * sizeof(bool));
+    if (!reachable || !markUsefulStates(A, reachable, NULL)) {
+        free(reachable);
+        return false;
+    }
+    *unreachable = false;
+    for (int s = 0; s < A->num_states && !*unreachable; s++) *unreachable = !reachable[s];
+    free(reachable);
+    return true;
+}
+
+// --- Determinization (subset construction) ---
+// Every subset is kept in canonical form and interned in a SubsetTable, so
+// checking whether a target subset was already discovered is an expected
+// O(|subset|) hash lookup. Table ids double as the DFA state numbers, in
+// discovery order. Small NFAs use bitset subsets: the target over a symbol
+// is the word-wise OR of precomputed per-(state, symbol) successor bitsets.
+// Larger NFAs fall back to sorted state lists built with a sparse set.
+// With epsilon transitions, subsets are closed: the successor bitsets, and
+// each destination added by subsetStep(), already include their closures
+// (precomputed with the automaton), so no subset is ever re-closed.
+
+// `out` only ever holds whole closures, and a closure contains the closures
+// of its members: a state already present brings nothing new.
+void subsetAddClosure(const Automaton *A, int state, SparseSet *out) {
+    if (!hasEpsilon(A) || sparseSetContains(out, state)) {
+        sparseSetAdd(out, state);
+        return;
+    }
+    int count;
+    const int *closure = epsilonClosure(A, state, &count);
+    for (int i = 0; i < count; i++) sparseSetAdd(out, closure[i]);
+}
+
+void subsetStart(const Automaton *A, SparseSet *out) {
+    sparseSetClear(out);
+    for (int i = 0; i < A->num_initials; i++) subsetAddClosure(A, A->initials[i], out);
+    sparseSetCanonicalize(out);
+}
 
-static bool areSubsetsEqual(Subset *a, Subset *b) {
-    if (a->count != b->count) return false;
-    for (int i=0; i<a->count; i++) {
-        bool found = false;
-        for (int j=0; j<b->count; j++) {
-            if (a->states[i] == b->states[j]) { found = true; break; }
+void subsetStep(const Automaton *A, const int *states, int count, int symbol, SparseSet *out) {
+    sparseSetClear(out);
+    for (int i = 0; i < count; i++) {
+        int num_dests;
+        const int *dests = cellTransitions(A, states[i] * A->num_symbols + symbol, &num_dests);
+        for (int t = 0; t < num_dests; t++) subsetAddClosure(A, dests[t], out);
+    }
+    sparseSetCanonicalize(out);
+}
+
+bool subsetIsFinal(const int *states, int count, const Bitset *finals) {
+    for (int i = 0; i < count; i++) {
+        if (bitsetContains(finals, states[i])) return true;
+    }
+    return false;
+}
+
+// succ[(state * k + symbol) * W ...] = successors of state over symbol,
+// closed under epsilon transitions
+static uint64_t *buildSuccessorBitsets(const Automaton *A, Arena *R) {
+    int k = A->num_symbols, W = BITSET_WORDS(A->num_states);
+    size_t cells = (size_t)A->num_states * k;
+    uint64_t *succ = arenaCalloc(R, cells * W > 0 ? cells * W : 1, sizeof(uint64_t));
+    if (!succ) return NULL;
+    for (size_t c = 0; c < cells; c++) {
+        int count;
+        const int *dests = cellTransitions(A, (int)c, &count);
+        uint64_t *row = succ + c * W;
+        for (int t = 0; t < count; t++) {
+            int closure_count = 1;
+            const int *closure = hasEpsilon(A) ? epsilonClosure(A, dests[t], &closure_count) : &dests[t];
+            for (int i = 0; i < closure_count; i++) row[closure[i] >> 6] |= (uint64_t)1 << (closure[i] & 63);
         }
-        if (!found) return false;
     }
+    return succ;
+}
+
+bool createDeterministic(Automaton *out, int num_states, int k, const int *trans, int num_initials) {
+    if (!createAutomatonInArena(out, num_states, k)) return false;
+    size_t cells = (size_t)num_states * k;
+    int m = 0;
+    for (size_t c = 0; c < cells; c++) m += trans[c] != -1;
+
+    out->num_initials = num_initials;
+    out->initials = automatonAlloc(out, (num_initials > 0 ? num_initials : 1) * sizeof(int));
+    out->finals = automatonAlloc(out, num_states * sizeof(int));
+    out->offsets = automatonAlloc(out, (cells + 1) * sizeof(int));
+    out->targets = automatonAlloc(out, (m > 0 ? m : 1) * sizeof(int));
+    if (!out->initials || !out->finals || !out->offsets || !out->targets) {
+        freeAutomaton(out);
+        return false;
+    }
+    m = 0;
+    for (size_t c = 0; c < cells; c++) {
+        out->offsets[c] = m;
+        if (trans[c] != -1) out->targets[m++] = trans[c];
+    }
+    out->offsets[cells] = m;
+    STATS_COUNT(COUNT_TRANSITIONS, m);
     return true;
 }
 
 bool determinize(const Automaton *A, Automaton *out, FILE *logFile) {
-    int capacity = 64; 
-    Subset *subsets = malloc(capacity * sizeof(Subset));
-    if (!subsets) return false;
-    int num_subsets = 0;
-    int **tempTrans = malloc(capacity * sizeof(int*));
-    if (!tempTrans) {
-        free(subsets);
+    STATS_START(timer);
+    bool ok = false;
+    int n = A->num_states, k = A->num_symbols;
+    bool dense = preferBitsets(n, k);
+    int W = BITSET_WORDS(n);
+
+    // Every temporary below lives in `scratch` and goes away in one release
+    Arena scratch;
+    SubsetTable table;
+    if (!arenaInit(&scratch, (size_t)n * 64)) return false;
+    if (!subsetTableInit(&table, 64)) {
+        arenaRelease(&scratch);
         return false;
     }
-    for(int i=0; i<capacity; i++) {
-        tempTrans[i] = malloc(A->num_symbols * sizeof(int));
-        if (!tempTrans[i]) {
-            // cleanup
-            for(int j=0; j<i; j++) free(tempTrans[j]);
-            free(tempTrans);
-            free(subsets);
-            return false;
+
+    int trans_capacity = 64;
+    int *trans = arenaAlloc(&scratch, trans_capacity * (k > 0 ? k : 1) * sizeof(int)); // DFA transitions, -1 = none
+    Bitset bits, finalBits;
+    SparseSet sparse;
+    uint64_t *succ = NULL;
+    if (!trans || !bitsetInitArena(&finalBits, n, &scratch)) goto cleanup;
+    for (int i = 0; i < A->num_finals; i++) bitsetAdd(&finalBits, A->finals[i]);
+
+    if (dense) {
+        STATS_START(successors);
+        succ = buildSuccessorBitsets(A, &scratch);
+        STATS_END(PHASE_DETERMINIZE_SUCCESSORS, successors);
+        if (!succ || !bitsetInitArena(&bits, n, &scratch)) goto cleanup;
+        for (int i = 0; i < A->num_initials; i++) {
+            int count = 1;
+            const int *closure = hasEpsilon(A) ? epsilonClosure(A, A->initials[i], &count) : &A->initials[i];
+            for (int j = 0; j < count; j++) bitsetAdd(&bits, closure[j]);
         }
-        for(int s=0; s<A->num_symbols; s++) tempTrans[i][s] = -1;
-    }
-
-    Subset initSubset = {NULL, 0};
-    for (int i=0; i<A->num_initials; i++) addUnique(&initSubset.states, &initSubset.count, A->initials[i]);
-    subsets[num_subsets++] = initSubset;
-
-    int processed = 0;
-    while (processed < num_subsets) {
-        if (num_subsets >= capacity - 1) {
-            capacity *= 2;
-            subsets = realloc(subsets, capacity * sizeof(Subset));
-            if (!subsets) {
-                // cleanup
-                for(int i=0; i<num_subsets; i++) free(subsets[i].states);
-                for(int i=0; i<capacity/2; i++) free(tempTrans[i]);
-                free(tempTrans);
-                return false;
-            }
-            tempTrans = realloc(tempTrans, capacity * sizeof(int*));
-            if (!tempTrans) {
-                free(subsets);
-                return false;
-            }
-            for(int k=num_subsets; k<capacity; k++) {
-                tempTrans[k] = malloc(A->num_symbols * sizeof(int));
-                if (!tempTrans[k]) {
-                    // cleanup
-                    for(int j=0; j<k; j++) free(tempTrans[j]);
-                    free(tempTrans);
-                    free(subsets);
-                    return false;
-                }
-                for(int s=0; s<A->num_symbols; s++) tempTrans[k][s] = -1;
-            }
+        if (subsetTableInsert(&table, bits.words, W * sizeof(uint64_t), NULL) < 0) goto cleanup;
+    } else {
+        if (!sparseSetInitArena(&sparse, n, &scratch)) goto cleanup;
+        subsetStart(A, &sparse);
+        if (subsetTableInsert(&table, sparse.dense, sparse.count * sizeof(int), NULL) < 0) goto cleanup;
+    }
+
+    STATS_START(explore);
+    for (int processed = 0; processed < table.count; processed++) {
+        if (table.count > trans_capacity) {
+            int old_capacity = trans_capacity;
+            while (trans_capacity < table.count) trans_capacity *= 2;
+            int *temp = arenaAlloc(&scratch, trans_capacity * (k > 0 ? k : 1) * sizeof(int));
+            if (!temp) goto cleanup;
+            memcpy(temp, trans, old_capacity * k * sizeof(int));
+            trans = temp;
         }
 
-        Subset current = subsets[processed];
-        for (int sym = 0; sym < A->num_symbols; sym++) {
-            Subset target = {NULL, 0};
-            for (int k = 0; k < current.count; k++) {
-                int state = current.states[k];
-                int idx = state * A->num_symbols + sym;
-                TransitionList *tl = &A->transitions[idx];
-                for (int t = 0; t < tl->count; t++) {
-                    addUnique(&target.states, &target.count, tl->destinations[t]);
-                }
-            }
+        for (int sym = 0; sym < k; sym++) {
+            // The key may move when the table grows, so re-fetch it per symbol
+            size_t size;
+            const void *current = subsetTableKey(&table, processed, &size);
+            int id = -1;
 
-            if (target.count > 0) {
-                int foundIdx = -1;
-                for (int existing = 0; existing < num_subsets; existing++) {
-                    if (areSubsetsEqual(&target, &subsets[existing])) {
-                        foundIdx = existing; break;
+            if (dense) {
+                const uint64_t *words = current;
+                bitsetClear(&bits);
+                for (int w = 0; w < W; w++) {
+                    for (uint64_t word = words[w]; word; word &= word - 1) {
+                        int state = w * 64 + lowestBit(word);
+                        bitsetUnionWords(&bits, succ + ((size_t)state * k + sym) * W);
                     }
                 }
-                if (foundIdx == -1) {
-                    foundIdx = num_subsets;
-                    subsets[num_subsets++] = target;
-                } else {
-                    free(target.states);
+                if (!bitsetIsEmpty(&bits)) {
+                    id = subsetTableInsert(&table, bits.words, W * sizeof(uint64_t), NULL);
+                    if (id < 0) goto cleanup;
                 }
-                tempTrans[processed][sym] = foundIdx;
             } else {
-                 free(target.states);
+                subsetStep(A, current, (int)(size / sizeof(int)), sym, &sparse);
+                if (sparse.count > 0) {
+                    id = subsetTableInsert(&table, sparse.dense, sparse.count * sizeof(int), NULL);
+                    if (id < 0) goto cleanup;
+                }
             }
+            trans[processed * k + sym] = id;
         }
-        processed++;
     }
+    STATS_END(PHASE_DETERMINIZE_EXPLORE, explore);
 
-    if (!createAutomaton(out, num_subsets, A->num_symbols)) {
-        // cleanup
-        for(int i=0; i<num_subsets; i++) free(subsets[i].states);
-        for(int i=0; i<capacity; i++) free(tempTrans[i]);
-        free(subsets);
-        free(tempTrans);
-        return false;
-    }
-    out->num_initials = 1;
-    out->initials = malloc(sizeof(int));
-    if (!out->initials) {
-        freeAutomaton(out);
-        // cleanup
-        for(int i=0; i<num_subsets; i++) free(subsets[i].states);
-        for(int i=0; i<capacity; i++) free(tempTrans[i]);
-        free(subsets);
-        free(tempTrans);
-        return false;
-    }
+    STATS_START(output);
+    if (!createDeterministic(out, table.count, k, trans, 1)) goto cleanup;
     out->initials[0] = 0;
+    out->alphabet = A->alphabet;
 
-    for(int i=0; i<num_subsets; i++) {
+    for (int i = 0; i < table.count; i++) {
+        size_t size;
+        const void *subset = subsetTableKey(&table, i, &size);
         bool isFinal = false;
-        for(int k=0; k<subsets[i].count; k++) {
-            if (arrayContains(A->finals, A->num_finals, subsets[i].states[k])) {
-                isFinal = true; break;
-            }
+        if (dense) {
+            isFinal = bitsetIntersects(&finalBits, subset);
+        } else {
+            isFinal = subsetIsFinal(subset, (int)(size / sizeof(int)), &finalBits);
         }
-        if (isFinal) {
-            int *new_finals = realloc(out->finals, (out->num_finals + 1) * sizeof(int));
-            if (!new_finals) {
-                freeAutomaton(out);
-                // cleanup
-                for(int j=0; j<num_subsets; j++) free(subsets[j].states);
-                for(int j=0; j<capacity; j++) free(tempTrans[j]);
-                free(subsets);
-                free(tempTrans);
-                return false;
-            }
-            out->finals = new_finals;
-            out->finals[out->num_finals++] = i;
+        if (isFinal) out->finals[out->num_finals++] = i;
+    }
+    STATS_END(PHASE_DETERMINIZE_OUTPUT, output);
+    ok = true;
+
+cleanup:
+    STATS_COUNT(COUNT_SUBSETS, table.count);
+    STATS_COUNT(COUNT_SUBSET_LOOKUPS, table.lookups);
+    STATS_COUNT(COUNT_SUBSET_PROBES, table.probes);
+    subsetTableFree(&table);
+    arenaRelease(&scratch);
+    STATS_END(PHASE_DETERMINIZE, timer);
+    return ok;
+}
+
+// --- Minimization (Hopcroft / Valmari-Lehtinen partition refinement) ---
+// O(m log n) for m transitions. Works on partial DFAs: a missing transition
+// behaves like a distinct dead state, exactly as in the table-filling
+// reference below, so both produce the same partition and numbering.
+
+typedef struct {
+    int z;          // Number of sets
+    int *elems;     // Elements grouped by set
+    int *loc;       // loc[e] = position of e in elems
+    int *sidx;      // sidx[e] = set of e
+    int *first;     // Set s occupies elems[first[s] .. past[s])
+    int *past;
+    int *marked;    // Marked elements sit at the front of their set
+    int *touched;   // Sets with at least one marked element
+    int w;
+} Partition;
+
+static bool partitionInit(Partition *P, int n, Arena *R) {
+    int size = n > 0 ? n : 1;
+    P->z = n > 0;
+    P->w = 0;
+    P->elems = arenaAlloc(R, size * sizeof(int));
+    P->loc = arenaAlloc(R, size * sizeof(int));
+    P->sidx = arenaCalloc(R, size, sizeof(int));
+    P->first = arenaCalloc(R, size, sizeof(int));
+    P->past = arenaCalloc(R, size, sizeof(int));
+    P->marked = arenaCalloc(R, size, sizeof(int));
+    P->touched = arenaAlloc(R, size * sizeof(int));
+    if (!P->elems || !P->loc || !P->sidx || !P->first || !P->past || !P->marked || !P->touched) return false;
+    for (int i = 0; i < n; i++) P->elems[i] = P->loc[i] = i;
+    P->past[0] = n;
+    return true;
+}
+
+static void partitionMark(Partition *P, int e) {
+    int s = P->sidx[e], i = P->loc[e], j = P->first[s] + P->marked[s];
+    P->elems[i] = P->elems[j]; P->loc[P->elems[i]] = i;
+    P->elems[j] = e; P->loc[e] = j;
+    if (!P->marked[s]++) P->touched[P->w++] = s;
+}
+
+// Splits every touched set into marked/unmarked; the smaller part gets the new id
+static void partitionSplit(Partition *P) {
+    while (P->w) {
+        int s = P->touched[--P->w], j = P->first[s] + P->marked[s];
+        if (j == P->past[s]) { P->marked[s] = 0; continue; }
+        int z = P->z;
+        if (P->marked[s] <= P->past[s] - j) {
+            P->first[z] = P->first[s]; P->past[z] = P->first[s] = j;
+        } else {
+            P->past[z] = P->past[s]; P->first[z] = P->past[s] = j;
         }
-        for(int sym=0; sym<A->num_symbols; sym++) {
-            if (tempTrans[i][sym] != -1) {
-                if (!addTransition(out, i, sym, tempTrans[i][sym])) {
-                    freeAutomaton(out);
-                    // cleanup
-                    for(int j=0; j<num_subsets; j++) free(subsets[j].states);
-                    for(int j=0; j<capacity; j++) free(tempTrans[j]);
-                    free(subsets);
-                    free(tempTrans);
-                    return false;
-                }
+        for (int i = P->first[z]; i < P->past[z]; i++) P->sidx[P->elems[i]] = z;
+        P->marked[s] = P->marked[z] = 0;
+        P->z++;
+    }
+}
+
+// Builds `out` from a state -> block map. Blocks are renumbered by their
+// smallest state, and that state is the representative of its group.
+static bool buildQuotient(const Automaton *A, const int *block, int num_blocks, Automaton *out, Arena *scratch) {
+    int n = A->num_states, k = A->num_symbols;
+    int size = num_blocks > 0 ? num_blocks : 1;
+    int *group = arenaAlloc(scratch, size * sizeof(int));        // block -> group
+    int *rep = arenaAlloc(scratch, size * sizeof(int));          // group -> representative
+    bool *group_final = arenaCalloc(scratch, size, sizeof(bool));
+    if (!group || !rep || !group_final) return false;
+
+    for (int b = 0; b < num_blocks; b++) group[b] = -1;
+    int num_groups = 0;
+    for (int s = 0; s < n; s++) {
+        if (group[block[s]] == -1) {
+            rep[num_groups] = s;
+            group[block[s]] = num_groups++;
+        }
+    }
+
+    int *trans = arenaAlloc(scratch, ((size_t)num_groups * k + 1) * sizeof(int));
+    if (!trans) return false;
+    for (int g = 0; g < num_groups; g++) {
+        for (int sym = 0; sym < k; sym++) {
+            int count;
+            const int *dests = cellTransitions(A, rep[g] * k + sym, &count);
+            trans[g * k + sym] = count > 0 ? group[block[dests[0]]] : -1;
+        }
+    }
+
+    if (!createDeterministic(out, num_groups, k, trans, A->num_initials)) return false;
+    out->alphabet = A->alphabet;
+    for (int i = 0; i < A->num_initials; i++) out->initials[i] = group[block[A->initials[i]]];
+    for (int i = 0; i < A->num_finals; i++) group_final[group[block[A->finals[i]]]] = true;
+    for (int g = 0; g < num_groups; g++) {
+        if (group_final[g]) out->finals[out->num_finals++] = g;
+    }
+    return true;
+}
+
+// Coarsest partition of the n states compatible with the finals and the m
+// transitions tail[t] --label[t]--> head[t] (at most one per state and
+// label); blocks->sidx[s] is then the block of state s.
+static bool refinePartition(int n, int k, int m, const int *tail, const int *label, const int *head,
+                            const bool *isFinal, Partition *blocks, Arena *scratch) {
+    STATS_START(setup);
+    Partition cords;
+    int *incoming = arenaAlloc(scratch, (m > 0 ? m : 1) * sizeof(int));  // Transitions sorted by head
+    int *in_offset = arenaCalloc(scratch, n + 1, sizeof(int));            // Per head state
+    int *label_offset = arenaCalloc(scratch, k + 1, sizeof(int));
+    int *fill = arenaAlloc(scratch, ((n > k ? n : k) + 1) * sizeof(int));
+    if (!incoming || !in_offset || !label_offset || !fill) return false;
+    if (!partitionInit(blocks, n, scratch) || !partitionInit(&cords, m, scratch)) return false;
+
+    for (int t = 0; t < m; t++) {
+        in_offset[head[t] + 1]++;
+        label_offset[label[t] + 1]++;
+    }
+    for (int s = 0; s < n; s++) in_offset[s + 1] += in_offset[s];
+    for (int sym = 0; sym < k; sym++) label_offset[sym + 1] += label_offset[sym];
+
+    // Counting sorts: incoming transitions per head, and cords per label
+    memcpy(fill, in_offset, n * sizeof(int));
+    for (int t = 0; t < m; t++) incoming[fill[head[t]]++] = t;
+    memcpy(fill, label_offset, k * sizeof(int));
+    for (int t = 0; t < m; t++) {
+        int pos = fill[label[t]]++;
+        cords.elems[pos] = t;
+        cords.loc[t] = pos;
+    }
+    if (m > 0) {
+        cords.z = 0;
+        for (int sym = 0; sym < k; sym++) {
+            if (label_offset[sym] == label_offset[sym + 1]) continue;
+            cords.first[cords.z] = label_offset[sym];
+            cords.past[cords.z] = label_offset[sym + 1];
+            for (int i = label_offset[sym]; i < label_offset[sym + 1]; i++) cords.sidx[cords.elems[i]] = cords.z;
+            cords.z++;
+        }
+    }
+
+    // Initial partition: finals / non-finals
+    for (int s = 0; s < n; s++) {
+        if (isFinal[s]) partitionMark(blocks, s);
+    }
+    partitionSplit(blocks);
+    STATS_END(PHASE_MINIMIZE_SETUP, setup);
+
+    // Block 0 never needs to split cords: the leftover of each cord covers it
+    STATS_START(refine);
+    int b = 1, c = 0;
+    while (c < cords.z) {
+        for (int i = cords.first[c]; i < cords.past[c]; i++) partitionMark(blocks, tail[cords.elems[i]]);
+        partitionSplit(blocks);
+        c++;
+        while (b < blocks->z) {
+            for (int i = blocks->first[b]; i < blocks->past[b]; i++) {
+                int s = blocks->elems[i];
+                for (int j = in_offset[s]; j < in_offset[s + 1]; j++) partitionMark(&cords, incoming[j]);
             }
+            partitionSplit(&cords);
+            b++;
         }
-        free(subsets[i].states);
-        free(tempTrans[i]);
     }
-    free(subsets);
-    free(tempTrans);
+    STATS_COUNT(COUNT_REFINE_ROUNDS, c);
+    STATS_COUNT(COUNT_BLOCK_SPLITS, blocks->z > 0 ? blocks->z - 1 : 0);
+    STATS_END(PHASE_MINIMIZE_REFINE, refine);
     return true;
 }
 
+bool coarsestPartition(int n, int k, const int *trans, const bool *isFinal, int *block, int *num_blocks) {
+    Arena scratch;
+    if (!arenaInit(&scratch, (size_t)n * k * 4 * sizeof(int) + 4096)) return false;
+    int m = 0;
+    for (size_t c = 0; c < (size_t)n * k; c++) m += trans[c] != -1;
+    int *tail = arenaAlloc(&scratch, (m > 0 ? m : 1) * sizeof(int));
+    int *label = arenaAlloc(&scratch, (m > 0 ? m : 1) * sizeof(int));
+    int *head = arenaAlloc(&scratch, (m > 0 ? m : 1) * sizeof(int));
+    Partition blocks;
+    bool ok = tail && label && head;
+    if (ok) {
+        int t = 0;
+        for (size_t c = 0; c < (size_t)n * k; c++) {
+            if (trans[c] == -1) continue;
+            tail[t] = (int)(c / k);
+            label[t] = (int)(c % k);
+            head[t++] = trans[c];
+        }
+        ok = refinePartition(n, k, m, tail, label, head, isFinal, &blocks, &scratch);
+    }
+    if (ok) {
+        memcpy(block, blocks.sidx, n * sizeof(int));
+        *num_blocks = blocks.z;
+    }
+    arenaRelease(&scratch);
+    return ok;
+}
+
 bool minimize(const Automaton *A, Automaton *out, FILE *logFile) {
-    // Assume A is DFA
-    int n = A->num_states;
-    bool **distinguishable = malloc(n * sizeof(bool*));
-    if (!distinguishable) return false;
-    for (int i = 0; i < n; i++) {
-        distinguishable[i] = calloc(n, sizeof(bool)); // false by default
-        if (!distinguishable[i]) {
-            for (int j = 0; j < i; j++) free(distinguishable[j]);
-            free(distinguishable);
-            return false;
+    // Only destinations[0] of each cell is read: refuse anything but a DFA
+    if (!isDeterministic(A, logFile)) {
+        logAt(LOG_ERROR, logFile, "Erreur : la minimisation demande un automate deterministe\n");
+        return false;
+    }
+    STATS_START(timer);
+    bool ok = false;
+    int n = A->num_states, k = A->num_symbols;
+    Partition blocks;
+    Arena scratch;
+    if (!arenaInit(&scratch, (size_t)n * k * 8 * sizeof(int))) return false;
+
+    // Transitions t: tail[t] --label[t]--> head[t]
+    int m = 0;
+    for (int c = 0; c < n * k; c++) {
+        if (cellCount(A, c) > 0) m++;
+    }
+    int *tail = arenaAlloc(&scratch, (m > 0 ? m : 1) * sizeof(int));
+    int *label = arenaAlloc(&scratch, (m > 0 ? m : 1) * sizeof(int));
+    int *head = arenaAlloc(&scratch, (m > 0 ? m : 1) * sizeof(int));
+    bool *isFinal = arenaCalloc(&scratch, n > 0 ? n : 1, sizeof(bool));
+    if (!tail || !label || !head || !isFinal) goto cleanup;
+
+    int t = 0;
+    for (int s = 0; s < n; s++) {
+        for (int sym = 0; sym < k; sym++) {
+            int count;
+            const int *dests = cellTransitions(A, s * k + sym, &count);
+            if (count == 0) continue;
+            tail[t] = s;
+            label[t] = sym;
+            head[t++] = dests[0];
+        }
+    }
+    for (int i = 0; i < A->num_finals; i++) isFinal[A->finals[i]] = true;
+    if (!refinePartition(n, k, m, tail, label, head, isFinal, &blocks, &scratch)) goto cleanup;
+
+    STATS_START(quotient);
+    ok = buildQuotient(A, blocks.sidx, blocks.z, out, &scratch);
+    STATS_END(PHASE_MINIMIZE_QUOTIENT, quotient);
+
+cleanup:
+    arenaRelease(&scratch);
+    STATS_END(PHASE_MINIMIZE, timer);
+    return ok;
+}
+
+// --- Brzozowski minimization ---
+// determinize(reverse(determinize(reverse(A)))): the subset construction of
+// the reverse of an accessible DFA is minimal. Works on any NFA, epsilon
+// transitions included, with no separate determinization or refinement,
+// and is often faster than both when the NFA's DFA blows up but its
+// reverse's does not. The result is trim: no sink state.
+
+bool reverse(const Automaton *A, Automaton *out, FILE *logFile) {
+    (void)logFile;
+    int n = A->num_states, k = A->num_symbols;
+    if (!createAutomatonInArena(out, n, k)) return false;
+    out->alphabet = A->alphabet;
+    out->initials = automatonAlloc(out, (A->num_finals > 0 ? A->num_finals : 1) * sizeof(int));
+    out->finals = automatonAlloc(out, (A->num_initials > 0 ? A->num_initials : 1) * sizeof(int));
+    if (!out->initials || !out->finals) {
+        freeAutomaton(out);
+        return false;
+    }
+    memcpy(out->initials, A->finals, A->num_finals * sizeof(int));
+    out->num_initials = A->num_finals;
+    memcpy(out->finals, A->initials, A->num_initials * sizeof(int));
+    out->num_finals = A->num_initials;
+
+    AutomatonBuilder builder;
+    int expected = A->offsets ? A->offsets[n * k] : n * k;
+    bool ok = builderInit(&builder, n, k, expected);
+    for (int s = 0; s < n && ok; s++) {
+        for (int sym = 0; sym < k && ok; sym++) {
+            int count;
+            const int *dests = cellTransitions(A, s * k + sym, &count);
+            for (int t = 0; t < count && ok; t++) ok = builderAdd(&builder, dests[t], sym, s);
         }
+        int count;
+        const int *dests = epsilonTransitions(A, s, &count);
+        for (int t = 0; t < count && ok; t++) ok = builderAddEpsilon(&builder, dests[t], s);
     }
+    if (!ok || !builderFreeze(&builder, out)) {
+        builderFree(&builder);
+        freeAutomaton(out);
+        return false;
+    }
+    return true;
+}
+
+bool minimizeBrzozowski(const Automaton *A, Automaton *out, FILE *logFile) {
+    STATS_START(timer);
+    Automaton first, second;
+    bool ok = reverse(A, &first, logFile);
+    for (int pass = 0; ok && pass < 2; pass++) {
+        // first -> determinized -> reversed back into first, then the last
+        // determinization into out
+        ok = determinize(&first, pass == 0 ? &second : out, logFile);
+        freeAutomaton(&first);
+        if (ok && pass == 0) {
+            ok = reverse(&second, &first, logFile);
+            freeAutomaton(&second);
+        }
+    }
+    STATS_END(PHASE_MINIMIZE_BRZOZOWSKI, timer);
+    return ok;
+}
+
+// --- Reference minimization (table filling) ---
+// O(n^2) memory, kept to cross-check minimize() on generated automata.
+
+bool minimizeTableFilling(const Automaton *A, Automaton *out, FILE *logFile) {
+    // Reads one destination per cell, as minimize() does: DFAs only
+    if (!isDeterministic(A, logFile)) {
+        logAt(LOG_ERROR, logFile, "Erreur : la minimisation demande un automate deterministe\n");
+        return false;
+    }
+    int n = A->num_states;
+    Arena scratch;
+    if (!arenaInit(&scratch, (size_t)n * n + (size_t)n * 16)) return false;
+
+    bool **distinguishable = arenaAlloc(&scratch, (n > 0 ? n : 1) * sizeof(bool*));
+    bool *rows = arenaCalloc(&scratch, (size_t)n * n + 1, sizeof(bool)); // false by default
+    int *group = arenaAlloc(&scratch, (n > 0 ? n : 1) * sizeof(int));
+    bool *visited = arenaCalloc(&scratch, n > 0 ? n : 1, sizeof(bool));
+    if (!distinguishable || !rows || !group || !visited) {
+        arenaRelease(&scratch);
+        return false;
+    }
+    for (int i = 0; i < n; i++) distinguishable[i] = rows + (size_t)i * n;
 
     // Mark distinguishable if one final, one not
     for (int i = 0; i < n; i++) {
@@ -306,6 +772,7 @@ bool minimize(const Automaton *A, Automaton *out, FILE *logFile) {
 
     bool changed = true;
     while (changed) {
+        STATS_COUNT(COUNT_REFINE_ROUNDS, 1);
         changed = false;
         for (int i = 0; i < n; i++) {
             for (int j = i + 1; j < n; j++) {
@@ -313,8 +780,11 @@ bool minimize(const Automaton *A, Automaton *out, FILE *logFile) {
                     for (int sym = 0; sym < A->num_symbols; sym++) {
                         int idx_i = i * A->num_symbols + sym;
                         int idx_j = j * A->num_symbols + sym;
-                        int dest_i = A->transitions[idx_i].count > 0 ? A->transitions[idx_i].destinations[0] : -1;
-                        int dest_j = A->transitions[idx_j].count > 0 ? A->transitions[idx_j].destinations[0] : -1;
+                        int count_i, count_j;
+                        const int *dests_i = cellTransitions(A, idx_i, &count_i);
+                        const int *dests_j = cellTransitions(A, idx_j, &count_j);
+                        int dest_i = count_i > 0 ? dests_i[0] : -1;
+                        int dest_j = count_j > 0 ? dests_j[0] : -1;
                         if (dest_i != dest_j && (dest_i == -1 || dest_j == -1 || distinguishable[dest_i][dest_j])) {
                             distinguishable[i][j] = true;
                             distinguishable[j][i] = true;
@@ -328,21 +798,7 @@ bool minimize(const Automaton *A, Automaton *out, FILE *logFile) {
     }
 
     // Now, group indistinguishable states
-    int *group = malloc(n * sizeof(int));
-    if (!group) {
-        for (int i = 0; i < n; i++) free(distinguishable[i]);
-        free(distinguishable);
-        return false;
-    }
     int num_groups = 0;
-    bool *visited = calloc(n, sizeof(bool));
-    if (!visited) {
-        free(group);
-        for (int i = 0; i < n; i++) free(distinguishable[i]);
-        free(distinguishable);
-        return false;
-    }
-
     for (int i = 0; i < n; i++) {
         if (!visited[i]) {
             group[i] = num_groups;
@@ -358,93 +814,100 @@ bool minimize(const Automaton *A, Automaton *out, FILE *logFile) {
     }
 
     // Create minimized automaton
-    if (!createAutomaton(out, num_groups, A->num_symbols)) {
-        free(visited);
-        free(group);
-        for (int i = 0; i < n; i++) free(distinguishable[i]);
-        free(distinguishable);
-        return false;
-    }
+    bool ok = buildQuotient(A, group, num_groups, out, &scratch);
+    arenaRelease(&scratch);
+    return ok;
+}
 
-    // Set initials
-    out->num_initials = A->num_initials;
-    out->initials = malloc(out->num_initials * sizeof(int));
-    if (!out->initials) {
-        freeAutomaton(out);
-        free(visited);
-        free(group);
-        for (int i = 0; i < n; i++) free(distinguishable[i]);
-        free(distinguishable);
-        return false;
-    }
-    for (int i = 0; i < A->num_initials; i++) {
-        out->initials[i] = group[A->initials[i]];
+// --- Pipelines ---
+
+static const char *stepNames[] = { "determinize", "standardize", "complete", "minimize", "trim", "brzozowski" };
+static const char *stepLabels[] = {
+    "Determinisation", "Standardisation", "Completion", "Minimisation", "Emondage", "Minimisation (Brzozowski)"
+};
+static const char *stepFailures[] = {
+    "determinisation", "standardisation", "completion", "minimisation", "emondage", "minimisation (Brzozowski)"
+};
+#define NUM_STEPS ((int)(sizeof(stepNames) / sizeof(stepNames[0])))
+
+bool parsePipeline(const char *spec, Pipeline *P) {
+    P->num_steps = 0;
+    const char *p = spec;
+    while (*p) {
+        size_t len = strcspn(p, ",");
+        int step = -1;
+        for (int i = 0; i < NUM_STEPS; i++) {
+            if (strlen(stepNames[i]) == len && strncmp(p, stepNames[i], len) == 0) step = i;
+        }
+        if (step < 0 || P->num_steps == PIPELINE_MAX_STEPS) return false;
+        P->steps[P->num_steps++] = (TransformStep)step;
+        p += len;
+        if (*p == ',') p++;
     }
+    return P->num_steps > 0;
+}
 
-    // Set finals
-    bool *group_final = calloc(num_groups, sizeof(bool));
-    if (!group_final) {
-        freeAutomaton(out);
-        free(visited);
-        free(group);
-        for (int i = 0; i < n; i++) free(distinguishable[i]);
-        free(distinguishable);
-        return false;
+void pipelineName(const Pipeline *P, char *buffer, size_t size) {
+    size_t used = 0;
+    buffer[0] = '\0';
+    for (int i = 0; i < P->num_steps && used < size; i++) {
+        int n = snprintf(buffer + used, size - used, "%s%s", i > 0 ? "," : "", stepNames[P->steps[i]]);
+        if (n < 0) break;
+        used += (size_t)n;
     }
-    for (int i = 0; i < A->num_finals; i++) {
-        group_final[group[A->finals[i]]] = true;
+}
+
+static bool stepNeeded(const Automaton *A, TransformStep step, FILE *logFile) {
+    switch (step) {
+        case STEP_DETERMINIZE: return !isDeterministic(A, logFile);
+        case STEP_STANDARDIZE: return !isStandard(A, logFile);
+        case STEP_COMPLETE: return !isComplete(A, logFile);
+        case STEP_TRIM: return !isTrim(A, logFile);
+        default: return true;
     }
-    for (int g = 0; g < num_groups; g++) {
-        if (group_final[g]) {
-            int *new_finals = realloc(out->finals, (out->num_finals + 1) * sizeof(int));
-            if (!new_finals) {
-                free(group_final);
-                freeAutomaton(out);
-                free(visited);
-                free(group);
-                for (int i = 0; i < n; i++) free(distinguishable[i]);
-                free(distinguishable);
-                return false;
-            }
-            out->finals = new_finals;
-            out->finals[out->num_finals++] = g;
+}
+
+static bool applyStep(Automaton *A, TransformStep step, FILE *logFile) {
+    if (step == STEP_MINIMIZE && stepNeeded(A, STEP_DETERMINIZE, logFile) &&
+        !applyStep(A, STEP_DETERMINIZE, logFile)) return false;
+    // Unreachable states only slow minimize() down: drop them first (the
+    // reachable part of a complete DFA is still complete)
+    bool unreachable = false;
+    if (step == STEP_MINIMIZE && hasUnreachable(A, &unreachable) && unreachable) {
+        Automaton reachable;
+        if (!removeUnreachable(A, &reachable, logFile)) {
+            freeAutomaton(A);
+            logAt(LOG_ERROR, logFile, "Erreur : Echec de la %s\n", stepFailures[step]);
+            return false;
         }
+        freeAutomaton(A);
+        *A = reachable;
     }
 
-    // Set transitions
-    for (int g = 0; g < num_groups; g++) {
-        for (int sym = 0; sym < A->num_symbols; sym++) {
-            // Find a representative state in the group
-            int rep = -1;
-            for (int s = 0; s < n; s++) {
-                if (group[s] == g) {
-                    rep = s;
-                    break;
-                }
-            }
-            if (rep != -1) {
-                int idx = rep * A->num_symbols + sym;
-                if (A->transitions[idx].count > 0) {
-                    int dest = A->transitions[idx].destinations[0];
-                    int dest_group = group[dest];
-                    if (!addTransition(out, g, sym, dest_group)) {
-                        free(group_final);
-                        freeAutomaton(out);
-                        free(visited);
-                        free(group);
-                        for (int i = 0; i < n; i++) free(distinguishable[i]);
-                        free(distinguishable);
-                        return false;
-                    }
-                }
-            }
-        }
+    logMessage(logFile, "\n>>> Transformation : %s\n", stepLabels[step]);
+    Automaton result;
+    bool ok = false;
+    switch (step) {
+        case STEP_DETERMINIZE: ok = determinize(A, &result, logFile); break;
+        case STEP_STANDARDIZE: ok = standardize(A, &result, logFile); break;
+        case STEP_COMPLETE: ok = complete(A, &result, logFile); break;
+        case STEP_MINIMIZE: ok = minimize(A, &result, logFile); break;
+        case STEP_TRIM: ok = trim(A, &result, logFile); break;
+        case STEP_BRZOZOWSKI: ok = minimizeBrzozowski(A, &result, logFile); break;
     }
+    freeAutomaton(A);
+    if (!ok) {
+        logAt(LOG_ERROR, logFile, "Erreur : Echec de la %s\n", stepFailures[step]);
+        return false;
+    }
+    *A = result;
+    printAutomaton(A, logFile);
+    return true;
+}
 
-    free(group_final);
-    free(visited);
-    free(group);
-    for (int i = 0; i < n; i++) free(distinguishable[i]);
-    free(distinguishable);
+bool applyPipeline(Automaton *A, const Pipeline *P, FILE *logFile) {
+    for (int i = 0; i < P->num_steps; i++) {
+        if (stepNeeded(A, P->steps[i], logFile) && !applyStep(A, P->steps[i], logFile)) return false;
+    }
     return true;
-}
\ No newline at end of file
+}
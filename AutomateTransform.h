@@ -2,11 +2,74 @@
 #define AUTOMATE_TRANSFORM_H
 
 #include "AutomateCore.h"
+#include "AutomateSet.h"
 #include <stdio.h>
 
 bool determinize(const Automaton *A, Automaton *out, FILE *logFile);
 bool standardize(const Automaton *A, Automaton *out, FILE *logFile);
 bool complete(const Automaton *A, Automaton *out, FILE *logFile);
+// DFAs only (fails on anything else); a missing transition counts as a
+// distinct dead state
 bool minimize(const Automaton *A, Automaton *out, FILE *logFile);
+// Any NFA: determinize(reverse(determinize(reverse(A)))), trim result
+bool minimizeBrzozowski(const Automaton *A, Automaton *out, FILE *logFile);
+// Initials and finals swapped, every transition (epsilon ones too) turned around
+bool reverse(const Automaton *A, Automaton *out, FILE *logFile);
+bool minimizeTableFilling(const Automaton *A, Automaton *out, FILE *logFile);
+// Keeps the useful states (reachable and co-reachable), in linear time; a
+// complete DFA loses its sink state. An empty language leaves one state
+// with no final and no transition.
+bool trim(const Automaton *A, Automaton *out, FILE *logFile);
+// Keeps the reachable states only: the language and completeness are unchanged
+bool removeUnreachable(const Automaton *A, Automaton *out, FILE *logFile);
+
+// Creates `out` (arena-backed) with at most one destination per cell:
+// trans[state * k + symbol], -1 = no transition. CSR arrays are filled
+// directly; initials (num_initials slots) and finals are left for the caller.
+bool createDeterministic(Automaton *out, int num_states, int k, const int *trans, int num_initials);
+// The partition refinement behind minimize(), on a table laid out as above:
+// block[state] receives the state's Myhill-Nerode class, in [0, *num_blocks)
+bool coarsestPartition(int n, int k, const int *trans, const bool *isFinal, int *block, int *num_blocks);
+
+// --- Subset Construction Steps ---
+// Used by determinize() on large NFAs and by the lazy DFA. Subsets are
+// canonical (sorted) state lists, closed under epsilon transitions; `out`
+// holds the result in canonical form.
+// Adds `state` and its epsilon closure to `out`, which must only hold
+// closures (as every subset built with these functions does)
+void subsetAddClosure(const Automaton *A, int state, SparseSet *out);
+void subsetStart(const Automaton *A, SparseSet *out);
+void subsetStep(const Automaton *A, const int *states, int count, int symbol, SparseSet *out);
+bool subsetIsFinal(const int *states, int count, const Bitset *finals);
+
+// --- Pipelines ---
+// A sequence of transformations written "determinize,standardize,complete"
+// (steps: determinize, standardize, complete, minimize, brzozowski, trim).
+// Each step only runs when needed (determinize on a non-deterministic
+// automaton, and so on), and minimize determinizes and drops unreachable
+// states first when it has to; brzozowski minimizes NFAs directly. Every
+// applied step is logged with the resulting automaton.
+
+typedef enum {
+    STEP_DETERMINIZE,
+    STEP_STANDARDIZE,
+    STEP_COMPLETE,
+    STEP_MINIMIZE,
+    STEP_TRIM,
+    STEP_BRZOZOWSKI
+} TransformStep;
+
+#define PIPELINE_MAX_STEPS 16
+
+typedef struct {
+    int num_steps;
+    TransformStep steps[PIPELINE_MAX_STEPS];
+} Pipeline;
+
+bool parsePipeline(const char *spec, Pipeline *P);
+// Canonical spelling, as accepted by parsePipeline (used in cache keys)
+void pipelineName(const Pipeline *P, char *buffer, size_t size);
+// Transforms A in place; A is freed on failure
+bool applyPipeline(Automaton *A, const Pipeline *P, FILE *logFile);
 
 #endif // AUTOMATE_TRANSFORM_H
\ No newline at end of file
@@ -3,55 +3,86 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <dirent.h>
+#include <time.h>
 
 #include "AutomateCore.h"
 #include "AutomateIO.h"
 #include "AutomateAnalysis.h"
 #include "AutomateTransform.h"
+#include "AutomateDFA.h"
+#include "AutomateMatch.h"
+#include "AutomateThreads.h"
+#include "AutomateCache.h"
+#include "AutomateStats.h"
+#include "AutomateProduct.h"
+#include "AutomateEquiv.h"
+#include "AutomateRegex.h"
 
 // --- Helper Local ---
 
-void processAutomaton(const char *filepath, FILE *logFile) {
-    Automaton A;
-    if (!loadAutomaton(filepath, &A, logFile)) return;
+// Transformations of the interactive mode (and their cache key)
+#define TRANSFORM_PIPELINE "determinize,standardize,complete"
 
-    logMessage(logFile, "\n=== Analyse de : %s ===\n", filepath);
-    printAutomaton(&A, logFile);
+// Applies P to A in place through the cache (A is freed on failure)
+static bool transformCached(Automaton *A, const char *filepath, const Pipeline *P, TransformCache *cache, FILE *logFile) {
+    char name[256];
+    pipelineName(P, name, sizeof(name));
+    CacheKey key;
+    Automaton stored;
+    bool keyed = cache->mode != CACHE_BYPASS && cacheKeyOf(A, name, &key);
+    bool hit = keyed && cacheLookup(cache, filepath, &key, &stored, logFile);
 
-    if (!isDeterministic(&A, logFile)) {
-        logMessage(logFile, "\n>>> Transformation : Determinisation\n");
-        Automaton det;
-        if (!determinize(&A, &det, logFile)) {
-            logMessage(logFile, "Erreur : Echec de la determinisation\n");
-            freeAutomaton(&A);
-            return;
-        }
-        freeAutomaton(&A); A = det;
-        printAutomaton(&A, logFile);
+    if (hit && cache->mode == CACHE_USE) {
+        logMessage(logFile, "\n>>> Cache : transformations deja calculees, resultat charge\n");
+        freeAutomaton(A); *A = stored;
+        printAutomaton(A, logFile);
+        return true;
     }
-    if (!isStandard(&A, logFile)) {
-        logMessage(logFile, "\n>>> Transformation : Standardisation\n");
-        Automaton std;
-        if (!standardize(&A, &std, logFile)) {
-            logMessage(logFile, "Erreur : Echec de la standardisation\n");
-            freeAutomaton(&A);
-            return;
-        }
-        freeAutomaton(&A); A = std;
-        printAutomaton(&A, logFile);
+    if (!applyPipeline(A, P, logFile)) {
+        if (hit) freeAutomaton(&stored);
+        return false;
     }
-    if (!isComplete(&A, logFile)) {
-        logMessage(logFile, "\n>>> Transformation : Completion\n");
-        Automaton comp;
-        if (!complete(&A, &comp, logFile)) {
-            logMessage(logFile, "Erreur : Echec de la completion\n");
-            freeAutomaton(&A);
-            return;
-        }
-        freeAutomaton(&A); A = comp;
-        printAutomaton(&A, logFile);
+    bool fresh = !hit;
+    if (hit) {
+        fresh = !sameAutomaton(A, &stored);
+        if (fresh) cache->stale++;
+        logMessage(logFile, fresh ? "\n>>> Cache : entree perimee, remplacee\n" : "\n>>> Cache : entree verifiee\n");
+        freeAutomaton(&stored);
     }
+    if (keyed && fresh) cacheStore(cache, filepath, &key, A, logFile);
+    return true;
+}
+
+// One automaton of the menu: prepared (loaded, transformed, frozen) possibly
+// on a worker thread, then tested interactively on the main thread.
+typedef struct {
+    const char *path;
+    TransformCache cache;   // Worker's private counters
+    LogCapture log;
+    AutomateStats stats;
+    bool ready;
+    Automaton A;
+    DenseDFA dfa;
+    bool frozen;
+} AutomatonJob;
+
+static void prepareAutomaton(AutomatonJob *J, TransformCache *cache, FILE *logFile) {
+    J->ready = false;
+    if (!loadAutomaton(J->path, &J->A, logFile)) return;
 
+    logMessage(logFile, "\n=== Analyse de : %s ===\n", J->path);
+    printAutomaton(&J->A, logFile);
+
+    Pipeline pipeline;
+    parsePipeline(TRANSFORM_PIPELINE, &pipeline);
+    if (!transformCached(&J->A, J->path, &pipeline, cache, logFile)) return;
+
+    // The pipeline leaves a DFA: match words on the frozen table
+    J->frozen = freezeDFA(&J->A, &J->dfa, logFile);
+    J->ready = true;
+}
+
+static void testWords(AutomatonJob *J, FILE *logFile) {
     while (1) {
         char buffer[256];
         logMessage(logFile, "\nTester un mot ? (entrez le mot ou 'vide' ou tapez Entree pour passer) : ");
@@ -60,29 +91,78 @@ void processAutomaton(const char *filepath, FILE *logFile) {
         char *word = buffer;
         if (strcmp(word, "vide") == 0) word = "";
 
-        if (recognizeWord(&A, word, logFile)) {
+        bool accepted = J->frozen ? recognizeWordDFA(&J->dfa, word) : recognizeWord(&J->A, word, logFile);
+        if (accepted) {
             logMessage(logFile, "Resultat : '%s' est ACCEPTE.\n", word);
         } else {
             logMessage(logFile, "Resultat : '%s' est REFUSE.\n", word);
         }
     }
-    freeAutomaton(&A);
+    if (J->frozen) freeDenseDFA(&J->dfa);
+    freeAutomaton(&J->A);
 }
 
-void processAllAutomata(FILE *logFile) {
+void processAutomaton(const char *filepath, TransformCache *cache, FILE *logFile) {
+    AutomatonJob job = { .path = filepath };
+    prepareAutomaton(&job, cache, logFile);
+    if (job.ready) testWords(&job, logFile);
+}
+
+typedef struct {
+    AutomatonJob *jobs;
+    FILE *logFile;
+} PrepareContext;
+
+static void prepareTask(void *ctx, int index) {
+    PrepareContext *P = ctx;
+    AutomatonJob *J = &P->jobs[index];
+    logCaptureBegin(&J->log);
+    statsCaptureBegin(&J->stats);
+    prepareAutomaton(J, &J->cache, P->logFile);
+    statsCaptureEnd();
+    logCaptureEnd();
+}
+
+// Files are prepared in windows of JOBS_PER_THREAD per thread, all at once;
+// each one's output is then replayed in directory order before its words
+// are asked for, exactly as a sequential run would print it.
+#define JOBS_PER_THREAD 8
+
+void processAllAutomata(TransformCache *cache, int threads, FILE *logFile) {
     char folderPath[512];
     if (!resolveAutomatesPath(folderPath, sizeof(folderPath), logFile)) return;
 
-    DIR *d = opendir(folderPath);
-    struct dirent *dir;
-    while ((dir = readdir(d)) != NULL) {
-        if (strstr(dir->d_name, ".txt")) {
-            char path[512];
-            snprintf(path, sizeof(path), "%s/%s", folderPath, dir->d_name);
-            processAutomaton(path, logFile);
+    FileList files = { 0 };
+    if (!listAutomatonFiles(folderPath, &files)) {
+        freeFileList(&files);
+        return;
+    }
+    if (threads < 1) threads = 1;
+    int window = threads * JOBS_PER_THREAD;
+    AutomatonJob *jobs = malloc(window * sizeof(AutomatonJob));
+    if (!jobs) {
+        freeFileList(&files);
+        return;
+    }
+
+    for (int first = 0; first < files.count; first += window) {
+        int count = files.count - first < window ? files.count - first : window;
+        for (int i = 0; i < count; i++) {
+            memset(&jobs[i], 0, sizeof(AutomatonJob));
+            jobs[i].path = files.paths[first + i];
+            cacheInit(&jobs[i].cache, cache->mode);
+        }
+        PrepareContext ctx = { jobs, logFile };
+        parallelFor(count, threads, prepareTask, &ctx);
+        for (int i = 0; i < count; i++) {
+            logReplay(&jobs[i].log, logFile);
+            cacheAddStats(cache, &jobs[i].cache);
+            statsMerge(&jobs[i].stats);
+            if (jobs[i].ready) testWords(&jobs[i], logFile);
         }
     }
-    closedir(d);
+    free(jobs);
+    freeFileList(&files);
 }
 
 static void resolveOutputPath(char *buffer, size_t size) {
@@ -103,7 +183,692 @@ static void resolveOutputPath(char *buffer, size_t size) {
     snprintf(buffer, size, "./%s/Exit.txt", targetFolder);
 }
 
-int main() {
+// --- Batch Mode ---
+// Automate --match <automate.txt | automate.dfa> [mots.txt | -] [--verdicts] [--threads N]
+// Classifies one word per line without logging; prints the counts, or one
+// 1/0 verdict per word with --verdicts. Uses every core unless --threads is given.
+// Automate --compile <automate.txt> <automate.dfa>
+// Determinizes, trims and minimizes once, then saves the frozen DFA in binary
+// form; --match maps such a file directly instead of rebuilding the DFA.
+
+// Replaces the DFA A with its trimmed minimal form (A is freed on failure).
+// Frozen tables need no sink state, and trimming first shrinks minimize()'s input.
+static bool trimAndMinimize(Automaton *A) {
+    Automaton trimmed, min;
+    bool ok = trim(A, &trimmed, NULL);
+    freeAutomaton(A);
+    if (!ok) return false;
+    ok = minimize(&trimmed, &min, NULL);
+    freeAutomaton(&trimmed);
+    if (ok) *A = min;
+    return ok;
+}
+
+// Text automaton -> determinized, trimmed, minimized, frozen DFA
+static bool buildDenseDFA(const char *automatonPath, DenseDFA *dfa) {
+    Automaton A;
+    if (!loadAutomaton(automatonPath, &A, NULL)) return false;
+    if (!isDeterministic(&A, NULL)) {
+        Automaton det;
+        if (!determinize(&A, &det, NULL)) {
+            freeAutomaton(&A);
+            return false;
+        }
+        freeAutomaton(&A); A = det;
+    }
+    if (!trimAndMinimize(&A)) return false;
+    bool ok = freezeDFA(&A, dfa, NULL);
+    freeAutomaton(&A);
+    return ok;
+}
+
+static int runCompileMode(int argc, char **argv) {
+    if (argc < 4) {
+        fprintf(stderr, "Usage : %s --compile <automate.txt> <automate.dfa>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    DenseDFA dfa;
+    if (!buildDenseDFA(argv[2], &dfa)) return EXIT_FAILURE;
+    bool ok = saveDenseDFA(&dfa, argv[3], NULL);
+    if (ok) printf("%s : %d etats, %d symboles\n", argv[3], dfa.num_states, dfa.num_symbols);
+    freeDenseDFA(&dfa);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int runMatchMode(int argc, char **argv) {
+    const char *automatonPath = argv[2];
+    const char *wordsPath = "-";
+    bool verdicts = false;
+    int threads = hardwareThreads();
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--verdicts") == 0) verdicts = true;
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else wordsPath = argv[i];
+    }
+
+    DenseDFA dfa;
+    BatchMatcher matcher;
+    bool ok = isDenseDFAFile(automatonPath) ? loadDenseDFA(automatonPath, &dfa, true, NULL)
+                                            : buildDenseDFA(automatonPath, &dfa);
+    if (!ok) return EXIT_FAILURE;
+    ok = buildBatchMatcher(&dfa, &matcher);
+    freeDenseDFA(&dfa);
+    if (!ok) {
+        fprintf(stderr, "Erreur : AFD trop grand pour la reconnaissance par lot\n");
+        return EXIT_FAILURE;
+    }
+
+    FILE *in = strcmp(wordsPath, "-") == 0 ? stdin : fopen(wordsPath, "rb");
+    if (!in) {
+        fprintf(stderr, "Erreur : Impossible d'ouvrir %s\n", wordsPath);
+        freeBatchMatcher(&matcher);
+        return EXIT_FAILURE;
+    }
+
+    BatchResult result;
+    initBatchResult(&result, verdicts);
+    ok = matchStreamParallel(&matcher, in, threads, &result);
+    if (in != stdin) fclose(in);
+
+    if (ok && verdicts) {
+        for (long long i = 0; i < result.num_words; i++) {
+            putchar(batchAccepted(&result, i) ? '1' : '0');
+            putchar('\n');
+        }
+    } else if (ok) {
+        printf("%lld mots, %lld acceptes, %lld refuses\n", result.num_words, result.num_accepted,
+               result.num_words - result.num_accepted);
+    } else {
+        fprintf(stderr, "Erreur : Echec de la lecture des mots\n");
+    }
+    freeBatchResult(&result);
+    freeBatchMatcher(&matcher);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- Headless Mode ---
+// Automate --run <automate.txt | dossier>... [--pipeline etapes] [--format text|dot|aut|dfa]
+//               [--output dossier] [--words mots.txt | -] [--verdicts] [--threads N]
+//               [--log fichier] [--log-level niveau] [--log-async] [--cache | --cache-check]
+//               [--stats fichier | -]
+// Applies a pipeline (default TRANSFORM_PIPELINE) to every input, folders
+// standing for their .txt files. Each result can be written to the output
+// folder (default ".") as <nom>.<format>, and can be matched against a list of
+// words, one per line, read once and shared by all inputs. Prints one line
+// per input, or the 1/0 verdicts with --verdicts, and a summary on stderr.
+// --stats writes the per-phase timings and counters of the run as JSON
+// (to stderr for "-").
+// Exit code: 0 when every input succeeded, 1 when one failed, 2 on bad usage.
+
+#define EXIT_USAGE 2
+
+typedef enum { OUTPUT_NONE, OUTPUT_TEXT, OUTPUT_DOT, OUTPUT_BINARY, OUTPUT_DFA } OutputFormat;
+
+typedef struct {
+    Pipeline pipeline;
+    OutputFormat format;
+    const char *output_dir;
+    bool has_words;
+    MappedFile words;
+    bool verdicts;
+    int threads;
+    int match_threads;      // All threads for a single input, one per input otherwise
+    TransformCache cache;
+    FILE *logFile;
+} BatchRun;
+
+static int comparePaths(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// A folder stands for its .txt files, in name order
+static bool addInputs(FileList *L, const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) return fileListAdd(L, path);
+    int first = L->count;
+    bool ok = listAutomatonFiles(path, L);
+    qsort(L->paths + first, L->count - first, sizeof(char *), comparePaths);
+    return ok;
+}
+
+// Words from a file (mapped) or from stdin ("-", read whole)
+static bool readWords(const char *path, MappedFile *F) {
+    if (strcmp(path, "-") != 0) return mapFile(path, F, true);
+    memset(F, 0, sizeof(MappedFile));
+    size_t size = 0, capacity = 1 << 16;
+    char *data = malloc(capacity);
+    while (data) {
+        size += fread(data + size, 1, capacity - size, stdin);
+        if (size < capacity) break;
+        char *temp = realloc(data, capacity * 2);
+        if (!temp) { free(data); data = NULL; break; }
+        data = temp;
+        capacity *= 2;
+    }
+    if (!data) return false;
+    F->data = data;
+    F->size = size;
+    return true;
+}
+
+// Frozen table of A, determinizing a copy first when A is an NFA
+static bool freezeResult(const Automaton *A, DenseDFA *dfa, FILE *logFile) {
+    if (isDeterministic(A, logFile)) return freezeDFA(A, dfa, logFile);
+    Automaton det;
+    if (!determinize(A, &det, logFile)) return false;
+    bool ok = freezeDFA(&det, dfa, logFile);
+    freeAutomaton(&det);
+    return ok;
+}
+
+static bool writeResult(const char *input, const Automaton *A, const DenseDFA *dfa, const BatchRun *R) {
+    static const char *extensions[] = { "", "txt", "dot", "aut", "dfa" };
+    const char *base = strrchr(input, '/');
+    base = base ? base + 1 : input;
+    const char *dot = strrchr(base, '.');
+    int len = dot ? (int)(dot - base) : (int)strlen(base);
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%.*s.%s", R->output_dir, len, base, extensions[R->format]);
+
+    // Never overwrite the input itself (text output next to it)
+    struct stat in_stat, out_stat;
+    if (stat(input, &in_stat) == 0 && stat(path, &out_stat) == 0 &&
+        in_stat.st_dev == out_stat.st_dev && in_stat.st_ino == out_stat.st_ino) {
+        logAt(LOG_ERROR, R->logFile, "Erreur : %s serait ecrase par son resultat.\n", input);
+        return false;
+    }
+
+    switch (R->format) {
+        case OUTPUT_TEXT: return saveAutomaton(A, path, R->logFile);
+        case OUTPUT_BINARY: return saveAutomatonBinary(A, path, R->logFile);
+        case OUTPUT_DFA: return saveDenseDFA(dfa, path, R->logFile);
+        case OUTPUT_DOT:
+            if (exportToDOT(A, path)) return true;
+            logAt(LOG_ERROR, R->logFile, "Erreur : Impossible d'ecrire %s\n", path);
+            return false;
+        default: return true;
+    }
+}
+
+static bool matchWords(const char *input, const DenseDFA *dfa, const BatchRun *R) {
+    BatchMatcher matcher;
+    if (!buildBatchMatcher(dfa, &matcher)) return false;
+    BatchResult result;
+    initBatchResult(&result, R->verdicts);
+    bool ok = matchBufferParallel(&matcher, R->words.data, R->words.size, R->match_threads, &result);
+    if (ok && R->verdicts) {
+        char *lines = malloc((size_t)result.num_words * 2 + 1);
+        ok = lines != NULL;
+        for (long long i = 0; ok && i < result.num_words; i++) {
+            lines[2 * i] = batchAccepted(&result, i) ? '1' : '0';
+            lines[2 * i + 1] = '\n';
+        }
+        if (ok) logOutputBytes(lines, (size_t)result.num_words * 2);
+        free(lines);
+    } else if (ok) {
+        logOutput("%s : %d etats, %lld mots, %lld acceptes, %lld refuses\n", input, dfa->num_states, result.num_words,
+                  result.num_accepted, result.num_words - result.num_accepted);
+    }
+    freeBatchResult(&result);
+    freeBatchMatcher(&matcher);
+    return ok;
+}
+
+static bool runBatchInput(const char *input, const BatchRun *R, TransformCache *cache) {
+    Automaton A;
+    if (!loadAutomaton(input, &A, R->logFile)) return false;
+    logMessage(R->logFile, "\n=== Analyse de : %s ===\n", input);
+    printAutomaton(&A, R->logFile);
+    if (!transformCached(&A, input, &R->pipeline, cache, R->logFile)) return false;
+
+    DenseDFA dfa;
+    bool frozen = (R->has_words || R->format == OUTPUT_DFA) && freezeResult(&A, &dfa, R->logFile);
+    bool ok = frozen || !(R->has_words || R->format == OUTPUT_DFA);
+    if (ok && R->format != OUTPUT_NONE) ok = writeResult(input, &A, &dfa, R);
+    if (ok && R->has_words) ok = matchWords(input, &dfa, R);
+    else if (ok && !R->verdicts) logOutput("%s : %d etats, %d symboles\n", input, A.num_states, A.num_symbols);
+    if (frozen) freeDenseDFA(&dfa);
+    freeAutomaton(&A);
+    return ok;
+}
+
+// Inputs run in parallel windows like the menu's files; each one's output is
+// captured and replayed in input order.
+typedef struct {
+    const char *input;
+    TransformCache cache;
+    LogCapture log;
+    AutomateStats stats;
+    bool ok;
+} BatchJob;
+
+typedef struct {
+    const BatchRun *run;
+    BatchJob *jobs;
+} BatchContext;
+
+static void batchTask(void *ctx, int index) {
+    BatchContext *C = ctx;
+    BatchJob *J = &C->jobs[index];
+    logCaptureBegin(&J->log);
+    statsCaptureBegin(&J->stats);
+    J->ok = runBatchInput(J->input, C->run, &J->cache);
+    statsCaptureEnd();
+    logCaptureEnd();
+}
+
+// Number of failed inputs, -1 when out of memory
+static int runBatchInputs(const FileList *inputs, BatchRun *R) {
+    int threads = R->threads > 1 ? R->threads : 1;
+    R->match_threads = inputs->count == 1 ? threads : 1;
+    int window = threads * JOBS_PER_THREAD;
+    BatchJob *jobs = malloc(window * sizeof(BatchJob));
+    if (!jobs) return -1;
+
+    int failures = 0;
+    for (int first = 0; first < inputs->count; first += window) {
+        int count = inputs->count - first < window ? inputs->count - first : window;
+        for (int i = 0; i < count; i++) {
+            memset(&jobs[i], 0, sizeof(BatchJob));
+            jobs[i].input = inputs->paths[first + i];
+            cacheInit(&jobs[i].cache, R->cache.mode);
+        }
+        BatchContext ctx = { R, jobs };
+        parallelFor(count, threads, batchTask, &ctx);
+        for (int i = 0; i < count; i++) {
+            logReplay(&jobs[i].log, R->logFile);
+            cacheAddStats(&R->cache, &jobs[i].cache);
+            statsMerge(&jobs[i].stats);
+            if (!jobs[i].ok) failures++;
+        }
+    }
+    free(jobs);
+    return failures;
+}
+
+static int batchUsage(const char *program) {
+    fprintf(stderr, "Usage : %s --run <automate.txt | dossier>... [--pipeline determinize,standardize,complete,minimize,brzozowski,trim]\n"
+                    "        [--format text|dot|aut|dfa] [--output dossier] [--words mots.txt | -] [--verdicts]\n"
+                    "        [--threads N] [--log fichier] [--log-level quiet|error|info|debug] [--log-async]\n"
+                    "        [--cache | --cache-check] [--stats fichier | -]\n", program);
+    return EXIT_USAGE;
+}
+
+static int runBatchMode(int argc, char **argv) {
+    static const char *formats[] = { "none", "text", "dot", "aut", "dfa" };
+    BatchRun R;
+    memset(&R, 0, sizeof(BatchRun));
+    parsePipeline(TRANSFORM_PIPELINE, &R.pipeline);
+    R.output_dir = ".";
+    R.threads = hardwareThreads();
+    cacheInit(&R.cache, CACHE_BYPASS);
+    LogOptions logOptions;
+    logDefaultOptions(&logOptions);
+    logOptions.level = LOG_ERROR;
+    const char *wordsPath = NULL, *logPath = NULL, *statsPath = NULL;
+    FileList inputs = { 0 };
+    int status = EXIT_USAGE;
+
+    for (int i = 2; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool takes_value = true;
+        if (strcmp(arg, "--pipeline") == 0 && value) {
+            if (!parsePipeline(value, &R.pipeline)) {
+                fprintf(stderr, "Erreur : Pipeline invalide '%s'\n", value);
+                goto cleanup;
+            }
+        } else if (strcmp(arg, "--format") == 0 && value) {
+            int f = 0;
+            while (f < 5 && strcmp(value, formats[f]) != 0) f++;
+            if (f == 5) {
+                fprintf(stderr, "Erreur : Format inconnu '%s' (text, dot, aut, dfa)\n", value);
+                goto cleanup;
+            }
+            R.format = (OutputFormat)f;
+        } else if (strcmp(arg, "--output") == 0 && value) {
+            R.output_dir = value;
+        } else if (strcmp(arg, "--words") == 0 && value) {
+            wordsPath = value;
+        } else if (strcmp(arg, "--threads") == 0 && value) {
+            R.threads = atoi(value);
+        } else if (strcmp(arg, "--log") == 0 && value) {
+            logPath = value;
+        } else if (strcmp(arg, "--stats") == 0 && value) {
+            statsPath = value;
+        } else if (strcmp(arg, "--log-level") == 0 && value) {
+            if (!logParseLevel(value, &logOptions.level)) {
+                fprintf(stderr, "Erreur : Niveau de log inconnu '%s' (quiet, error, info, debug)\n", value);
+                goto cleanup;
+            }
+        } else {
+            takes_value = false;
+            if (strcmp(arg, "--verdicts") == 0) R.verdicts = true;
+            else if (strcmp(arg, "--log-async") == 0) logOptions.async = true;
+            else if (strcmp(arg, "--cache") == 0) R.cache.mode = CACHE_USE;
+            else if (strcmp(arg, "--cache-check") == 0) R.cache.mode = CACHE_CHECK;
+            else if (strncmp(arg, "--", 2) == 0) {
+                batchUsage(argv[0]);
+                goto cleanup;
+            } else if (!addInputs(&inputs, arg)) {
+                fprintf(stderr, "Erreur : Memoire insuffisante\n");
+                status = EXIT_FAILURE;
+                goto cleanup;
+            }
+        }
+        if (takes_value) i++;
+    }
+    if (inputs.count == 0) {
+        batchUsage(argv[0]);
+        goto cleanup;
+    }
+
+    status = EXIT_FAILURE;
+    if (wordsPath) {
+        if (!readWords(wordsPath, &R.words)) {
+            fprintf(stderr, "Erreur : Impossible de lire %s\n", wordsPath);
+            goto cleanup;
+        }
+        R.has_words = true;
+    }
+    if (logPath && !(R.logFile = fopen(logPath, "w"))) {
+        fprintf(stderr, "Erreur : Impossible d'ouvrir %s\n", logPath);
+        goto cleanup;
+    }
+    logOpen(R.logFile, &logOptions);
+
+    struct timespec start, end;
+    statsReset();
+    timespec_get(&start, TIME_UTC);
+    int failures = runBatchInputs(&inputs, &R);
+    timespec_get(&end, TIME_UTC);
+    if (failures < 0) {
+        fprintf(stderr, "Erreur : Memoire insuffisante\n");
+        logClose();
+        goto cleanup;
+    }
+    double elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+    fflush(stdout);
+    fprintf(stderr, "%d automate(s), %d echec(s), %.3f s\n", inputs.count, failures, elapsed);
+    status = failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    if (statsPath && !statsSave(statsPath)) {
+        fprintf(stderr, "Erreur : Impossible d'ecrire %s\n", statsPath);
+        status = EXIT_FAILURE;
+    }
+    logClose();
+
+cleanup:
+    if (R.logFile) fclose(R.logFile);
+    if (R.has_words) unmapFile(&R.words);
+    freeFileList(&inputs);
+    return status;
+}
+
+// --- Product Mode ---
+// Automate --product <intersection|union|difference|symdiff> <resultat.txt | resultat.dfa>
+//                    <automate.txt | dossier>...
+// Combines every input (folders standing for their .txt files) in one n-ary
+// product: difference keeps the words of the first input that no other
+// accepts, symdiff those accepted by an odd number of inputs. Inputs are
+// determinized when needed and the result is trimmed and minimized, then
+// saved as text, or as a frozen DFA when the result path ends in ".dfa".
+
+// Loaded (and determinized) input, or false
+static bool loadDeterministic(const char *path, Automaton *A) {
+    if (!loadAutomaton(path, A, NULL)) return false;
+    if (isDeterministic(A, NULL)) return true;
+    Automaton det;
+    bool ok = determinize(A, &det, NULL);
+    freeAutomaton(A);
+    if (ok) *A = det;
+    return ok;
+}
+
+static int runProductMode(int argc, char **argv) {
+    ProductOp op;
+    if (argc < 5 || !parseProductOp(argv[2], &op)) {
+        fprintf(stderr, "Usage : %s --product <intersection|union|difference|symdiff> <resultat.txt | resultat.dfa> "
+                        "<automate.txt | dossier>...\n", argv[0]);
+        return EXIT_USAGE;
+    }
+    const char *outputPath = argv[3];
+    FileList inputs = { 0 };
+    for (int i = 4; i < argc; i++) {
+        if (!addInputs(&inputs, argv[i])) {
+            fprintf(stderr, "Erreur : Impossible de lire %s\n", argv[i]);
+            freeFileList(&inputs);
+            return EXIT_FAILURE;
+        }
+    }
+    if (inputs.count == 0) {
+        fprintf(stderr, "Erreur : Aucun automate a combiner\n");
+        freeFileList(&inputs);
+        return EXIT_FAILURE;
+    }
+
+    bool ok = false;
+    int loaded = 0;
+    Automaton product;
+    Automaton *automata = malloc(inputs.count * sizeof(Automaton));
+    const Automaton **views = malloc(inputs.count * sizeof(Automaton *));
+    if (!automata || !views) goto cleanup;
+    for (; loaded < inputs.count; loaded++) {
+        if (!loadDeterministic(inputs.paths[loaded], &automata[loaded])) {
+            fprintf(stderr, "Erreur : Impossible de charger %s\n", inputs.paths[loaded]);
+            goto cleanup;
+        }
+        views[loaded] = &automata[loaded];
+    }
+
+    if (!productAutomata(views, inputs.count, op, &product, NULL)) goto cleanup;
+    ok = trimAndMinimize(&product);
+    if (!ok) goto cleanup;
+
+    const char *extension = strrchr(outputPath, '.');
+    if (extension && strcmp(extension, ".dfa") == 0) {
+        DenseDFA dfa;
+        bool frozen = freezeDFA(&product, &dfa, NULL);
+        ok = frozen && saveDenseDFA(&dfa, outputPath, NULL);
+        if (frozen) freeDenseDFA(&dfa);
+    } else {
+        ok = saveAutomaton(&product, outputPath, NULL);
+    }
+    if (ok) printf("%s : %d etats, %d symboles\n", outputPath, product.num_states, product.num_symbols);
+    freeAutomaton(&product);
+
+cleanup:
+    for (int i = 0; i < loaded; i++) freeAutomaton(&automata[i]);
+    free(automata);
+    free(views);
+    freeFileList(&inputs);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- Language Checks ---
+// Automate --equiv <a.txt> <b.txt>      L(a) = L(b)
+// Automate --included <a.txt> <b.txt>   L(a) included in L(b)
+// Decided directly on the automata, DFAs or NFAs. When the answer is no, a
+// counterexample word is printed in the text-format spelling. Exit code, as
+// with diff: 0 when the property holds, 1 when it does not, 2 on error.
+
+static void printWord(const unsigned char *word, int length) {
+    putchar('"');
+    for (int i = 0; i < length; i++) {
+        char symbol[5];
+        formatSymbol(word[i], symbol);
+        fputs(symbol, stdout);
+    }
+    putchar('"');
+}
+
+static int runLanguageCheckMode(int argc, char **argv, bool equivalence) {
+    if (argc != 4) {
+        fprintf(stderr, "Usage : %s %s <a.txt> <b.txt>\n", argv[0], argv[1]);
+        return EXIT_USAGE;
+    }
+    Automaton A, B;
+    if (!loadAutomaton(argv[2], &A, NULL)) return EXIT_USAGE;
+    if (!loadAutomaton(argv[3], &B, NULL)) {
+        freeAutomaton(&A);
+        return EXIT_USAGE;
+    }
+    LanguageCheck R;
+    bool ok = equivalence ? checkEquivalence(&A, &B, &R, NULL) : checkInclusion(&A, &B, &R, NULL);
+    freeAutomaton(&A);
+    freeAutomaton(&B);
+    if (!ok) {
+        fprintf(stderr, "Erreur : Memoire insuffisante\n");
+        return EXIT_USAGE;
+    }
+    if (R.holds) {
+        printf("%s (%lld paires)\n", equivalence ? "equivalents" : "inclus", R.pairs);
+    } else {
+        printf("%s : ", equivalence ? "differents" : "non inclus");
+        printWord(R.word, R.length);
+        printf(" est accepte par %s, pas par %s (%lld paires)\n", R.in_first ? argv[2] : argv[3],
+               R.in_first ? argv[3] : argv[2], R.pairs);
+    }
+    int status = R.holds ? EXIT_SUCCESS : EXIT_FAILURE;
+    freeLanguageCheck(&R);
+    return status;
+}
+
+// Automate --language <automate.txt>
+// Emptiness, finiteness, a shortest accepted word and the number of useful
+// states, from one linear pass over the automaton.
+static int runLanguageMode(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage : %s --language <automate.txt>\n", argv[0]);
+        return EXIT_USAGE;
+    }
+    Automaton A;
+    if (!loadAutomaton(argv[2], &A, NULL)) return EXIT_FAILURE;
+    LanguageSummary S;
+    bool ok = summarizeLanguage(&A, &S, NULL);
+    if (ok) {
+        printf("vide : %s\n", S.empty ? "oui" : "non");
+        printf("fini : %s\n", S.finite ? "oui" : "non");
+        if (!S.empty) {
+            printf("plus court mot : ");
+            printWord(S.shortest_word, S.shortest_length);
+            printf(" (%d lettre(s))\n", S.shortest_length);
+        }
+        printf("etats utiles : %d / %d\n", S.num_useful, A.num_states);
+        freeLanguageSummary(&S);
+    } else {
+        fprintf(stderr, "Erreur : Memoire insuffisante\n");
+    }
+    freeAutomaton(&A);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- Regex Mode ---
+// Automate --regex <motif> <resultat.txt | resultat.dfa> [--alphabet lettres] [--pipeline etapes]
+// Compiles a regular expression (syntax in AutomateRegex.h) into its Glushkov
+// NFA, over the given letters or else the pattern's own. The pipeline, if
+// any, is applied to it; a ".dfa" result is then determinized when needed,
+// trimmed, minimized and frozen.
+static int runRegexMode(int argc, char **argv) {
+    const char *alphabetLetters = NULL;
+    const char *pipelineSpec = NULL;
+    bool usage = argc < 4;
+    for (int i = 4; i < argc && !usage; i += 2) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--alphabet") == 0 && value) alphabetLetters = value;
+        else if (strcmp(argv[i], "--pipeline") == 0 && value) pipelineSpec = value;
+        else usage = true;
+    }
+    if (usage) {
+        fprintf(stderr, "Usage : %s --regex <motif> <resultat.txt | resultat.dfa> [--alphabet lettres] "
+                        "[--pipeline etapes]\n", argv[0]);
+        return EXIT_USAGE;
+    }
+    const char *outputPath = argv[3];
+
+    Alphabet alphabet;
+    int num_symbols = alphabetLetters ? (int)strlen(alphabetLetters) : 0;
+    if (alphabetLetters && (num_symbols > ALPHABET_MAX ||
+                            !alphabetSet(&alphabet, (const unsigned char *)alphabetLetters, num_symbols))) {
+        fprintf(stderr, "Erreur : Alphabet invalide '%s'\n", alphabetLetters);
+        return EXIT_USAGE;
+    }
+    Pipeline pipeline = { 0 };
+    if (pipelineSpec && !parsePipeline(pipelineSpec, &pipeline)) {
+        fprintf(stderr, "Erreur : Pipeline invalide '%s'\n", pipelineSpec);
+        return EXIT_USAGE;
+    }
+
+    Automaton A;
+    if (!compileRegex(argv[2], alphabetLetters ? &alphabet : NULL, num_symbols, &A, NULL)) return EXIT_FAILURE;
+    bool ok = !pipelineSpec || applyPipeline(&A, &pipeline, NULL);
+    const char *extension = strrchr(outputPath, '.');
+    if (ok && extension && strcmp(extension, ".dfa") == 0) {
+        if (!isDeterministic(&A, NULL)) {
+            Automaton det;
+            ok = determinize(&A, &det, NULL);
+            if (ok) {
+                freeAutomaton(&A);
+                A = det;
+            }
+        }
+        ok = ok && trimAndMinimize(&A);
+        DenseDFA dfa;
+        bool frozen = ok && freezeDFA(&A, &dfa, NULL);
+        ok = frozen && saveDenseDFA(&dfa, outputPath, NULL);
+        if (frozen) freeDenseDFA(&dfa);
+    } else if (ok) {
+        ok = saveAutomaton(&A, outputPath, NULL);
+    }
+    if (ok) printf("%s : %d etats, %d symboles\n", outputPath, A.num_states, A.num_symbols);
+    freeAutomaton(&A);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && strcmp(argv[1], "--match") == 0) return runMatchMode(argc, argv);
+    if (argc >= 2 && strcmp(argv[1], "--compile") == 0) return runCompileMode(argc, argv);
+    if (argc >= 2 && strcmp(argv[1], "--run") == 0) return runBatchMode(argc, argv);
+    if (argc >= 2 && strcmp(argv[1], "--product") == 0) return runProductMode(argc, argv);
+    if (argc >= 2 && strcmp(argv[1], "--equiv") == 0) return runLanguageCheckMode(argc, argv, true);
+    if (argc >= 2 && strcmp(argv[1], "--included") == 0) return runLanguageCheckMode(argc, argv, false);
+    if (argc >= 2 && strcmp(argv[1], "--language") == 0) return runLanguageMode(argc, argv);
+    if (argc >= 2 && strcmp(argv[1], "--regex") == 0) return runRegexMode(argc, argv);
+
+    // Cache options: --no-cache (bypass), --cache-check (recompute and compare),
+    // --cache-evict (empty the cache and exit)
+    // Log options: --log-level quiet|error|info|debug, --log-async (background writes)
+    // --threads N: workers preparing the files of "process all" (default: every core)
+    // --stats fichier|-: per-phase timings and counters of the session as JSON, on exit
+    TransformCache cache;
+    cacheInit(&cache, CACHE_USE);
+    LogOptions logOptions;
+    logDefaultOptions(&logOptions);
+    int threads = hardwareThreads();
+    const char *statsPath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) statsPath = argv[++i];
+        else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            if (!logParseLevel(argv[++i], &logOptions.level)) {
+                fprintf(stderr, "Erreur : Niveau de log inconnu '%s' (quiet, error, info, debug)\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--log-async") == 0) logOptions.async = true;
+        else if (strcmp(argv[i], "--no-cache") == 0) cache.mode = CACHE_BYPASS;
+        else if (strcmp(argv[i], "--cache-check") == 0) cache.mode = CACHE_CHECK;
+        else if (strcmp(argv[i], "--cache-evict") == 0) {
+            char folder[512], cacheDir[512];
+            if (!resolveAutomatesPath(folder, sizeof(folder), NULL)) return EXIT_FAILURE;
+            if (!cacheFolder(folder, cacheDir, sizeof(cacheDir))) {
+                fprintf(stderr, "Erreur : Chemin du cache trop long\n");
+                return EXIT_FAILURE;
+            }
+            cacheEvictAll(cacheDir, NULL);
+            return EXIT_SUCCESS;
+        }
+    }
+
     char outputPath[512];
     resolveOutputPath(outputPath, sizeof(outputPath));
     FILE *logFile = fopen(outputPath, "w");
@@ -113,6 +878,7 @@ int main() {
     }
 
     if (logFile) printf("Log file initialized: %s\n", outputPath);
+    logOpen(logFile, &logOptions);
 
     logMessage(logFile, "=== Projet Automate (Modulaire) ===\n");
 
@@ -125,6 +891,7 @@ int main() {
         logMessage(logFile, "2. Traiter tous les automates\n");
         logMessage(logFile, "3. Quitter\n");
         printf("Choix : ");
+        logFlush(); // Keep the log file current while waiting for the user
 
         if (fgets(buffer, sizeof(buffer), stdin) == NULL) break;
         choice = atoi(buffer);
@@ -133,10 +900,10 @@ int main() {
         switch (choice) {
             case 1:
                 listAndChooseFile(filepath, sizeof(filepath), logFile);
-                if (filepath[0] != '\0') processAutomaton(filepath, logFile);
+                if (filepath[0] != '\0') processAutomaton(filepath, &cache, logFile);
                 break;
             case 2:
-                processAllAutomata(logFile);
+                processAllAutomata(&cache, threads, logFile);
                 break;
             case 3:
                 logMessage(logFile, "Fermeture du programme.\n");
@@ -146,6 +913,11 @@ int main() {
         }
     } while (choice != 3);
 
+    logClose();
     if (logFile) fclose(logFile);
+    if (statsPath && !statsSave(statsPath)) {
+        fprintf(stderr, "Erreur : Impossible d'ecrire %s\n", statsPath);
+        return EXIT_FAILURE;
+    }
     return 0;
 }
\ No newline at end of file